@@ -62,13 +62,16 @@
 
 // Allocation alignment (at least the size of the largest scalar).
 // For choosing the correct alignment of vector loads/stores primarily.
-// Bigger alignment should be done manually.
+// Bigger alignment can be requested explicitly for tagged allocations (HbMem_Tag_AllocAligned).
 #if HbPlatform_CPU_Bits < 64
 #define HbPlatform_AllocAlignment 8
 #else
 #define HbPlatform_AllocAlignment 16
 #endif
 
+// Cache line size, for separating data written by different threads to avoid false sharing.
+#define HbPlatform_CacheLineSize 64
+
 // Operating system.
 #if defined(_WIN32)
 #define HbPlatform_OS_Microsoft
@@ -105,6 +108,13 @@ typedef unsigned char HbByte;
 #error HbAligned: No implementation for the current compiler.
 #endif
 
+// Thread-local storage duration for global and static variables.
+#if defined(HbPlatform_Compiler_VisualC)
+#define HbThreadLocal __declspec(thread)
+#else
+#error HbThreadLocal: No implementation for the current compiler.
+#endif
+
 // Array size.
 #define HbCountOf(array) (sizeof(array) / sizeof((array)[0]))
 
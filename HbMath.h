@@ -2,6 +2,9 @@
 #define HbInclude_HbMath
 #include "HbCommon.h"
 #include <math.h>
+#if defined(HbPlatform_Compiler_VisualC)
+#include <intrin.h>
+#endif
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,6 +32,35 @@ HbForceInline size_t HbMath_Align_Size(size_t const value, size_t const alignmen
 	return (value + mask) & ~mask;
 }
 
+// Bit scanning - the value must not be zero.
+HbForceInline unsigned HbMath_CountTrailingZeros_Size(size_t const value) {
+	#if defined(HbPlatform_Compiler_VisualC)
+	unsigned long index;
+	#if HbPlatform_CPU_Bits >= 64
+	_BitScanForward64(&index, value);
+	#else
+	_BitScanForward(&index, value);
+	#endif
+	return (unsigned) index;
+	#else
+	#error HbMath_CountTrailingZeros_Size: No implementation for the current compiler.
+	#endif
+}
+
+HbForceInline unsigned HbMath_CountLeadingZeros_Size(size_t const value) {
+	#if defined(HbPlatform_Compiler_VisualC)
+	unsigned long index;
+	#if HbPlatform_CPU_Bits >= 64
+	_BitScanReverse64(&index, value);
+	#else
+	_BitScanReverse(&index, value);
+	#endif
+	return (unsigned) (HbPlatform_CPU_Bits - 1 - index);
+	#else
+	#error HbMath_CountLeadingZeros_Size: No implementation for the current compiler.
+	#endif
+}
+
 // Min/max - for runtime floating-point, use fmin/fmax because of NaN handling and minss/maxss.
 // The generic versions are for compile-time constants primarily because they evaluate arguments multiple times.
 #define HbMath_Min(a, b) ((a) < (b) ? (a) : (b))
@@ -9,30 +9,76 @@
  * Tagged heap memory allocations
  *********************************/
 
+// Shards are assigned to threads in the order of their first tagged allocation.
+static uint32_t volatile HbMem_Tag_NextThreadShardIndex_i = 0;
+static HbThreadLocal uint_least8_t HbMem_Tag_ThreadShardIndexPlusOne_i = 0; // Zero if not assigned yet.
+
+HbForceInline size_t HbMem_Tag_GetThreadShardIndex_i() {
+	size_t shardIndexPlusOne = HbMem_Tag_ThreadShardIndexPlusOne_i;
+	if (shardIndexPlusOne == 0) {
+		shardIndexPlusOne = HbPara_Atomic_U32_Add(&HbMem_Tag_NextThreadShardIndex_i, 1) % HbMem_Tag_ShardCount + 1;
+		HbMem_Tag_ThreadShardIndexPlusOne_i = (uint_least8_t) shardIndexPlusOne;
+	}
+	return shardIndexPlusOne - 1;
+}
+
 void HbMem_Tag_Root_Shutdown(HbMem_Tag_Root * const tagRoot) {
 	HbReport_Assert_Assume(tagRoot != NULL);
 	#if defined(HbReport_Build_Assert) && defined(HbReport_Build_Message)
 	HbMem_Tag * tag;
 	for (tag = tagRoot->tagFirst_r; tag != NULL; tag = tag->tagNext_r) {
-		HbReport_Message("HbMem_Tag_Root_Shutdown: Tag %s with %zu bytes allocated not destroyed.", HbMem_Tag_GetName(tag), tag->allocationTotalSize_r);
+		HbReport_Message("HbMem_Tag_Root_Shutdown: Tag %s with %zu bytes allocated not destroyed.", HbMem_Tag_GetName(tag), HbMem_Tag_GetTotalSize(tag));
 	}
 	#endif
 	HbReport_Assert_Assume(tagRoot->tagFirst_r == NULL && "All allocated tags must be destroyed.");
 	HbPara_Mutex_Shutdown(&tagRoot->tagListMutex_r);
 }
 
+void HbMem_Tag_Root_ReportTotalSizes(HbMem_Tag_Root * const tagRoot) {
+	HbReport_Assert_Assume(tagRoot != NULL);
+	HbPara_Mutex_Lock(&tagRoot->tagListMutex_r);
+	HbMem_Tag * tag;
+	for (tag = tagRoot->tagFirst_r; tag != NULL; tag = tag->tagNext_r) {
+		HbReport_Message("HbMem_Tag_Root_ReportTotalSizes: Tag %s has %zu bytes allocated.", HbMem_Tag_GetName(tag), HbMem_Tag_GetTotalSize(tag));
+	}
+	HbPara_Mutex_Unlock(&tagRoot->tagListMutex_r);
+}
+
 HbMem_Tag * HbMem_Tag_Create(HbMem_Tag_Root * const tagRoot, char const * const name) {
 	HbReport_Assert_Assume(tagRoot != NULL);
 	size_t const nameSize = (name != NULL ? HbTextA_Length(name) : 0) + 1;
-	HbMem_Tag * const tag = (HbMem_Tag *) malloc(sizeof(HbMem_Tag) + nameSize);
+	// Aligned to the cache line size so shards used by different threads don't share cache lines.
+	#if defined(HbPlatform_OS_Microsoft)
+	HbMem_Tag * const tag = (HbMem_Tag *) _aligned_malloc(sizeof(HbMem_Tag) + nameSize, HbPlatform_CacheLineSize);
+	#else
+	#error HbMem_Tag_Create: No aligned allocation implementation for the target OS.
+	#endif
 	if (tag == NULL) {
 		HbReport_Crash("Failed to allocate memory for a memory tag.");
 	}
 
 	tag->tagRoot_e = tagRoot;
-	HbPara_Mutex_Init(&tag->allocationMutex_r, HbFalse);
-	tag->allocationFirst_r = tag->allocationLast_r = NULL;
-	tag->allocationTotalSize_r = 0;
+	for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount; ++shardIndex) {
+		HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+		HbPara_Mutex_Init(&shard->allocationMutex_i, HbFalse);
+		#ifndef HbMem_Build_CompactHeader
+		shard->allocationFirst_i = shard->allocationLast_i = NULL;
+		#endif
+		shard->allocationTotalSize_i = 0;
+		shard->allocationLiveCount_i = 0;
+		shard->allocationCount_i = shard->reallocationCount_i = shard->freeCount_i = 0;
+		memset(shard->sizeHistogram_i, 0, sizeof(shard->sizeHistogram_i));
+		shard->liveSizeUnflushed_i = 0;
+		#ifndef HbMem_Build_CompactHeader
+		shard->origins_i = NULL;
+		shard->originCapacity_i = shard->originCount_i = 0;
+		#endif
+	}
+	tag->liveSizeFlushed_i = tag->peakSize_i = 0;
+	tag->softBudget_r = tag->hardBudget_r = 0;
+	tag->trimCallback_r = NULL;
+	tag->trimCallbackUserData_r = NULL;
+	tag->budgetedSize_i = 0;
 	HbTextA_Copy((char *) (tag + 1), nameSize, 0, name != NULL ? name : "");
 
 	HbPara_Mutex_Lock(&tagRoot->tagListMutex_r);
@@ -45,50 +91,480 @@ HbMem_Tag * HbMem_Tag_Create(HbMem_Tag_Root * const tagRoot, char const * const
 void HbMem_Tag_Destroy(HbMem_Tag * const tag) {
 	HbReport_Assert_Assume(tag != NULL);
 
+	#ifdef HbMem_Build_CompactHeader
+	// Individual shards may have wrapped around, only the sum is meaningful.
+	size_t liveCount = 0;
+	for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount; ++shardIndex) {
+		liveCount += tag->shards_i[shardIndex].allocationLiveCount_i;
+	}
 	#if defined(HbReport_Build_Assert) && defined(HbReport_Build_Message)
-	HbMem_Tag_Allocation * allocation;
-	for (allocation = tag->allocationFirst_r; allocation != NULL; allocation = allocation->tagAllocationNext_r) {
-		HbReport_Message("HbMem_Tag_Destroy: Tag %s has allocation of %zu bytes at %s:%u not freed.",
-		                 HbMem_Tag_GetName(tag), allocation->size_r, allocation->originNameImmutable_r, allocation->originLocation_r);
+	if (liveCount != 0) {
+		HbReport_Message("HbMem_Tag_Destroy: Tag %s has %zu allocations of %zu bytes not freed.", HbMem_Tag_GetName(tag), liveCount, HbMem_Tag_GetTotalSize(tag));
+	}
+	#endif
+	HbReport_Assert_Assume(liveCount == 0);
+	#else
+	for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount; ++shardIndex) {
+		HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+		#if defined(HbReport_Build_Assert) && defined(HbReport_Build_Message)
+		HbMem_Tag_Allocation * allocation;
+		for (allocation = shard->allocationFirst_i; allocation != NULL; allocation = allocation->tagAllocationNext_r) {
+			HbReport_Message("HbMem_Tag_Destroy: Tag %s has allocation of %zu bytes at %s:%u not freed.",
+			                 HbMem_Tag_GetName(tag), allocation->size_r, allocation->originNameImmutable_r, allocation->originLocation_r);
+		}
+		#endif
+		HbReport_Assert_Assume(shard->allocationFirst_i == NULL);
 	}
 	#endif
-	HbReport_Assert_Assume(tag->allocationFirst_r == NULL);
 
 	HbMem_Tag_Root * const tagRoot = tag->tagRoot_e;
 	HbPara_Mutex_Lock(&tagRoot->tagListMutex_r);
 	HbList_2WayLine_Unlink(tag, tagRoot->tagFirst_r, tagRoot->tagLast_r, tagPrev_r, tagNext_r);
 	HbPara_Mutex_Unlock(&tagRoot->tagListMutex_r);
 
-	HbPara_Mutex_Shutdown(&tag->allocationMutex_r);
-	free(tag);
+	for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount; ++shardIndex) {
+		HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+		#ifndef HbMem_Build_CompactHeader
+		free(shard->origins_i);
+		#endif
+		HbPara_Mutex_Shutdown(&shard->allocationMutex_i);
+	}
+	#if defined(HbPlatform_OS_Microsoft)
+	_aligned_free(tag);
+	#else
+	#error HbMem_Tag_Destroy: No aligned allocation implementation for the target OS.
+	#endif
 }
 
-void * HbMem_Tag_AllocExplicit(HbMem_Tag * const tag, size_t const size, HbBool const required, char const * const originNameImmutable, unsigned const originLocation) {
+size_t HbMem_Tag_GetTotalSize(HbMem_Tag * const tag) {
 	HbReport_Assert_Assume(tag != NULL);
-	HbMem_Tag_Allocation * const allocation = (HbMem_Tag_Allocation *) malloc(sizeof(HbMem_Tag_Allocation) + size);
-	if (allocation == NULL) {
+	size_t totalSize = 0;
+	for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount; ++shardIndex) {
+		HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+		HbPara_Mutex_Lock(&shard->allocationMutex_i);
+		totalSize += shard->allocationTotalSize_i; // Wrapping around in individual shards is fine.
+		HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+	}
+	return totalSize;
+}
+
+#ifndef HbMem_Build_CompactHeader
+HbForceInline size_t HbMem_Tag_HashOrigin_i(char const * const originNameImmutable, unsigned const originLocation) {
+	// Names are usually string literals or __func__, compared by address.
+	#if HbPlatform_CPU_Bits >= 64
+	size_t const hash = ((size_t) (uintptr_t) originNameImmutable ^ ((size_t) originLocation << 32)) * (size_t) 0x9E3779B97F4A7C15;
+	return hash ^ (hash >> 29);
+	#else
+	size_t const hash = ((size_t) (uintptr_t) originNameImmutable ^ ((size_t) originLocation << 16)) * (size_t) 0x9E3779B9;
+	return hash ^ (hash >> 15);
+	#endif
+}
+
+// Returns the statistics of the origin in the shard, adding it if it's not there yet. Lock the shard's allocationMutex_i.
+static HbMem_Tag_Origin_i * HbMem_Tag_GetShardOrigin_i(HbMem_Tag_Shard_i * const shard, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(shard != NULL);
+	HbReport_Assert_Assume(originNameImmutable != NULL);
+	// Keeping the load factor no higher than 1/2.
+	if ((shard->originCount_i + 1) * 2 > shard->originCapacity_i) {
+		size_t const newCapacity = shard->originCapacity_i != 0 ? shard->originCapacity_i * 2 : 16;
+		HbMem_Tag_Origin_i * const newOrigins = (HbMem_Tag_Origin_i *) calloc(newCapacity, sizeof(HbMem_Tag_Origin_i));
+		if (newOrigins == NULL) {
+			HbReport_Crash("Failed to allocate memory for %zu allocation origins.", newCapacity);
+		}
+		for (size_t originIndex = 0; originIndex < shard->originCapacity_i; ++originIndex) {
+			HbMem_Tag_Origin_i const * const origin = &shard->origins_i[originIndex];
+			if (origin->originNameImmutable_i == NULL) {
+				continue;
+			}
+			size_t newOriginIndex = HbMem_Tag_HashOrigin_i(origin->originNameImmutable_i, origin->originLocation_i) & (newCapacity - 1);
+			while (newOrigins[newOriginIndex].originNameImmutable_i != NULL) {
+				newOriginIndex = (newOriginIndex + 1) & (newCapacity - 1);
+			}
+			newOrigins[newOriginIndex] = *origin;
+		}
+		free(shard->origins_i);
+		shard->origins_i = newOrigins;
+		shard->originCapacity_i = newCapacity;
+	}
+	size_t originIndex = HbMem_Tag_HashOrigin_i(originNameImmutable, originLocation) & (shard->originCapacity_i - 1);
+	for (;;) {
+		HbMem_Tag_Origin_i * const origin = &shard->origins_i[originIndex];
+		if (origin->originNameImmutable_i == NULL) {
+			origin->originNameImmutable_i = originNameImmutable;
+			origin->originLocation_i = originLocation;
+			++shard->originCount_i;
+			return origin;
+		}
+		if (origin->originNameImmutable_i == originNameImmutable && origin->originLocation_i == originLocation) {
+			return origin;
+		}
+		originIndex = (originIndex + 1) & (shard->originCapacity_i - 1);
+	}
+}
+#endif
+
+// Lock the shard's allocationMutex_i. The change is signed.
+static void HbMem_Tag_ChangeShardLiveSize_i(HbMem_Tag * const tag, HbMem_Tag_Shard_i * const shard, size_t const change) {
+	shard->allocationTotalSize_i += change;
+	size_t const unflushed = shard->liveSizeUnflushed_i + change;
+	if ((ptrdiff_t) unflushed < (ptrdiff_t) HbMem_Tag_PeakGranularity && (ptrdiff_t) unflushed > -(ptrdiff_t) HbMem_Tag_PeakGranularity) {
+		shard->liveSizeUnflushed_i = unflushed;
+		return;
+	}
+	shard->liveSizeUnflushed_i = 0;
+	size_t const liveSize = HbPara_Atomic_Size_Add(&tag->liveSizeFlushed_i, unflushed) + unflushed;
+	if ((ptrdiff_t) liveSize <= 0) {
+		return;
+	}
+	size_t peakSize = tag->peakSize_i;
+	while (liveSize > peakSize) {
+		size_t const previousPeakSize = HbPara_Atomic_Size_CompareExchange(&tag->peakSize_i, liveSize, peakSize);
+		if (previousPeakSize == peakSize) {
+			break;
+		}
+		peakSize = previousPeakSize;
+	}
+}
+
+typedef enum HbMem_Tag_LinkReason_i {
+	HbMem_Tag_LinkReason_Allocation_i,
+	HbMem_Tag_LinkReason_Reallocation_i,
+	HbMem_Tag_LinkReason_Restore_i, // Failed reallocation.
+} HbMem_Tag_LinkReason_i;
+
+/**********
+ * Budgets
+ **********/
+
+static HbThreadLocal HbBool HbMem_Tag_ThreadInTrimCallback_i = HbFalse;
+
+void HbMem_Tag_SetBudget(HbMem_Tag * const tag, size_t const softBudget, size_t const hardBudget,
+                         HbMem_Tag_TrimCallback const trimCallback, void * const trimCallbackUserData) {
+	HbReport_Assert_Assume(tag != NULL);
+	HbReport_Assert_Assume(hardBudget == 0 || softBudget <= hardBudget);
+	if (tag->softBudget_r == 0 && tag->hardBudget_r == 0) {
+		tag->budgetedSize_i = HbMem_Tag_GetTotalSize(tag);
+	}
+	tag->softBudget_r = softBudget;
+	tag->hardBudget_r = hardBudget;
+	tag->trimCallback_r = trimCallback;
+	tag->trimCallbackUserData_r = trimCallbackUserData;
+}
+
+HbForceInline void HbMem_Tag_CallTrimCallback_i(HbMem_Tag * const tag, size_t const excessSize) {
+	if (tag->trimCallback_r == NULL || HbMem_Tag_ThreadInTrimCallback_i) {
+		return;
+	}
+	HbMem_Tag_ThreadInTrimCallback_i = HbTrue;
+	tag->trimCallback_r(tag, excessSize, tag->trimCallbackUserData_r);
+	HbMem_Tag_ThreadInTrimCallback_i = HbFalse;
+}
+
+// Accounts the size if it fits in the hard budget, possibly after trimming. Doesn't lock anything other than the callbacks may lock.
+static HbBool HbMem_Tag_ChargeBudget_i(HbMem_Tag * const tag, size_t const size) {
+	if (tag->softBudget_r == 0 && tag->hardBudget_r == 0) {
+		return HbTrue;
+	}
+	HbBool trimmed = HbFalse;
+	for (;;) {
+		size_t const oldBudgetedSize = HbPara_Atomic_Size_Add(&tag->budgetedSize_i, size);
+		size_t const budgetedSize = oldBudgetedSize + size;
+		HbBool const overflow = budgetedSize < size;
+		if (tag->hardBudget_r == 0 || (!overflow && budgetedSize <= tag->hardBudget_r)) {
+			// Only notifying about crossing the soft budget to let trimming work before it's crossed again.
+			size_t const softBudget = tag->softBudget_r;
+			if (!trimmed && softBudget != 0 && oldBudgetedSize <= softBudget && (overflow || budgetedSize > softBudget)) {
+				HbMem_Tag_CallTrimCallback_i(tag, budgetedSize - softBudget);
+			}
+			return HbTrue;
+		}
+		HbPara_Atomic_Size_Add(&tag->budgetedSize_i, (size_t) 0 - size);
+		if (trimmed || tag->trimCallback_r == NULL || HbMem_Tag_ThreadInTrimCallback_i) {
+			return HbFalse;
+		}
+		HbMem_Tag_CallTrimCallback_i(tag, overflow ? SIZE_MAX : budgetedSize - tag->hardBudget_r);
+		trimmed = HbTrue;
+	}
+}
+
+HbForceInline void HbMem_Tag_UnchargeBudget_i(HbMem_Tag * const tag, size_t const size) {
+	if (tag->softBudget_r == 0 && tag->hardBudget_r == 0) {
+		return;
+	}
+	HbPara_Atomic_Size_Add(&tag->budgetedSize_i, (size_t) 0 - size);
+}
+
+HbForceInline void HbMem_Tag_SampleAllocation_i(HbMem_Tag_Allocation * const allocation) {
+	if (HbMem_Profile_SamplingInterval_i != 0 && HbMem_Profile_ShouldSample_i(allocation->size_r)) {
+		allocation->isSampled_i = HbMem_Profile_AddSample_i(allocation, allocation->size_r);
+	}
+}
+
+static void HbMem_Tag_LinkAllocation_i(HbMem_Tag_Allocation * const allocation, HbMem_Tag_LinkReason_i const reason) {
+	HbReport_Assert_Assume(allocation != NULL);
+	size_t const shardIndex = HbMem_Tag_GetThreadShardIndex_i();
+	HbMem_Tag * const tag = allocation->tag_e;
+	HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+	HbPara_Mutex_Lock(&shard->allocationMutex_i);
+	HbMem_Tag_ChangeShardLiveSize_i(tag, shard, allocation->size_r);
+	++shard->allocationLiveCount_i;
+	#ifndef HbMem_Build_CompactHeader
+	allocation->shardIndex_i = (uint_least8_t) shardIndex;
+	HbList_2WayLine_Append(allocation, shard->allocationFirst_i, shard->allocationLast_i, tagAllocationPrev_r, tagAllocationNext_r);
+	HbMem_Tag_Origin_i * const origin = HbMem_Tag_GetShardOrigin_i(shard, allocation->originNameImmutable_r, allocation->originLocation_r);
+	origin->liveSize_i += allocation->size_r;
+	++origin->liveCount_i;
+	#endif
+	switch (reason) {
+	case HbMem_Tag_LinkReason_Allocation_i:
+		++shard->allocationCount_i;
+		#ifndef HbMem_Build_CompactHeader
+		++origin->allocationCount_i;
+		#endif
+		++shard->sizeHistogram_i[HbMem_Tag_GetSizeHistogramBucket(allocation->size_r)];
+		break;
+	case HbMem_Tag_LinkReason_Reallocation_i:
+		++shard->reallocationCount_i;
+		++shard->sizeHistogram_i[HbMem_Tag_GetSizeHistogramBucket(allocation->size_r)];
+		break;
+	default:
+		break;
+	}
+	HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+}
+
+static void HbMem_Tag_UnlinkAllocation_i(HbMem_Tag_Allocation * const allocation, HbBool const isFree) {
+	HbReport_Assert_Assume(allocation != NULL);
+	HbMem_Tag * const tag = allocation->tag_e;
+	#ifdef HbMem_Build_CompactHeader
+	HbMem_Tag_Shard_i * const shard = &tag->shards_i[HbMem_Tag_GetThreadShardIndex_i()];
+	#else
+	HbMem_Tag_Shard_i * const shard = &tag->shards_i[allocation->shardIndex_i];
+	#endif
+	HbPara_Mutex_Lock(&shard->allocationMutex_i);
+	HbMem_Tag_ChangeShardLiveSize_i(tag, shard, (size_t) 0 - (size_t) allocation->size_r);
+	--shard->allocationLiveCount_i;
+	#ifndef HbMem_Build_CompactHeader
+	HbList_2WayLine_Unlink(allocation, shard->allocationFirst_i, shard->allocationLast_i, tagAllocationPrev_r, tagAllocationNext_r);
+	HbMem_Tag_Origin_i * const origin = HbMem_Tag_GetShardOrigin_i(shard, allocation->originNameImmutable_r, allocation->originLocation_r);
+	origin->liveSize_i -= allocation->size_r;
+	--origin->liveCount_i;
+	#endif
+	if (isFree) {
+		++shard->freeCount_i;
+	}
+	HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+}
+
+HbForceInline size_t HbMem_Tag_GetSlabClass_i(size_t const size) {
+	// Checking the size first to avoid overflow when adding the header.
+	return size <= HbMem_Slab_MaxSize - sizeof(HbMem_Tag_Allocation) ? HbMem_Slab_GetClass(sizeof(HbMem_Tag_Allocation) + size) : HbMem_Slab_Class_None;
+}
+
+// Allocations with alignment stricter than HbPlatform_AllocAlignment are made with the header placed right before the aligned buffer.
+// The size passed to _aligned_offset_malloc must be larger than the offset.
+HbForceInline HbMem_Tag_Allocation * HbMem_Tag_OS_AllocOverAligned_i(size_t const size, size_t const alignment) {
+	#if defined(HbPlatform_OS_Microsoft)
+	return (HbMem_Tag_Allocation *) _aligned_offset_malloc(sizeof(HbMem_Tag_Allocation) + HbMath_Max_Size(size, 1), alignment, sizeof(HbMem_Tag_Allocation));
+	#else
+	#error HbMem_Tag_OS_AllocOverAligned_i: No implementation for the target OS.
+	#endif
+}
+
+HbForceInline HbMem_Tag_Allocation * HbMem_Tag_OS_ReallocOverAligned_i(HbMem_Tag_Allocation * const allocation, size_t const size, size_t const alignment) {
+	#if defined(HbPlatform_OS_Microsoft)
+	return (HbMem_Tag_Allocation *) _aligned_offset_realloc(allocation, sizeof(HbMem_Tag_Allocation) + HbMath_Max_Size(size, 1), alignment, sizeof(HbMem_Tag_Allocation));
+	#else
+	#error HbMem_Tag_OS_ReallocOverAligned_i: No implementation for the target OS.
+	#endif
+}
+
+HbForceInline void HbMem_Tag_OS_FreeOverAligned_i(HbMem_Tag_Allocation * const allocation) {
+	#if defined(HbPlatform_OS_Microsoft)
+	_aligned_free(allocation);
+	#else
+	#error HbMem_Tag_OS_FreeOverAligned_i: No implementation for the target OS.
+	#endif
+}
+
+HbForceInline size_t HbMem_Tag_OS_GetPageSize_i(HbBool const largePages) {
+	#if defined(HbPlatform_OS_Microsoft)
+	if (largePages) {
+		return GetLargePageMinimum();
+	}
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return systemInfo.dwPageSize;
+	#else
+	#error HbMem_Tag_OS_GetPageSize_i: No implementation for the target OS.
+	#endif
+}
+
+// Returns the allocation with slabClass_i set to the kind of the pages used.
+static HbMem_Tag_Allocation * HbMem_Tag_OS_AllocPages_i(size_t const size, HbBool const largePages) {
+	size_t const allocationSize = sizeof(HbMem_Tag_Allocation) + size;
+	HbMem_Tag_Allocation * allocation;
+	#if defined(HbPlatform_OS_Microsoft)
+	if (largePages) {
+		size_t const largePageSize = HbMem_Tag_OS_GetPageSize_i(HbTrue);
+		if (largePageSize != 0 && allocationSize <= SIZE_MAX - (largePageSize - 1)) {
+			allocation = (HbMem_Tag_Allocation *) VirtualAlloc(NULL, HbMath_Align_Size(allocationSize, largePageSize),
+			                                                   MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (allocation != NULL) {
+				allocation->slabClass_i = HbMem_Slab_Class_LargePages;
+				return allocation;
+			}
+		}
+	}
+	allocation = (HbMem_Tag_Allocation *) VirtualAlloc(NULL, allocationSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	#else
+	#error HbMem_Tag_OS_AllocPages_i: No implementation for the target OS.
+	#endif
+	if (allocation != NULL) {
+		allocation->slabClass_i = HbMem_Slab_Class_Pages;
+	}
+	return allocation;
+}
+
+HbForceInline void HbMem_Tag_OS_FreePages_i(HbMem_Tag_Allocation * const allocation) {
+	#if defined(HbPlatform_OS_Microsoft)
+	VirtualFree(allocation, 0, MEM_RELEASE);
+	#else
+	#error HbMem_Tag_OS_FreePages_i: No implementation for the target OS.
+	#endif
+}
+
+static HbMem_Tag_Allocation * HbMem_Tag_OS_ReallocPages_i(HbMem_Tag_Allocation * const allocation, size_t const size) {
+	HbBool const largePages = allocation->slabClass_i == HbMem_Slab_Class_LargePages;
+	// Staying in the same pages if the number of them doesn't change.
+	size_t const pageSize = HbMem_Tag_OS_GetPageSize_i(largePages);
+	size_t const oldAllocationSize = sizeof(HbMem_Tag_Allocation) + allocation->size_r;
+	size_t const allocationSize = sizeof(HbMem_Tag_Allocation) + size;
+	if (allocationSize <= SIZE_MAX - (pageSize - 1) &&
+	    HbMath_Align_Size(allocationSize, pageSize) == HbMath_Align_Size(oldAllocationSize, pageSize)) {
+		return allocation;
+	}
+	HbMem_Tag_Allocation * const newAllocation = HbMem_Tag_OS_AllocPages_i(size, largePages);
+	if (newAllocation != NULL) {
+		size_t const newSlabClass = newAllocation->slabClass_i;
+		memcpy(newAllocation, allocation, sizeof(HbMem_Tag_Allocation) + HbMath_Min_Size((size_t) allocation->size_r, size));
+		newAllocation->slabClass_i = (uint_least8_t) newSlabClass;
+		HbMem_Tag_OS_FreePages_i(allocation);
+	}
+	return newAllocation;
+}
+
+// Reserved pages start with the maximum size, followed by the header.
+#define HbMem_Tag_ReservedPagesPrefixSize_i HbPlatform_AllocAlignment
+
+HbForceInline size_t HbMem_Tag_GetReservedPagesCommitSize_i(size_t const size, size_t const pageSize) {
+	return HbMath_Align_Size(HbMem_Tag_ReservedPagesPrefixSize_i + sizeof(HbMem_Tag_Allocation) + size, pageSize);
+}
+
+static HbMem_Tag_Allocation * HbMem_Tag_OS_ReservePages_i(size_t const size, size_t const maxSize) {
+	HbReport_Assert_Assume(size <= maxSize);
+	size_t const pageSize = HbMem_Tag_OS_GetPageSize_i(HbFalse);
+	if (maxSize > HbMem_Tag_MaxSize || maxSize > SIZE_MAX - HbMem_Tag_ReservedPagesPrefixSize_i - sizeof(HbMem_Tag_Allocation) - (pageSize - 1)) {
+		return NULL;
+	}
+	#if defined(HbPlatform_OS_Microsoft)
+	HbByte * const base = (HbByte *) VirtualAlloc(NULL, HbMem_Tag_GetReservedPagesCommitSize_i(maxSize, pageSize), MEM_RESERVE, PAGE_NOACCESS);
+	if (base == NULL) {
+		return NULL;
+	}
+	if (VirtualAlloc(base, HbMem_Tag_GetReservedPagesCommitSize_i(size, pageSize), MEM_COMMIT, PAGE_READWRITE) == NULL) {
+		VirtualFree(base, 0, MEM_RELEASE);
+		return NULL;
+	}
+	#else
+	#error HbMem_Tag_OS_ReservePages_i: No implementation for the target OS.
+	#endif
+	*((size_t *) base) = maxSize;
+	HbMem_Tag_Allocation * const allocation = (HbMem_Tag_Allocation *) (base + HbMem_Tag_ReservedPagesPrefixSize_i);
+	allocation->slabClass_i = HbMem_Slab_Class_ReservedPages;
+	return allocation;
+}
+
+HbForceInline void HbMem_Tag_OS_FreeReservedPages_i(HbMem_Tag_Allocation * const allocation) {
+	#if defined(HbPlatform_OS_Microsoft)
+	VirtualFree((HbByte *) allocation - HbMem_Tag_ReservedPagesPrefixSize_i, 0, MEM_RELEASE);
+	#else
+	#error HbMem_Tag_OS_FreeReservedPages_i: No implementation for the target OS.
+	#endif
+}
+
+// Returns the same allocation, or NULL if failed.
+static HbMem_Tag_Allocation * HbMem_Tag_OS_ReallocReservedPages_i(HbMem_Tag_Allocation * const allocation, size_t const size) {
+	HbByte * const base = (HbByte *) allocation - HbMem_Tag_ReservedPagesPrefixSize_i;
+	if (size > *((size_t const *) base)) {
+		return NULL;
+	}
+	size_t const pageSize = HbMem_Tag_OS_GetPageSize_i(HbFalse);
+	size_t const oldCommitSize = HbMem_Tag_GetReservedPagesCommitSize_i(allocation->size_r, pageSize);
+	size_t const commitSize = HbMem_Tag_GetReservedPagesCommitSize_i(size, pageSize);
+	#if defined(HbPlatform_OS_Microsoft)
+	if (commitSize > oldCommitSize) {
+		if (VirtualAlloc(base + oldCommitSize, commitSize - oldCommitSize, MEM_COMMIT, PAGE_READWRITE) == NULL) {
+			return NULL;
+		}
+	} else if (commitSize < oldCommitSize) {
+		VirtualFree(base + commitSize, oldCommitSize - commitSize, MEM_DECOMMIT);
+	}
+	#else
+	#error HbMem_Tag_OS_ReallocReservedPages_i: No implementation for the target OS.
+	#endif
+	return allocation;
+}
+
+void * HbMem_Tag_AllocAlignedExplicit(HbMem_Tag * const tag, size_t const size, size_t const alignment, HbBool const required,
+                                      char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(tag != NULL);
+	HbReport_Assert_Assume(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	if (!HbMem_Tag_ChargeBudget_i(tag, size)) {
 		if (required) {
-			HbReport_Crash("Failed to allocate %zu bytes at %s:%u with tag %s.",
+			HbReport_Crash("Allocation of %zu bytes at %s:%u exceeds the hard budget of tag %s.",
 			               size, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
 		}
 		return NULL;
 	}
+	size_t slabClass = HbMem_Slab_Class_None;
+	size_t overAlignmentLog2 = 0;
+	HbMem_Tag_Allocation * allocation;
+	if (size > HbMem_Tag_MaxSize) {
+		allocation = NULL;
+	} else if (alignment > HbPlatform_AllocAlignment) {
+		overAlignmentLog2 = HbMath_CountTrailingZeros_Size(alignment);
+		allocation = HbMem_Tag_OS_AllocOverAligned_i(size, alignment);
+	} else {
+		slabClass = HbMem_Tag_GetSlabClass_i(size);
+		allocation = (HbMem_Tag_Allocation *) (slabClass != HbMem_Slab_Class_None ? HbMem_Slab_Alloc(slabClass) : malloc(sizeof(HbMem_Tag_Allocation) + size));
+	}
+	if (allocation == NULL) {
+		HbMem_Tag_UnchargeBudget_i(tag, size);
+		if (required) {
+			HbReport_Crash("Failed to allocate %zu bytes with alignment %zu at %s:%u with tag %s.",
+			               size, alignment, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
+		}
+		return NULL;
+	}
 
 	allocation->tag_e = tag;
 	allocation->size_r = size;
+	#ifndef HbMem_Build_CompactHeader
 	allocation->originNameImmutable_r = originNameImmutable != NULL ? originNameImmutable : "";
 	allocation->originLocation_r = originLocation;
-
-	HbPara_Mutex_Lock(&tag->allocationMutex_r);
-	HbList_2WayLine_Append(allocation, tag->allocationFirst_r, tag->allocationLast_r, tagAllocationPrev_r, tagAllocationNext_r);
-	tag->allocationTotalSize_r += size;
-	HbPara_Mutex_Unlock(&tag->allocationMutex_r);
+	#endif
+	allocation->slabClass_i = (uint_least8_t) slabClass;
+	allocation->overAlignmentLog2_i = (uint_least8_t) overAlignmentLog2;
+	allocation->isSampled_i = 0;
+	HbMem_Tag_LinkAllocation_i(allocation, HbMem_Tag_LinkReason_Allocation_i);
+	HbMem_Tag_SampleAllocation_i(allocation);
 
 	return allocation + 1;
 }
 
-void * HbMem_Tag_AllocElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t count, HbBool const required,
-                                       char const * const originNameImmutable, unsigned const originLocation) {
+void * HbMem_Tag_AllocAlignedElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t count, size_t const alignment, HbBool const required,
+                                              char const * const originNameImmutable, unsigned const originLocation) {
 	HbReport_Assert_Assume(tag != NULL);
 	HbReport_Assert_Assume(elementSize != 0);
 	#ifdef HbMem_SizeMaxChecksNeeded
@@ -101,7 +577,7 @@ void * HbMem_Tag_AllocElementsExplicit(HbMem_Tag * const tag, size_t const eleme
 		return NULL;
 	}
 	#endif
-	return HbMem_Tag_AllocExplicit(tag, elementSize * count, required, originNameImmutable, originLocation);
+	return HbMem_Tag_AllocAlignedExplicit(tag, elementSize * count, alignment, required, originNameImmutable, originLocation);
 }
 
 HbBool HbMem_Tag_ReallocExplicit(void * * const buffer, size_t const size, HbBool const required) {
@@ -109,31 +585,73 @@ HbBool HbMem_Tag_ReallocExplicit(void * * const buffer, size_t const size, HbBoo
 	HbReport_Assert_Assume(*buffer != NULL);
 	HbMem_Tag_Allocation * const allocation = (HbMem_Tag_Allocation *) *buffer - 1;
 	HbMem_Tag * const tag = allocation->tag_e;
+	size_t const oldSize = allocation->size_r;
+
+	// Growth is accounted in the budget before reallocating, shrinking after.
+	if (size > oldSize && !HbMem_Tag_ChargeBudget_i(tag, size - oldSize)) {
+		if (required) {
+			HbReport_Crash("Reallocation of %zu -> %zu bytes originally allocated at %s:%u exceeds the hard budget of tag %s.",
+			               oldSize, size, HbMem_Tag_Allocation_GetOriginName(allocation), HbMem_Tag_Allocation_GetOriginLocation(allocation),
+			               HbMem_Tag_GetName(tag));
+		}
+		return HbFalse;
+	}
 
 	// Remove the allocation from the list not to hold the mutex during the allocation because the element's address may change.
-	HbPara_Mutex_Lock(&tag->allocationMutex_r);
-	HbList_2WayLine_Unlink(allocation, tag->allocationFirst_r, tag->allocationLast_r, tagAllocationPrev_r, tagAllocationNext_r);
-	tag->allocationTotalSize_r -= allocation->size_r;
-	HbPara_Mutex_Unlock(&tag->allocationMutex_r);
+	HbMem_Tag_UnlinkAllocation_i(allocation, HbFalse);
+	// The old address may be given to another thread as soon as the block is released, which may sample it, so the key must be free by then.
+	struct HbMem_Profile_Sample_i * const detachedSample = allocation->isSampled_i ? HbMem_Profile_DetachSample_i(allocation) : NULL;
 
-	HbMem_Tag_Allocation * const newAllocation = (HbMem_Tag_Allocation *) realloc(allocation, sizeof(HbMem_Tag_Allocation) + size);
+	HbMem_Tag_Allocation * newAllocation;
+	if (size > HbMem_Tag_MaxSize) {
+		newAllocation = NULL;
+	} else if (allocation->slabClass_i == HbMem_Slab_Class_ReservedPages) {
+		newAllocation = HbMem_Tag_OS_ReallocReservedPages_i(allocation, size);
+	} else if (allocation->slabClass_i == HbMem_Slab_Class_Pages || allocation->slabClass_i == HbMem_Slab_Class_LargePages) {
+		newAllocation = HbMem_Tag_OS_ReallocPages_i(allocation, size);
+	} else if (allocation->slabClass_i != HbMem_Slab_Class_None) {
+		// Blocks can't be resized, but the allocation can stay in the same block if the size class is the same.
+		size_t const newSlabClass = HbMem_Tag_GetSlabClass_i(size);
+		if (newSlabClass == allocation->slabClass_i) {
+			newAllocation = allocation;
+		} else {
+			newAllocation = (HbMem_Tag_Allocation *) (newSlabClass != HbMem_Slab_Class_None ?
+					HbMem_Slab_Alloc(newSlabClass) : malloc(sizeof(HbMem_Tag_Allocation) + size));
+			if (newAllocation != NULL) {
+				memcpy(newAllocation, allocation, sizeof(HbMem_Tag_Allocation) + HbMath_Min_Size((size_t) allocation->size_r, size));
+				newAllocation->slabClass_i = (uint_least8_t) newSlabClass;
+				HbMem_Slab_Free(allocation);
+			}
+		}
+	} else if (allocation->overAlignmentLog2_i != 0) {
+		newAllocation = HbMem_Tag_OS_ReallocOverAligned_i(allocation, size, (size_t) 1 << allocation->overAlignmentLog2_i);
+	} else {
+		// Shrinking to a small size doesn't move the allocation to the slab allocator as realloc may do it in place.
+		newAllocation = (HbMem_Tag_Allocation *) realloc(allocation, sizeof(HbMem_Tag_Allocation) + size);
+	}
 	if (newAllocation == NULL) {
+		if (size > oldSize) {
+			HbMem_Tag_UnchargeBudget_i(tag, size - oldSize);
+		}
 		if (required) {
 			HbReport_Crash("Failed to reallocate %zu -> %zu bytes originally allocated at %s:%u with tag %s.",
-			               allocation->size_r, size, allocation->originNameImmutable_r, allocation->originLocation_r, HbMem_Tag_GetName(tag));
+			               (size_t) allocation->size_r, size, HbMem_Tag_Allocation_GetOriginName(allocation), HbMem_Tag_Allocation_GetOriginLocation(allocation),
+			               HbMem_Tag_GetName(tag));
 		}
-		HbPara_Mutex_Lock(&tag->allocationMutex_r);
-		HbList_2WayLine_Append(allocation, tag->allocationFirst_r, tag->allocationLast_r, tagAllocationPrev_r, tagAllocationNext_r);
-		tag->allocationTotalSize_r += allocation->size_r;
-		HbPara_Mutex_Unlock(&tag->allocationMutex_r);
+		if (detachedSample != NULL) {
+			HbMem_Profile_AttachSample_i(detachedSample);
+		}
+		HbMem_Tag_LinkAllocation_i(allocation, HbMem_Tag_LinkReason_Restore_i);
 		return HbFalse;
 	}
+	if (size < oldSize) {
+		HbMem_Tag_UnchargeBudget_i(tag, oldSize - size);
+	}
 	newAllocation->size_r = size;
-
-	HbPara_Mutex_Lock(&tag->allocationMutex_r);
-	HbList_2WayLine_Append(newAllocation, tag->allocationFirst_r, tag->allocationLast_r, tagAllocationPrev_r, tagAllocationNext_r);
-	tag->allocationTotalSize_r += size;
-	HbPara_Mutex_Unlock(&tag->allocationMutex_r);
+	HbMem_Tag_LinkAllocation_i(newAllocation, HbMem_Tag_LinkReason_Reallocation_i);
+	HbMem_Profile_FreeDetachedSample_i(detachedSample);
+	newAllocation->isSampled_i = 0;
+	HbMem_Tag_SampleAllocation_i(newAllocation);
 
 	*buffer = newAllocation + 1;
 	return HbTrue;
@@ -149,8 +667,8 @@ HbBool HbMem_Tag_ReallocElementsExplicit(void * * const buffer, size_t const ele
 		if (required) {
 			HbMem_Tag_Allocation * const allocation = (HbMem_Tag_Allocation *) *buffer - 1;
 			HbReport_Crash("Too many %zu-sized elements (%zu, max %zu) requested for reallocation of %zu bytes originally allocated at %s:%u with tag %s.",
-			               elementSize, count, maxCount, allocation->size_r,
-			               allocation->originNameImmutable_r, allocation->originLocation_r, HbMem_Tag_GetName(allocation->tag_e));
+			               elementSize, count, maxCount, (size_t) allocation->size_r,
+			               HbMem_Tag_Allocation_GetOriginName(allocation), HbMem_Tag_Allocation_GetOriginLocation(allocation), HbMem_Tag_GetName(allocation->tag_e));
 		}
 		return HbFalse;
 	}
@@ -162,13 +680,652 @@ void HbMem_Tag_Free(void * const buffer) {
 	HbReport_Assert_Assume(buffer != NULL);
 	HbMem_Tag_Allocation * const allocation = (HbMem_Tag_Allocation *) buffer - 1;
 
-	HbMem_Tag * const tag = allocation->tag_e;
-	HbPara_Mutex_Lock(&tag->allocationMutex_r);
-	HbList_2WayLine_Unlink(allocation, tag->allocationFirst_r, tag->allocationLast_r, tagAllocationPrev_r, tagAllocationNext_r);
-	tag->allocationTotalSize_r -= allocation->size_r;
-	HbPara_Mutex_Unlock(&tag->allocationMutex_r);
+	HbMem_Tag_UnlinkAllocation_i(allocation, HbTrue);
+	HbMem_Tag_UnchargeBudget_i(allocation->tag_e, allocation->size_r);
+	if (allocation->isSampled_i) {
+		HbMem_Profile_RemoveSample_i(allocation);
+	}
+	if (allocation->slabClass_i == HbMem_Slab_Class_ReservedPages) {
+		HbMem_Tag_OS_FreeReservedPages_i(allocation);
+	} else if (allocation->slabClass_i == HbMem_Slab_Class_Pages || allocation->slabClass_i == HbMem_Slab_Class_LargePages) {
+		HbMem_Tag_OS_FreePages_i(allocation);
+	} else if (allocation->slabClass_i != HbMem_Slab_Class_None) {
+		HbMem_Slab_Free(allocation);
+	} else if (allocation->overAlignmentLog2_i != 0) {
+		HbMem_Tag_OS_FreeOverAligned_i(allocation);
+	} else {
+		free(allocation);
+	}
+}
+
+void * HbMem_Tag_AllocPagesExplicit(HbMem_Tag * const tag, size_t const size, unsigned const flags, HbBool const required,
+                                    char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(tag != NULL);
+	if (!HbMem_Tag_ChargeBudget_i(tag, size)) {
+		if (required) {
+			HbReport_Crash("Allocation of %zu bytes of pages at %s:%u exceeds the hard budget of tag %s.",
+			               size, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
+		}
+		return NULL;
+	}
+	HbMem_Tag_Allocation * const allocation = size <= HbMem_Tag_MaxSize ? HbMem_Tag_OS_AllocPages_i(size, (flags & HbMem_Tag_PagesFlag_LargePages) != 0) : NULL;
+	if (allocation == NULL) {
+		HbMem_Tag_UnchargeBudget_i(tag, size);
+		if (required) {
+			HbReport_Crash("Failed to allocate %zu bytes of pages at %s:%u with tag %s.",
+			               size, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
+		}
+		return NULL;
+	}
+
+	allocation->tag_e = tag;
+	allocation->size_r = size;
+	#ifndef HbMem_Build_CompactHeader
+	allocation->originNameImmutable_r = originNameImmutable != NULL ? originNameImmutable : "";
+	allocation->originLocation_r = originLocation;
+	#endif
+	allocation->overAlignmentLog2_i = 0;
+	allocation->isSampled_i = 0;
+	HbMem_Tag_LinkAllocation_i(allocation, HbMem_Tag_LinkReason_Allocation_i);
+	HbMem_Tag_SampleAllocation_i(allocation);
+
+	return allocation + 1;
+}
+
+void * HbMem_Tag_AllocPagesElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t count, unsigned const flags, HbBool const required,
+                                            char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(tag != NULL);
+	HbReport_Assert_Assume(elementSize != 0);
+	#ifdef HbMem_SizeMaxChecksNeeded
+	size_t const maxCount = SIZE_MAX / elementSize;
+	if (count > maxCount) {
+		if (required) {
+			HbReport_Crash("Too many %zu-sized elements (%zu, max %zu) requested at %s:%u for allocation of pages with tag %s.",
+			               elementSize, count, maxCount, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
+		}
+		return NULL;
+	}
+	#endif
+	return HbMem_Tag_AllocPagesExplicit(tag, elementSize * count, flags, required, originNameImmutable, originLocation);
+}
+
+void * HbMem_Tag_ReservePagesExplicit(HbMem_Tag * const tag, size_t const size, size_t const maxSize, HbBool const required,
+                                      char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(tag != NULL);
+	HbReport_Assert_Assume(size <= maxSize);
+	if (!HbMem_Tag_ChargeBudget_i(tag, size)) {
+		if (required) {
+			HbReport_Crash("Reservation of pages with %zu bytes committed at %s:%u exceeds the hard budget of tag %s.",
+			               size, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
+		}
+		return NULL;
+	}
+	HbMem_Tag_Allocation * const allocation = HbMem_Tag_OS_ReservePages_i(size, maxSize);
+	if (allocation == NULL) {
+		HbMem_Tag_UnchargeBudget_i(tag, size);
+		if (required) {
+			HbReport_Crash("Failed to reserve %zu bytes of pages (%zu committed) at %s:%u with tag %s.",
+			               maxSize, size, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
+		}
+		return NULL;
+	}
+
+	allocation->tag_e = tag;
+	allocation->size_r = size;
+	#ifndef HbMem_Build_CompactHeader
+	allocation->originNameImmutable_r = originNameImmutable != NULL ? originNameImmutable : "";
+	allocation->originLocation_r = originLocation;
+	#endif
+	allocation->overAlignmentLog2_i = 0;
+	allocation->isSampled_i = 0;
+	HbMem_Tag_LinkAllocation_i(allocation, HbMem_Tag_LinkReason_Allocation_i);
+	HbMem_Tag_SampleAllocation_i(allocation);
+
+	return allocation + 1;
+}
 
-	free(allocation);
+void * HbMem_Tag_ReservePagesElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t const count, size_t const maxCount, HbBool const required,
+                                              char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(tag != NULL);
+	HbReport_Assert_Assume(elementSize != 0);
+	HbReport_Assert_Assume(count <= maxCount);
+	#ifdef HbMem_SizeMaxChecksNeeded
+	size_t const maxMaxCount = SIZE_MAX / elementSize;
+	if (maxCount > maxMaxCount) {
+		if (required) {
+			HbReport_Crash("Too many %zu-sized elements (%zu, max %zu) requested at %s:%u for reservation of pages with tag %s.",
+			               elementSize, maxCount, maxMaxCount, originNameImmutable != NULL ? originNameImmutable : "", originLocation, HbMem_Tag_GetName(tag));
+		}
+		return NULL;
+	}
+	#endif
+	return HbMem_Tag_ReservePagesExplicit(tag, elementSize * count, elementSize * maxCount, required, originNameImmutable, originLocation);
+}
+
+void HbMem_Tag_PurgePages(void * const buffer, size_t const offset, size_t const size) {
+	HbReport_Assert_Assume(buffer != NULL);
+	HbMem_Tag_Allocation const * const allocation = HbMem_Tag_GetAllocation(buffer);
+	HbReport_Assert_Assume(allocation->slabClass_i == HbMem_Slab_Class_Pages || allocation->slabClass_i == HbMem_Slab_Class_LargePages ||
+	                       allocation->slabClass_i == HbMem_Slab_Class_ReservedPages);
+	HbReport_Assert_Assume(offset <= allocation->size_r && size <= allocation->size_r - offset);
+	if (allocation->slabClass_i == HbMem_Slab_Class_LargePages) {
+		return;
+	}
+	// Only whole pages can be discarded - not touching the ones partially outside the range, including the one with the header.
+	size_t const pageSize = HbMem_Tag_OS_GetPageSize_i(HbFalse);
+	uintptr_t const start = HbMath_Align((uintptr_t) buffer + offset, (uintptr_t) pageSize);
+	uintptr_t const end = ((uintptr_t) buffer + offset + size) & ~((uintptr_t) pageSize - 1);
+	if (start >= end) {
+		return;
+	}
+	#if defined(HbPlatform_OS_Microsoft)
+	VirtualAlloc((void *) start, end - start, MEM_RESET, PAGE_READWRITE);
+	#else
+	#error HbMem_Tag_PurgePages: No implementation for the target OS.
+	#endif
+}
+
+/************************
+ * Allocation statistics
+ ************************/
+
+// Lock the shard's allocationMutex_i.
+static void HbMem_Tag_AddShardStats_i(HbMem_Tag_Shard_i const * const shard, HbMem_Tag_Stats * const stats) {
+	stats->liveSize_r += shard->allocationTotalSize_i;
+	stats->liveCount_r += shard->allocationLiveCount_i;
+	stats->allocationCount_r += shard->allocationCount_i;
+	stats->reallocationCount_r += shard->reallocationCount_i;
+	stats->freeCount_r += shard->freeCount_i;
+	for (size_t bucket = 0; bucket < HbMem_Tag_SizeHistogramBucketCount; ++bucket) {
+		stats->sizeHistogram_r[bucket] += shard->sizeHistogram_i[bucket];
+	}
+}
+
+void HbMem_Tag_GetStats(HbMem_Tag * const tag, HbMem_Tag_Stats * const stats) {
+	HbReport_Assert_Assume(tag != NULL);
+	HbReport_Assert_Assume(stats != NULL);
+	memset(stats, 0, sizeof(HbMem_Tag_Stats));
+	for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount; ++shardIndex) {
+		HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+		HbPara_Mutex_Lock(&shard->allocationMutex_i);
+		HbMem_Tag_AddShardStats_i(shard, stats);
+		HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+	}
+	// The flushed peak doesn't include the changes smaller than HbMem_Tag_PeakGranularity.
+	stats->peakSize_r = HbMath_Max_Size(tag->peakSize_i, stats->liveSize_r);
+}
+
+static int HbMem_Tag_CompareOriginKeys_i(void const * const aPointer, void const * const bPointer) {
+	HbMem_Tag_OriginStats const * const a = (HbMem_Tag_OriginStats const *) aPointer;
+	HbMem_Tag_OriginStats const * const b = (HbMem_Tag_OriginStats const *) bPointer;
+	if (a->originNameImmutable_r != b->originNameImmutable_r) {
+		return (uintptr_t) a->originNameImmutable_r < (uintptr_t) b->originNameImmutable_r ? -1 : 1;
+	}
+	if (a->originLocation_r != b->originLocation_r) {
+		return a->originLocation_r < b->originLocation_r ? -1 : 1;
+	}
+	return 0;
+}
+
+static int HbMem_Tag_CompareOriginLiveSizes_i(void const * const aPointer, void const * const bPointer) {
+	HbMem_Tag_OriginStats const * const a = (HbMem_Tag_OriginStats const *) aPointer;
+	HbMem_Tag_OriginStats const * const b = (HbMem_Tag_OriginStats const *) bPointer;
+	if (a->liveSize_r != b->liveSize_r) {
+		return a->liveSize_r > b->liveSize_r ? -1 : 1;
+	}
+	return HbMem_Tag_CompareOriginKeys_i(aPointer, bPointer);
+}
+
+HbBool HbMem_Tag_Root_GetStats(HbMem_Tag_Root * const tagRoot, HbMem_Tag_Root_Stats * const stats, HbBool const required) {
+	HbReport_Assert_Assume(tagRoot != NULL);
+	HbReport_Assert_Assume(stats != NULL);
+	stats->tags_r = NULL;
+	stats->tagCount_r = 0;
+	stats->origins_r = NULL;
+	stats->originCount_r = 0;
+
+	HbPara_Mutex_Lock(&tagRoot->tagListMutex_r);
+
+	// Tags and their names in one allocation.
+	size_t tagCount = 0, namesSize = 0;
+	HbMem_Tag * tag;
+	for (tag = tagRoot->tagFirst_r; tag != NULL; tag = tag->tagNext_r) {
+		++tagCount;
+		namesSize += HbTextA_Length(HbMem_Tag_GetName(tag)) + 1;
+	}
+	stats->tags_r = (HbMem_Tag_Root_Stats_Tag *) malloc(HbMath_Max_Size(tagCount * sizeof(HbMem_Tag_Root_Stats_Tag) + namesSize, 1));
+	if (stats->tags_r == NULL) {
+		HbPara_Mutex_Unlock(&tagRoot->tagListMutex_r);
+		if (required) {
+			HbReport_Crash("Failed to allocate memory for the statistics of %zu memory tags.", tagCount);
+		}
+		return HbFalse;
+	}
+	char * names = (char *) (stats->tags_r + tagCount);
+
+	size_t originCapacity = 0;
+	for (tag = tagRoot->tagFirst_r; tag != NULL; tag = tag->tagNext_r) {
+		HbMem_Tag_Root_Stats_Tag * const statsTag = &stats->tags_r[stats->tagCount_r++];
+		size_t const nameSize = HbTextA_Length(HbMem_Tag_GetName(tag)) + 1;
+		memcpy(names, HbMem_Tag_GetName(tag), nameSize);
+		statsTag->name_r = names;
+		names += nameSize;
+
+		memset(&statsTag->stats_r, 0, sizeof(HbMem_Tag_Stats));
+		for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount; ++shardIndex) {
+			HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+			HbPara_Mutex_Lock(&shard->allocationMutex_i);
+			HbMem_Tag_AddShardStats_i(shard, &statsTag->stats_r);
+			#ifndef HbMem_Build_CompactHeader
+			if (stats->originCount_r + shard->originCount_i > originCapacity) {
+				size_t const newOriginCapacity = HbMath_Max_Size(stats->originCount_r + shard->originCount_i, originCapacity * 2);
+				HbMem_Tag_OriginStats * const newOrigins = (HbMem_Tag_OriginStats *) realloc(stats->origins_r, newOriginCapacity * sizeof(HbMem_Tag_OriginStats));
+				if (newOrigins == NULL) {
+					HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+					HbPara_Mutex_Unlock(&tagRoot->tagListMutex_r);
+					HbMem_Tag_Root_Stats_Free(stats);
+					if (required) {
+						HbReport_Crash("Failed to allocate memory for the statistics of %zu allocation origins.", newOriginCapacity);
+					}
+					return HbFalse;
+				}
+				stats->origins_r = newOrigins;
+				originCapacity = newOriginCapacity;
+			}
+			for (size_t originIndex = 0; originIndex < shard->originCapacity_i; ++originIndex) {
+				HbMem_Tag_Origin_i const * const origin = &shard->origins_i[originIndex];
+				if (origin->originNameImmutable_i == NULL) {
+					continue;
+				}
+				HbMem_Tag_OriginStats * const originStats = &stats->origins_r[stats->originCount_r++];
+				originStats->originNameImmutable_r = origin->originNameImmutable_i;
+				originStats->originLocation_r = origin->originLocation_i;
+				originStats->liveSize_r = origin->liveSize_i;
+				originStats->liveCount_r = origin->liveCount_i;
+				originStats->allocationCount_r = origin->allocationCount_i;
+			}
+			#endif
+			HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+		}
+		statsTag->stats_r.peakSize_r = HbMath_Max_Size(tag->peakSize_i, statsTag->stats_r.liveSize_r);
+	}
+
+	HbPara_Mutex_Unlock(&tagRoot->tagListMutex_r);
+
+	// Merge the same origins from different shards and tags.
+	if (stats->originCount_r != 0) {
+		qsort(stats->origins_r, stats->originCount_r, sizeof(HbMem_Tag_OriginStats), HbMem_Tag_CompareOriginKeys_i);
+		size_t mergedOriginCount = 1;
+		for (size_t originIndex = 1; originIndex < stats->originCount_r; ++originIndex) {
+			HbMem_Tag_OriginStats const * const origin = &stats->origins_r[originIndex];
+			HbMem_Tag_OriginStats * const mergedOrigin = &stats->origins_r[mergedOriginCount - 1];
+			if (HbMem_Tag_CompareOriginKeys_i(origin, mergedOrigin) == 0) {
+				mergedOrigin->liveSize_r += origin->liveSize_r;
+				mergedOrigin->liveCount_r += origin->liveCount_r;
+				mergedOrigin->allocationCount_r += origin->allocationCount_r;
+			} else {
+				stats->origins_r[mergedOriginCount++] = *origin;
+			}
+		}
+		stats->originCount_r = mergedOriginCount;
+		qsort(stats->origins_r, stats->originCount_r, sizeof(HbMem_Tag_OriginStats), HbMem_Tag_CompareOriginLiveSizes_i);
+	}
+
+	return HbTrue;
+}
+
+void HbMem_Tag_Root_Stats_Free(HbMem_Tag_Root_Stats * const stats) {
+	HbReport_Assert_Assume(stats != NULL);
+	free(stats->tags_r);
+	free(stats->origins_r);
+	stats->tags_r = NULL;
+	stats->tagCount_r = 0;
+	stats->origins_r = NULL;
+	stats->originCount_r = 0;
+}
+
+/*****************
+ * Heap snapshots
+ *****************/
+
+#define HbMem_Snapshot_WriteBufferSize_i ((size_t) 64 * 1024)
+
+typedef struct HbMem_Snapshot_String_i {
+	char const * textImmutable_i; // NULL for free hash table slots.
+	uint32_t id_i;
+} HbMem_Snapshot_String_i;
+
+typedef struct HbMem_Snapshot_Allocation_i {
+	char const * originNameImmutable_i;
+	unsigned originLocation_i;
+	size_t size_i;
+} HbMem_Snapshot_Allocation_i;
+
+// All allocated with the system allocator not to change the tracked memory usage.
+typedef struct HbMem_Snapshot_Writer_i {
+	HbMem_WriteCallback write_i;
+	void * writeUserData_i;
+	HbBool failed_i;
+	size_t bufferUsed_i;
+	// Open addressing hash table of the strings already written, by the pointer.
+	HbMem_Snapshot_String_i * strings_i;
+	size_t stringCapacity_i; // Power of two or 0.
+	uint32_t stringCount_i;
+	uint8_t buffer_i[HbMem_Snapshot_WriteBufferSize_i];
+} HbMem_Snapshot_Writer_i;
+
+static void HbMem_Snapshot_Flush_i(HbMem_Snapshot_Writer_i * const writer) {
+	if (writer->bufferUsed_i != 0 && !writer->failed_i) {
+		writer->failed_i = !writer->write_i(writer->buffer_i, writer->bufferUsed_i, writer->writeUserData_i);
+	}
+	writer->bufferUsed_i = 0;
+}
+
+static void HbMem_Snapshot_WriteBytes_i(HbMem_Snapshot_Writer_i * const writer, void const * const data, size_t const size) {
+	uint8_t const * dataCursor = (uint8_t const *) data;
+	size_t remainingSize = size;
+	while (remainingSize != 0) {
+		if (writer->bufferUsed_i == HbMem_Snapshot_WriteBufferSize_i) {
+			HbMem_Snapshot_Flush_i(writer);
+		}
+		size_t const copySize = HbMath_Min_Size(remainingSize, HbMem_Snapshot_WriteBufferSize_i - writer->bufferUsed_i);
+		memcpy(writer->buffer_i + writer->bufferUsed_i, dataCursor, copySize);
+		writer->bufferUsed_i += copySize;
+		dataCursor += copySize;
+		remainingSize -= copySize;
+	}
+}
+
+HbForceInline void HbMem_Snapshot_WriteU8_i(HbMem_Snapshot_Writer_i * const writer, uint8_t const value) {
+	HbMem_Snapshot_WriteBytes_i(writer, &value, sizeof(value));
+}
+
+HbForceInline void HbMem_Snapshot_WriteU32_i(HbMem_Snapshot_Writer_i * const writer, uint32_t const value) {
+	HbMem_Snapshot_WriteBytes_i(writer, &value, sizeof(value));
+}
+
+HbForceInline void HbMem_Snapshot_WriteU64_i(HbMem_Snapshot_Writer_i * const writer, uint64_t const value) {
+	HbMem_Snapshot_WriteBytes_i(writer, &value, sizeof(value));
+}
+
+HbForceInline void HbMem_Snapshot_WriteText_i(HbMem_Snapshot_Writer_i * const writer, char const * const text) {
+	size_t const length = HbTextA_Length(text);
+	HbMem_Snapshot_WriteU32_i(writer, (uint32_t) HbMath_Min_Size(length, UINT32_MAX));
+	HbMem_Snapshot_WriteBytes_i(writer, text, HbMath_Min_Size(length, UINT32_MAX));
+}
+
+#ifndef HbMem_Build_CompactHeader
+// Writes the string record if it's the first reference to the string. Returns UINT32_MAX and marks the writer as failed if out of memory.
+static uint32_t HbMem_Snapshot_GetStringID_i(HbMem_Snapshot_Writer_i * const writer, char const * const textImmutable) {
+	// Deduplicated by the address, like the origins in the shards.
+	if (writer->stringCount_i >= writer->stringCapacity_i / 2) {
+		size_t const newCapacity = HbMath_Max_Size(writer->stringCapacity_i * 2, 256);
+		HbMem_Snapshot_String_i * const newStrings = (HbMem_Snapshot_String_i *) calloc(newCapacity, sizeof(HbMem_Snapshot_String_i));
+		if (newStrings == NULL) {
+			writer->failed_i = HbTrue;
+			return UINT32_MAX;
+		}
+		for (size_t stringIndex = 0; stringIndex < writer->stringCapacity_i; ++stringIndex) {
+			HbMem_Snapshot_String_i const * const string = &writer->strings_i[stringIndex];
+			if (string->textImmutable_i == NULL) {
+				continue;
+			}
+			size_t newIndex = HbMem_Tag_HashOrigin_i(string->textImmutable_i, 0) & (newCapacity - 1);
+			while (newStrings[newIndex].textImmutable_i != NULL) {
+				newIndex = (newIndex + 1) & (newCapacity - 1);
+			}
+			newStrings[newIndex] = *string;
+		}
+		free(writer->strings_i);
+		writer->strings_i = newStrings;
+		writer->stringCapacity_i = newCapacity;
+	}
+	size_t index = HbMem_Tag_HashOrigin_i(textImmutable, 0) & (writer->stringCapacity_i - 1);
+	for (;;) {
+		HbMem_Snapshot_String_i * const string = &writer->strings_i[index];
+		if (string->textImmutable_i == textImmutable) {
+			return string->id_i;
+		}
+		if (string->textImmutable_i == NULL) {
+			string->textImmutable_i = textImmutable;
+			string->id_i = writer->stringCount_i++;
+			HbMem_Snapshot_WriteU8_i(writer, HbMem_Snapshot_Record_String);
+			HbMem_Snapshot_WriteU32_i(writer, string->id_i);
+			HbMem_Snapshot_WriteText_i(writer, textImmutable);
+			return string->id_i;
+		}
+		index = (index + 1) & (writer->stringCapacity_i - 1);
+	}
+}
+#endif
+
+HbBool HbMem_Tag_Root_WriteSnapshot(HbMem_Tag_Root * const tagRoot, HbMem_WriteCallback const write, void * const userData) {
+	HbReport_Assert_Assume(tagRoot != NULL);
+	HbReport_Assert_Assume(write != NULL);
+	HbMem_Snapshot_Writer_i * const writer = (HbMem_Snapshot_Writer_i *) malloc(sizeof(HbMem_Snapshot_Writer_i));
+	if (writer == NULL) {
+		return HbFalse;
+	}
+	writer->write_i = write;
+	writer->writeUserData_i = userData;
+	writer->failed_i = HbFalse;
+	writer->bufferUsed_i = 0;
+	writer->strings_i = NULL;
+	writer->stringCapacity_i = 0;
+	writer->stringCount_i = 0;
+	HbMem_Snapshot_WriteU32_i(writer, HbMem_Snapshot_Magic);
+	HbMem_Snapshot_WriteU32_i(writer, HbMem_Snapshot_Version);
+
+	#ifndef HbMem_Build_CompactHeader
+	// Copies of the allocations of one shard, to write them after unlocking it.
+	HbMem_Snapshot_Allocation_i * allocations = NULL;
+	size_t allocationCapacity = 0;
+	#endif
+
+	HbPara_Mutex_Lock(&tagRoot->tagListMutex_r);
+	HbMem_Tag * tag;
+	for (tag = tagRoot->tagFirst_r; tag != NULL && !writer->failed_i; tag = tag->tagNext_r) {
+		HbMem_Tag_Stats stats;
+		HbMem_Tag_GetStats(tag, &stats);
+		HbMem_Snapshot_WriteU8_i(writer, HbMem_Snapshot_Record_Tag);
+		HbMem_Snapshot_WriteText_i(writer, HbMem_Tag_GetName(tag));
+		HbMem_Snapshot_WriteU64_i(writer, stats.liveSize_r);
+		HbMem_Snapshot_WriteU64_i(writer, stats.liveCount_r);
+
+		#ifndef HbMem_Build_CompactHeader
+		for (size_t shardIndex = 0; shardIndex < HbMem_Tag_ShardCount && !writer->failed_i; ++shardIndex) {
+			HbMem_Tag_Shard_i * const shard = &tag->shards_i[shardIndex];
+			HbPara_Mutex_Lock(&shard->allocationMutex_i);
+			size_t const allocationCount = shard->allocationLiveCount_i;
+			if (allocationCount > allocationCapacity) {
+				size_t const newAllocationCapacity = HbMath_Max_Size(allocationCount, allocationCapacity * 2);
+				HbMem_Snapshot_Allocation_i * const newAllocations =
+					(HbMem_Snapshot_Allocation_i *) realloc(allocations, newAllocationCapacity * sizeof(HbMem_Snapshot_Allocation_i));
+				if (newAllocations == NULL) {
+					HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+					writer->failed_i = HbTrue;
+					break;
+				}
+				allocations = newAllocations;
+				allocationCapacity = newAllocationCapacity;
+			}
+			size_t allocationIndex = 0;
+			HbMem_Tag_Allocation const * allocation;
+			for (allocation = shard->allocationFirst_i; allocation != NULL; allocation = allocation->tagAllocationNext_r) {
+				HbMem_Snapshot_Allocation_i * const allocationCopy = &allocations[allocationIndex++];
+				allocationCopy->originNameImmutable_i = allocation->originNameImmutable_r;
+				allocationCopy->originLocation_i = allocation->originLocation_r;
+				allocationCopy->size_i = allocation->size_r;
+			}
+			HbPara_Mutex_Unlock(&shard->allocationMutex_i);
+			HbReport_Assert_Checked(allocationIndex == allocationCount);
+
+			for (allocationIndex = 0; allocationIndex < allocationCount && !writer->failed_i; ++allocationIndex) {
+				HbMem_Snapshot_Allocation_i const * const allocationCopy = &allocations[allocationIndex];
+				uint32_t const originNameID = HbMem_Snapshot_GetStringID_i(writer,
+					allocationCopy->originNameImmutable_i != NULL ? allocationCopy->originNameImmutable_i : "");
+				HbMem_Snapshot_WriteU8_i(writer, HbMem_Snapshot_Record_Allocation);
+				HbMem_Snapshot_WriteU32_i(writer, originNameID);
+				HbMem_Snapshot_WriteU32_i(writer, allocationCopy->originLocation_i);
+				HbMem_Snapshot_WriteU64_i(writer, allocationCopy->size_i);
+			}
+		}
+		#endif
+	}
+	HbPara_Mutex_Unlock(&tagRoot->tagListMutex_r);
+
+	#ifndef HbMem_Build_CompactHeader
+	free(allocations);
+	#endif
+	HbMem_Snapshot_WriteU8_i(writer, HbMem_Snapshot_Record_End);
+	HbMem_Snapshot_Flush_i(writer);
+	HbBool const written = !writer->failed_i;
+	free(writer->strings_i);
+	free(writer);
+	return written;
+}
+
+/*******************
+ * Linear allocator
+ *******************/
+
+void HbMem_Arena_Shutdown(HbMem_Arena * const arena) {
+	HbReport_Assert_Assume(arena != NULL);
+	HbMem_Arena_Block_i * block = arena->blockFirst_i;
+	while (block != NULL) {
+		HbMem_Arena_Block_i * const nextBlock = block->next_i;
+		HbMem_Tag_Free(block);
+		block = nextBlock;
+	}
+}
+
+void * HbMem_Arena_AllocInNextBlock_i(HbMem_Arena * const arena, size_t const size, size_t const alignment, HbBool const required) {
+	HbReport_Assert_Assume(arena != NULL);
+	HbReport_Assert_Assume(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	// Blocks are aligned to HbPlatform_AllocAlignment, reserve space for aligning the allocation more strictly in the worst case.
+	size_t const alignmentPadding = alignment - HbMath_Min_Size(alignment, HbPlatform_AllocAlignment);
+	if (size > SIZE_MAX - sizeof(HbMem_Arena_Block_i) - alignmentPadding) {
+		if (required) {
+			HbReport_Crash("Too large allocation (%zu bytes with alignment %zu) requested from the arena created at %s:%u.",
+			               size, alignment, arena->originNameImmutable_r, arena->originLocation_r);
+		}
+		return NULL;
+	}
+	size_t const neededBlockSize = size + alignmentPadding;
+
+	HbMem_Arena_Block_i * const previousBlock = arena->blockCurrent_i;
+	HbMem_Arena_Block_i * block = previousBlock != NULL ? previousBlock->next_i : arena->blockFirst_i;
+	if (block == NULL || block->size_i < neededBlockSize) {
+		// Insert a new block before the next kept one (which can still be used by the later allocations).
+		size_t const blockSize = HbMath_Max_Size(arena->blockSize_r, neededBlockSize);
+		HbMem_Arena_Block_i * const newBlock = (HbMem_Arena_Block_i *) HbMem_Tag_AllocExplicit(
+				arena->tag_e, sizeof(HbMem_Arena_Block_i) + blockSize, required, arena->originNameImmutable_r, arena->originLocation_r);
+		if (newBlock == NULL) {
+			return NULL;
+		}
+		newBlock->next_i = block;
+		newBlock->size_i = blockSize;
+		if (previousBlock != NULL) {
+			previousBlock->next_i = newBlock;
+		} else {
+			arena->blockFirst_i = newBlock;
+		}
+		block = newBlock;
+	}
+
+	uintptr_t const blockData = (uintptr_t) (block + 1);
+	size_t const offset = (size_t) (HbMath_Align(blockData, (uintptr_t) alignment) - blockData);
+	arena->blockCurrent_i = block;
+	arena->blockCurrentUsed_i = offset + size;
+	return (void *) (blockData + offset);
+}
+
+void * HbMem_Arena_AllocAlignedElementsExplicit(HbMem_Arena * const arena, size_t const elementSize, size_t const count, size_t const alignment, HbBool const required) {
+	HbReport_Assert_Assume(arena != NULL);
+	HbReport_Assert_Assume(elementSize != 0);
+	#ifdef HbMem_SizeMaxChecksNeeded
+	size_t const maxCount = SIZE_MAX / elementSize;
+	if (count > maxCount) {
+		if (required) {
+			HbReport_Crash("Too many %zu-sized elements (%zu, max %zu) requested from the arena created at %s:%u.",
+			               elementSize, count, maxCount, arena->originNameImmutable_r, arena->originLocation_r);
+		}
+		return NULL;
+	}
+	#endif
+	return HbMem_Arena_AllocAlignedExplicit(arena, elementSize * count, alignment, required);
+}
+
+size_t HbMem_Arena_GetUsedSize(HbMem_Arena const * const arena) {
+	HbReport_Assert_Assume(arena != NULL);
+	if (arena->blockCurrent_i == NULL) {
+		return 0;
+	}
+	size_t usedSize = arena->blockCurrentUsed_i;
+	HbMem_Arena_Block_i const * block;
+	for (block = arena->blockFirst_i; block != arena->blockCurrent_i; block = block->next_i) {
+		usedSize += block->size_i;
+	}
+	return usedSize;
+}
+
+/**********************************
+ * Per-thread frame scratch memory
+ **********************************/
+
+void HbMem_Scratch_InitExplicit(HbMem_Scratch * const scratch, size_t const threadCount, size_t const frameCount, size_t const blockSize,
+                                HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(scratch != NULL);
+	HbReport_Assert_Assume(threadCount != 0);
+	HbReport_Assert_Assume(frameCount != 0);
+	scratch->threadCount_r = threadCount;
+	scratch->frameCount_r = frameCount;
+	scratch->frame_r = 0;
+	scratch->frameArenaIndex_i = 0;
+	scratch->frameHighWaterMark_r = 0;
+	scratch->tag_e = tag;
+	scratch->threads_i = (HbMem_Scratch_Thread_i *) HbMem_Tag_AllocAlignedElementsExplicit(
+			tag, sizeof(HbMem_Scratch_Thread_i), threadCount, HbPlatform_CacheLineSize, HbTrue, originNameImmutable, originLocation);
+	for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+		HbMem_Scratch_Thread_i * const thread = &scratch->threads_i[threadIndex];
+		// Separate cache lines so threads don't write the same cache lines when allocating.
+		thread->frameArenas_i = (HbMem_Arena *) HbMem_Tag_AllocAlignedElementsExplicit(
+				tag, sizeof(HbMem_Arena), frameCount, HbPlatform_CacheLineSize, HbTrue, originNameImmutable, originLocation);
+		for (size_t frameArenaIndex = 0; frameArenaIndex < frameCount; ++frameArenaIndex) {
+			HbMem_Arena_InitExplicit(&thread->frameArenas_i[frameArenaIndex], blockSize, tag, originNameImmutable, originLocation);
+		}
+		thread->highWaterMark_i = 0;
+	}
+}
+
+void HbMem_Scratch_Shutdown(HbMem_Scratch * const scratch) {
+	HbReport_Assert_Assume(scratch != NULL);
+	for (size_t threadIndex = 0; threadIndex < scratch->threadCount_r; ++threadIndex) {
+		HbMem_Scratch_Thread_i * const thread = &scratch->threads_i[threadIndex];
+		for (size_t frameArenaIndex = 0; frameArenaIndex < scratch->frameCount_r; ++frameArenaIndex) {
+			HbMem_Arena_Shutdown(&thread->frameArenas_i[frameArenaIndex]);
+		}
+		HbMem_Tag_Free(thread->frameArenas_i);
+	}
+	HbMem_Tag_Free(scratch->threads_i);
+}
+
+void HbMem_Scratch_BeginFrame(HbMem_Scratch * const scratch) {
+	HbReport_Assert_Assume(scratch != NULL);
+	++scratch->frame_r;
+	size_t const frameArenaIndex = (size_t) (scratch->frame_r % scratch->frameCount_r);
+	scratch->frameArenaIndex_i = frameArenaIndex;
+	// Recycle the arenas of the retired frame, gathering its statistics.
+	size_t retiredFrameSize = 0;
+	for (size_t threadIndex = 0; threadIndex < scratch->threadCount_r; ++threadIndex) {
+		HbMem_Scratch_Thread_i * const thread = &scratch->threads_i[threadIndex];
+		HbMem_Arena * const arena = &thread->frameArenas_i[frameArenaIndex];
+		size_t const threadRetiredFrameSize = HbMem_Arena_GetUsedSize(arena);
+		thread->highWaterMark_i = HbMath_Max_Size(thread->highWaterMark_i, threadRetiredFrameSize);
+		retiredFrameSize += threadRetiredFrameSize;
+		HbMem_Arena_Reset(arena);
+	}
+	scratch->frameHighWaterMark_r = HbMath_Max_Size(scratch->frameHighWaterMark_r, retiredFrameSize);
 }
 
 /***********************
@@ -213,15 +1370,186 @@ void HbMem_DynArray_ReserveExactly(HbMem_DynArray * const array, size_t const ca
 		               array->elementSize_r, neededCapacity, maxCapacity, array->originNameImmutable_r, array->originLocation_r);
 	}
 	#endif
-	if (array->capacity_r != 0) {
+	if (array->inlineCapacity_r != 0) {
+		HbBool const isInline = array->data_r == array->inlineData_e;
+		if (neededCapacity <= array->inlineCapacity_r) {
+			if (!isInline) {
+				// Trimmed enough to fit in the inline storage again.
+				if (array->count_r != 0) {
+					memcpy(array->inlineData_e, array->data_r, array->elementSize_r * array->count_r);
+				}
+				HbMem_Tag_Free(array->data_r);
+				array->data_r = array->inlineData_e;
+			}
+			array->capacity_r = array->inlineCapacity_r;
+			return;
+		}
+		if (isInline) {
+			// Spilling to the heap.
+			void * const data = HbMem_Tag_AllocAlignedElementsExplicit(array->tag_e, array->elementSize_r, neededCapacity, array->alignment_r, HbTrue,
+			                                                           array->originNameImmutable_r, array->originLocation_r);
+			if (array->count_r != 0) {
+				memcpy(data, array->inlineData_e, array->elementSize_r * array->count_r);
+			}
+			array->data_r = data;
+			array->capacity_r = neededCapacity;
+			return;
+		}
+	}
+	if (array->reservedCapacity_r != 0) {
+		// Committing or decommitting pages in place.
+		if (neededCapacity > array->reservedCapacity_r) {
+			HbReport_Crash("Too many elements of size %zu requested (%zu, reserved %zu) for the array created at %s:%u.",
+			               array->elementSize_r, neededCapacity, array->reservedCapacity_r, array->originNameImmutable_r, array->originLocation_r);
+		}
+		if (array->data_r != NULL) {
+			HbMem_Tag_ReallocElementsExplicit((void * *) &array->data_r, array->elementSize_r, neededCapacity, HbTrue);
+		} else {
+			array->data_r = HbMem_Tag_ReservePagesElementsExplicit(array->tag_e, array->elementSize_r, neededCapacity, array->reservedCapacity_r, HbTrue,
+			                                                       array->originNameImmutable_r, array->originLocation_r);
+		}
+	} else if (array->capacity_r != 0) {
 		if (neededCapacity == 0) {
 			HbMem_Tag_Free(array->data_r);
+			array->data_r = NULL;
 		} else {
 			HbMem_Tag_ReallocElementsExplicit((void * *) &array->data_r, array->elementSize_r, neededCapacity, HbTrue);
 		}
 	} else {
-		array->data_r = HbMem_Tag_AllocElementsExplicit(array->tag_e, array->elementSize_r, neededCapacity, HbTrue,
-		                                                array->originNameImmutable_r, array->originLocation_r);
+		array->data_r = HbMem_Tag_AllocAlignedElementsExplicit(array->tag_e, array->elementSize_r, neededCapacity, array->alignment_r, HbTrue,
+		                                                       array->originNameImmutable_r, array->originLocation_r);
 	}
 	array->capacity_r = neededCapacity;
 }
+
+size_t HbMem_DynArray_AppendRange(HbMem_DynArray * const array, void const * const elements, size_t const count) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(elements != NULL || count == 0);
+	size_t const offset = HbMem_DynArray_Append(array, count);
+	if (count != 0) {
+		memcpy((HbByte *) array->data_r + array->elementSize_r * offset, elements, array->elementSize_r * count);
+	}
+	return offset;
+}
+
+void HbMem_DynArray_InsertRangeIntoSorted(HbMem_DynArray * const array, void const * const elements, size_t const count,
+                                          HbMem_DynArray_CompareCallback const compare, void * const userData) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(elements != NULL || count == 0);
+	HbReport_Assert_Assume(compare != NULL);
+	if (count == 0) {
+		return;
+	}
+	size_t const oldCount = array->count_r;
+	HbMem_DynArray_Append(array, count);
+	size_t const elementSize = array->elementSize_r;
+	HbByte * const data = (HbByte *) array->data_r;
+	HbByte const * const newElements = (HbByte const *) elements;
+	// Merging from the end, moving each run of the existing elements greater than a new one at once.
+	// The existing elements before existingEnd and the new ones before newEnd are not placed yet.
+	size_t existingEnd = oldCount, newEnd = count;
+	while (existingEnd != 0 && newEnd != 0) {
+		HbByte const * const newElement = newElements + elementSize * (newEnd - 1);
+		// The first existing element greater than the new one.
+		size_t start = 0, end = existingEnd;
+		while (start < end) {
+			size_t const middle = start + (end - start) / 2;
+			if (compare(data + elementSize * middle, newElement, userData) > 0) {
+				end = middle;
+			} else {
+				start = middle + 1;
+			}
+		}
+		if (start != existingEnd) {
+			memmove(data + elementSize * (start + newEnd), data + elementSize * start, elementSize * (existingEnd - start));
+			existingEnd = start;
+		}
+		memcpy(data + elementSize * (existingEnd + newEnd - 1), newElement, elementSize);
+		--newEnd;
+	}
+	// The remaining new elements are not greater than any existing one.
+	if (newEnd != 0) {
+		memcpy(data, newElements, elementSize * newEnd);
+	}
+}
+
+// Moves the kept elements from runStart to runEnd to keptCount, returning the new number of the kept elements.
+HbForceInline size_t HbMem_DynArray_CompactRun_i(HbByte * const data, size_t const elementSize, size_t const keptCount, size_t const runStart, size_t const runEnd) {
+	if (runStart != keptCount && runEnd != runStart) {
+		memmove(data + elementSize * keptCount, data + elementSize * runStart, elementSize * (runEnd - runStart));
+	}
+	return keptCount + (runEnd - runStart);
+}
+
+size_t HbMem_DynArray_RemoveIfFromSorted(HbMem_DynArray * const array, HbMem_DynArray_PredicateCallback const predicate, void * const userData) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(predicate != NULL);
+	size_t const elementSize = array->elementSize_r, count = array->count_r;
+	HbByte * const data = (HbByte *) array->data_r;
+	size_t keptCount = 0, runStart = 0;
+	for (size_t index = 0; index < count; ++index) {
+		if (predicate(data + elementSize * index, userData)) {
+			keptCount = HbMem_DynArray_CompactRun_i(data, elementSize, keptCount, runStart, index);
+			runStart = index + 1;
+		}
+	}
+	keptCount = HbMem_DynArray_CompactRun_i(data, elementSize, keptCount, runStart, count);
+	array->count_r = keptCount;
+	return count - keptCount;
+}
+
+void HbMem_DynArray_RemoveIndicesFromSorted(HbMem_DynArray * const array, size_t const * const indices, size_t const indexCount) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(indices != NULL || indexCount == 0);
+	size_t const elementSize = array->elementSize_r, count = array->count_r;
+	HbByte * const data = (HbByte *) array->data_r;
+	size_t keptCount = 0, runStart = 0;
+	for (size_t indexIndex = 0; indexIndex < indexCount; ++indexIndex) {
+		size_t const index = indices[indexIndex];
+		HbReport_Assert_Assume(index >= runStart && index < count);
+		keptCount = HbMem_DynArray_CompactRun_i(data, elementSize, keptCount, runStart, index);
+		runStart = index + 1;
+	}
+	array->count_r = HbMem_DynArray_CompactRun_i(data, elementSize, keptCount, runStart, count);
+}
+
+size_t HbMem_DynArray_PartitionStable(HbMem_DynArray * const array, HbMem_DynArray_PredicateCallback const predicate, void * const userData) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(predicate != NULL);
+	size_t const elementSize = array->elementSize_r, count = array->count_r;
+	HbByte * const data = (HbByte *) array->data_r;
+	// The leading matching elements are already in place.
+	size_t index = 0;
+	while (index < count && predicate(data + elementSize * index, userData)) {
+		++index;
+	}
+	size_t matchingCount = index;
+	if (index == count) {
+		return matchingCount; // All matching.
+	}
+	// The element at index is already known not to match, not calling the predicate for it again.
+	do {
+		++index;
+	} while (index < count && !predicate(data + elementSize * index, userData));
+	if (index == count) {
+		return matchingCount; // Already partitioned.
+	}
+	// Setting the non-matching elements aside while compacting the matching ones.
+	HbByte * const notMatching = (HbByte *) HbMem_Tag_AllocElementsExplicit(array->tag_e, elementSize, count - matchingCount, HbTrue,
+	                                                                        array->originNameImmutable_r, array->originLocation_r);
+	size_t notMatchingCount = index - matchingCount;
+	memcpy(notMatching, data + elementSize * matchingCount, elementSize * notMatchingCount);
+	size_t runStart = index; // The element at index is matching.
+	for (++index; index < count; ++index) {
+		HbByte const * const element = data + elementSize * index;
+		if (!predicate(element, userData)) {
+			matchingCount = HbMem_DynArray_CompactRun_i(data, elementSize, matchingCount, runStart, index);
+			memcpy(notMatching + elementSize * notMatchingCount++, element, elementSize);
+			runStart = index + 1;
+		}
+	}
+	matchingCount = HbMem_DynArray_CompactRun_i(data, elementSize, matchingCount, runStart, count);
+	memcpy(data + elementSize * matchingCount, notMatching, elementSize * notMatchingCount);
+	HbMem_Tag_Free(notMatching);
+	return matchingCount;
+}
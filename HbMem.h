@@ -13,6 +13,9 @@ extern "C" {
 #define HbMem_SizeMaxChecksNeeded
 #endif
 
+// HbMem_Build_CompactHeader may be enabled in the build configuration (primarily for release builds) to reduce the header of tagged allocations
+// to the tag and the size. Allocations are then not linked in lists - leaks are detected by counts only, and there are no per-origin statistics.
+
 /***********************************************
  * Tagged heap memory allocations
  * For leak detection and memory usage tracking
@@ -30,23 +33,111 @@ inline void HbMem_Tag_Root_Init(HbMem_Tag_Root * const tagRoot) {
 }
 void HbMem_Tag_Root_Shutdown(HbMem_Tag_Root * const tagRoot);
 
+#ifdef HbMem_Build_CompactHeader
+typedef struct HbAligned(HbPlatform_AllocAlignment) HbMem_Tag_Allocation {
+	struct HbMem_Tag * tag_e;
+	#if HbPlatform_CPU_Bits >= 64
+	// 16 bytes in total - allocations larger than the virtual address space of current CPUs are not possible anyway.
+	size_t size_r : 47;
+	size_t isSampled_i : 1; // Whether the allocation is tracked by the heap profiler.
+	size_t slabClass_i : 8; // HbMem_Slab_Class_None/Pages/LargePages/ReservedPages if not allocated from the slab allocator.
+	size_t overAlignmentLog2_i : 8; // 0 if the alignment is not stricter than HbPlatform_AllocAlignment.
+	#else
+	size_t size_r;
+	uint_least8_t isSampled_i;
+	uint_least8_t slabClass_i;
+	uint_least8_t overAlignmentLog2_i;
+	#endif
+} HbMem_Tag_Allocation;
+#if HbPlatform_CPU_Bits >= 64
+#define HbMem_Tag_MaxSize (((size_t) 1 << 47) - 1)
+#endif
+HbForceInline char const * HbMem_Tag_Allocation_GetOriginName(HbMem_Tag_Allocation const * const allocation) { HbUnused(allocation); return ""; }
+HbForceInline unsigned HbMem_Tag_Allocation_GetOriginLocation(HbMem_Tag_Allocation const * const allocation) { HbUnused(allocation); return 0; }
+#else
 typedef struct HbAligned(HbPlatform_AllocAlignment) HbMem_Tag_Allocation {
 	struct HbMem_Tag * tag_e;
-	struct HbMem_Tag_Allocation * tagAllocationPrev_r; // Lock tag_e->allocationMutex_r.
-	struct HbMem_Tag_Allocation * tagAllocationNext_r; // Lock tag_e->allocationMutex_r.
+	struct HbMem_Tag_Allocation * tagAllocationPrev_r; // Lock tag_e->shards_i[shardIndex_i].allocationMutex_i.
+	struct HbMem_Tag_Allocation * tagAllocationNext_r; // Lock tag_e->shards_i[shardIndex_i].allocationMutex_i.
 	size_t size_r;
 	char const * originNameImmutable_r; // Function name generally, but can be something else (like, a library only providing file names).
 	unsigned originLocation_r; // File line generally.
+	uint_least8_t shardIndex_i; // The shard of the allocating thread, not necessarily of the one freeing.
+	uint_least8_t isSampled_i; // Whether the allocation is tracked by the heap profiler.
+	uint_least8_t slabClass_i; // HbMem_Slab_Class_None/Pages/LargePages/ReservedPages if not allocated from the slab allocator.
+	uint_least8_t overAlignmentLog2_i; // 0 if the alignment is not stricter than HbPlatform_AllocAlignment.
 } HbMem_Tag_Allocation;
+HbForceInline char const * HbMem_Tag_Allocation_GetOriginName(HbMem_Tag_Allocation const * const allocation) { return allocation->originNameImmutable_r; }
+HbForceInline unsigned HbMem_Tag_Allocation_GetOriginLocation(HbMem_Tag_Allocation const * const allocation) { return allocation->originLocation_r; }
+#endif
+#ifndef HbMem_Tag_MaxSize
+#define HbMem_Tag_MaxSize (SIZE_MAX - sizeof(HbMem_Tag_Allocation))
+#endif
+
+// Statistics of the allocations made from one origin (function and line) in one shard.
+typedef struct HbMem_Tag_Origin_i {
+	char const * originNameImmutable_i; // NULL for free hash table slots.
+	unsigned originLocation_i;
+	size_t liveSize_i;
+	size_t liveCount_i;
+	size_t allocationCount_i;
+} HbMem_Tag_Origin_i;
+
+// Buckets of the size histogram - 0 for empty allocations, floor(log2(size)) + 1 for others.
+#define HbMem_Tag_SizeHistogramBucketCount (HbPlatform_CPU_Bits + 1)
+HbForceInline size_t HbMem_Tag_GetSizeHistogramBucket(size_t const size) {
+	return size != 0 ? HbPlatform_CPU_Bits - HbMath_CountLeadingZeros_Size(size) : 0;
+}
+
+// Allocations are tracked in per-thread shards so threads sharing a tag don't contend for one mutex.
+// Threads are assigned to shards round-robin on their first tagged allocation, and shards are merged only when read.
+// Allocations are accounted in the shard they are linked to, regardless of the thread freeing them, unless the header is compact
+// (frees are then accounted in the shard of the freeing thread, and the counters of individual shards may wrap around below zero).
+#define HbMem_Tag_ShardCount 32
+typedef struct HbAligned(HbPlatform_CacheLineSize) HbMem_Tag_Shard_i {
+	HbPara_Mutex allocationMutex_i;
+	// All lock allocationMutex_i.
+	#ifndef HbMem_Build_CompactHeader
+	HbMem_Tag_Allocation * allocationFirst_i;
+	HbMem_Tag_Allocation * allocationLast_i;
+	#endif
+	size_t allocationTotalSize_i; // Use HbMem_Tag_GetTotalSize to get the total size of all shards.
+	size_t allocationLiveCount_i;
+	size_t allocationCount_i;
+	size_t reallocationCount_i;
+	size_t freeCount_i;
+	size_t sizeHistogram_i[HbMem_Tag_SizeHistogramBucketCount]; // Sizes requested by allocations and reallocations.
+	// Change of allocationTotalSize_i not added to the tag's liveSizeFlushed_i yet, signed.
+	size_t liveSizeUnflushed_i;
+	#ifndef HbMem_Build_CompactHeader
+	// Open addressing hash table, allocated with the system allocator not to be tracked itself.
+	HbMem_Tag_Origin_i * origins_i;
+	size_t originCapacity_i; // Power of two or 0.
+	size_t originCount_i;
+	#endif
+} HbMem_Tag_Shard_i;
+
+// Shards flush the change of their total size to the tag in steps at least this large so the peak can be tracked without contention.
+// The peak therefore may be lower than the actual one by up to this value per shard.
+#define HbMem_Tag_PeakGranularity ((size_t) 64 * 1024)
+
+// Called on the allocating thread when an allocation makes the tag cross its soft budget, or would cross the hard budget.
+// The excess size is how much needs to be freed to get back within the budget. Trim callbacks are not called recursively.
+typedef void (* HbMem_Tag_TrimCallback)(struct HbMem_Tag * const tag, size_t const excessSize, void * const userData);
 
 typedef struct HbMem_Tag {
 	HbMem_Tag_Root * tagRoot_e;
 	struct HbMem_Tag * tagPrev_r; // Lock tagRoot_e->tagListMutex_r.
 	struct HbMem_Tag * tagNext_r; // Lock tagRoot_e->tagListMutex_r.
-	HbPara_Mutex allocationMutex_r;
-	HbMem_Tag_Allocation * allocationFirst_r; // Lock allocationMutex_r.
-	HbMem_Tag_Allocation * allocationLast_r; // Lock allocationMutex_r.
-	size_t allocationTotalSize_r; // Lock allocationMutex_r.
+	size_t volatile liveSizeFlushed_i; // Atomic, signed because shards may flush frees before allocations.
+	size_t volatile peakSize_i; // Atomic.
+	// Budgets in bytes of the requested sizes, 0 if not limited.
+	size_t softBudget_r;
+	size_t hardBudget_r;
+	HbMem_Tag_TrimCallback trimCallback_r;
+	void * trimCallbackUserData_r;
+	size_t volatile budgetedSize_i; // Atomic, the exact total size, only tracked while there are budgets.
+	HbMem_Tag_Shard_i shards_i[HbMem_Tag_ShardCount];
 	// Followed by char name_r[].
 } HbMem_Tag;
 // Create instead of Init so tags themselves aren't (accidentally) created in tagged memory (and deallocated).
@@ -56,18 +147,137 @@ HbForceInline char const * HbMem_Tag_GetName(HbMem_Tag const * const tag) {
 	HbReport_Assert_Assume(tag != NULL);
 	return (char const *) (tag + 1);
 }
+// Merges the shards, locking them one by one - only consistent if there are no concurrent allocations with the tag.
+size_t HbMem_Tag_GetTotalSize(HbMem_Tag * const tag);
+// Call when there are no concurrent allocations with the tag. The callback is optional.
+// Allocations exceeding the hard budget (after calling the trim callback once) fail, crashing if they are required.
+void HbMem_Tag_SetBudget(HbMem_Tag * const tag, size_t const softBudget, size_t const hardBudget,
+                         HbMem_Tag_TrimCallback const trimCallback, void * const trimCallbackUserData);
+// Prints the total size of every tag of the root as messages.
+void HbMem_Tag_Root_ReportTotalSizes(HbMem_Tag_Root * const tagRoot);
+
+/*********************************************************************************
+ * Allocation statistics
+ * Gathered in the shards while their mutexes are locked for linking allocations,
+ * so reading them doesn't require walking the allocation lists.
+ *********************************************************************************/
+
+typedef struct HbMem_Tag_Stats {
+	size_t liveSize_r;
+	size_t peakSize_r; // Approximate, see HbMem_Tag_PeakGranularity.
+	size_t liveCount_r;
+	// Cumulative since the creation of the tag.
+	size_t allocationCount_r;
+	size_t reallocationCount_r;
+	size_t freeCount_r;
+	size_t sizeHistogram_r[HbMem_Tag_SizeHistogramBucketCount]; // See HbMem_Tag_GetSizeHistogramBucket.
+} HbMem_Tag_Stats;
+// Merges the shards, locking them one by one - only consistent if there are no concurrent allocations with the tag.
+void HbMem_Tag_GetStats(HbMem_Tag * const tag, HbMem_Tag_Stats * const stats);
+
+typedef struct HbMem_Tag_OriginStats {
+	char const * originNameImmutable_r;
+	unsigned originLocation_r;
+	size_t liveSize_r;
+	size_t liveCount_r;
+	size_t allocationCount_r; // Cumulative, not including reallocations.
+} HbMem_Tag_OriginStats;
+
+typedef struct HbMem_Tag_Root_Stats_Tag {
+	char const * name_r; // Copied, stays valid after the tag is destroyed.
+	HbMem_Tag_Stats stats_r;
+} HbMem_Tag_Root_Stats_Tag;
+
+// A snapshot of the statistics of all tags of the root.
+// Allocated with the system allocator so taking a snapshot doesn't change the tracked memory usage.
+typedef struct HbMem_Tag_Root_Stats {
+	HbMem_Tag_Root_Stats_Tag * tags_r; // In the order of creation of the tags.
+	size_t tagCount_r;
+	HbMem_Tag_OriginStats * origins_r; // Aggregated across all tags, from the largest live size. Empty if the header is compact.
+	size_t originCount_r;
+} HbMem_Tag_Root_Stats;
+HbBool HbMem_Tag_Root_GetStats(HbMem_Tag_Root * const tagRoot, HbMem_Tag_Root_Stats * const stats, HbBool const required);
+void HbMem_Tag_Root_Stats_Free(HbMem_Tag_Root_Stats * const stats);
+
+/**************************************************************************************
+ * Sampling heap profiler
+ * Captures the call stacks of tagged allocations, once per the sampling interval of
+ * allocated bytes on average, and keeps them until the allocations are freed.
+ * Reallocation is treated as a new allocation. Process-wide, not limited to one root.
+ **************************************************************************************/
+
+// For streaming output. Returns whether the data has been written successfully.
+typedef HbBool (* HbMem_WriteCallback)(void const * const data, size_t const size, void * const userData);
+
+#define HbMem_Profile_MaxStackDepth 32
+
+// 0 when disabled (the default) - the allocations then only check this.
+extern size_t volatile HbMem_Profile_SamplingInterval_i;
+// Can be changed at any time. The samples that are live are kept when disabling.
+void HbMem_Profile_SetSamplingInterval(size_t const interval);
+// Writes the live samples as a legacy text heap profile (heap_v2) supported by pprof, with the modules of the process as mapped libraries.
+// pprof scales the sampled sizes up using the sampling interval.
+HbBool HbMem_Profile_WriteHeapProfile(HbMem_WriteCallback const write, void * const userData);
 
-// The returned buffer has alignment of HbPlatform_AllocAlignment - no built-in alignment handling to avoid overcomplicating realloc.
-void * HbMem_Tag_AllocExplicit(HbMem_Tag * const tag, size_t const size, HbBool const required, char const * const originNameImmutable, unsigned const originLocation);
-void * HbMem_Tag_AllocElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t count, HbBool const required,
-                                       char const * const originNameImmutable, unsigned const originLocation);
+// Counts the size towards the next sample of the thread.
+HbBool HbMem_Profile_ShouldSample_i(size_t const size);
+// The allocation is only used as the key. Returns HbFalse if failed to allocate memory for the sample.
+HbBool HbMem_Profile_AddSample_i(void const * const allocation, size_t const size);
+void HbMem_Profile_RemoveSample_i(void const * const allocation);
+// Takes the sample out of the table before the address may be reused by another allocation, NULL if not found.
+// The detached sample is either attached back with the same address, or freed with HbMem_Profile_FreeDetachedSample_i.
+struct HbMem_Profile_Sample_i * HbMem_Profile_DetachSample_i(void const * const allocation);
+void HbMem_Profile_AttachSample_i(struct HbMem_Profile_Sample_i * const sample);
+void HbMem_Profile_FreeDetachedSample_i(struct HbMem_Profile_Sample_i * const sample);
+
+/******************************************************************************
+ * Heap snapshots
+ * Binary dumps of all tags and live allocations of a root for offline diffing
+ * with Tools/HbMemSnapshotDiff.c. The shards are locked one at a time while
+ * their allocations are copied, and the output is written outside the locks.
+ ******************************************************************************/
+
+// Native byte order, no padding. Header: uint32 magic, uint32 version. Then records, starting with the uint8 record type.
+#define HbMem_Snapshot_Magic UINT32_C(0x534D4248) // "HBMS" on little-endian.
+#define HbMem_Snapshot_Version UINT32_C(1)
+typedef enum HbMem_Snapshot_Record {
+	HbMem_Snapshot_Record_End,
+	// uint32 name length, name (not terminated), uint64 live size, uint64 live count. Followed by the allocation records of the tag.
+	// The totals are gathered separately from the allocations, so they may differ from their sums with concurrent allocations.
+	HbMem_Snapshot_Record_Tag,
+	// uint32 ID (sequential from 0), uint32 length, text (not terminated). Written before the first reference to the string.
+	HbMem_Snapshot_Record_String,
+	// uint32 origin name string ID, uint32 origin location, uint64 size. None if the header is compact.
+	HbMem_Snapshot_Record_Allocation,
+} HbMem_Snapshot_Record;
+// Doesn't block allocations of a shard while writing, but the root's tags can't be created or destroyed until it's done.
+HbBool HbMem_Tag_Root_WriteSnapshot(HbMem_Tag_Root * const tagRoot, HbMem_WriteCallback const write, void * const userData);
+
+// The returned buffer has alignment of HbPlatform_AllocAlignment unless a stricter power of two alignment is requested explicitly.
+// Reallocation keeps the alignment of the allocation.
+void * HbMem_Tag_AllocAlignedExplicit(HbMem_Tag * const tag, size_t const size, size_t const alignment, HbBool const required,
+                                      char const * const originNameImmutable, unsigned const originLocation);
+void * HbMem_Tag_AllocAlignedElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t count, size_t const alignment, HbBool const required,
+                                              char const * const originNameImmutable, unsigned const originLocation);
+HbForceInline void * HbMem_Tag_AllocExplicit(HbMem_Tag * const tag, size_t const size, HbBool const required,
+                                             char const * const originNameImmutable, unsigned const originLocation) {
+	return HbMem_Tag_AllocAlignedExplicit(tag, size, HbPlatform_AllocAlignment, required, originNameImmutable, originLocation);
+}
+HbForceInline void * HbMem_Tag_AllocElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t count, HbBool const required,
+                                                     char const * const originNameImmutable, unsigned const originLocation) {
+	return HbMem_Tag_AllocAlignedElementsExplicit(tag, elementSize, count, HbPlatform_AllocAlignment, required, originNameImmutable, originLocation);
+}
 #define HbMem_Tag_Alloc(tag, type, count) ((type *) HbMem_Tag_AllocElementsExplicit(tag, sizeof(type), count, HbTrue, __func__, __LINE__))
 #define HbMem_Tag_AllocChecked(tag, type, count) ((type *) HbMem_Tag_AllocElementsExplicit(tag, sizeof(type), count, HbFalse, __func__, __LINE__))
+#define HbMem_Tag_AllocAligned(tag, type, count, alignment) \
+	((type *) HbMem_Tag_AllocAlignedElementsExplicit(tag, sizeof(type), count, alignment, HbTrue, __func__, __LINE__))
+#define HbMem_Tag_AllocAlignedChecked(tag, type, count, alignment) \
+	((type *) HbMem_Tag_AllocAlignedElementsExplicit(tag, sizeof(type), count, alignment, HbFalse, __func__, __LINE__))
 // The buffer must already be allocated with Alloc because no origin info is passed to this and so intentions need to be specified clearly to reduce error probability.
 HbBool HbMem_Tag_ReallocExplicit(void * * const buffer, size_t const size, HbBool const required);
 HbBool HbMem_Tag_ReallocElementsExplicit(void * * const buffer, size_t const elementSize, size_t count, HbBool const required);
-#define HbMem_Tag_Realloc(buffer, type, count) HbMem_Tag_ReallocElementsExplicit((void * *) &(buffer), sizeof(type) * (count), HbTrue)
-#define HbMem_Tag_ReallocChecked(buffer, type, count) HbMem_Tag_ReallocElementsExplicit((void * *) &(buffer), sizeof(type) * (count), HbFalse)
+#define HbMem_Tag_Realloc(buffer, type, count) HbMem_Tag_ReallocElementsExplicit((void * *) &(buffer), sizeof(type), count, HbTrue)
+#define HbMem_Tag_ReallocChecked(buffer, type, count) HbMem_Tag_ReallocElementsExplicit((void * *) &(buffer), sizeof(type), count, HbFalse)
 // The buffer must exist - null pointers are generally not allowed to detect errors easier, and this is not an exception.
 void HbMem_Tag_Free(void * const buffer);
 
@@ -76,9 +286,226 @@ HbForceInline HbMem_Tag_Allocation const * HbMem_Tag_GetAllocation(void const *
 	return (HbMem_Tag_Allocation const *) buffer - 1;
 }
 
+HbForceInline size_t HbMem_Tag_GetAlignment(void const * const buffer) {
+	unsigned const overAlignmentLog2 = HbMem_Tag_GetAllocation(buffer)->overAlignmentLog2_i;
+	return overAlignmentLog2 != 0 ? (size_t) 1 << overAlignmentLog2 : HbPlatform_AllocAlignment;
+}
+
+/*************************************************************************************
+ * Page-level tagged allocations
+ * For large buffers - directly from the OS virtual memory allocator, so large pages
+ * can be used to reduce TLB misses, and unused ranges can be returned to the OS.
+ * Reallocated and freed with the regular HbMem_Tag_Realloc and HbMem_Tag_Free.
+ *************************************************************************************/
+
+// Large pages require the "Lock pages in memory" privilege on Windows, and are never paged out or purged.
+// Normal pages are used if large pages can't be allocated.
+#define HbMem_Tag_PagesFlag_LargePages 1u
+// The buffer is placed after the header in the first page, so it has the alignment of HbPlatform_AllocAlignment.
+void * HbMem_Tag_AllocPagesExplicit(HbMem_Tag * const tag, size_t const size, unsigned const flags, HbBool const required,
+                                    char const * const originNameImmutable, unsigned const originLocation);
+void * HbMem_Tag_AllocPagesElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t count, unsigned const flags, HbBool const required,
+                                            char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_Tag_AllocPages(tag, type, count, flags) ((type *) HbMem_Tag_AllocPagesElementsExplicit(tag, sizeof(type), count, flags, HbTrue, __func__, __LINE__))
+#define HbMem_Tag_AllocPagesChecked(tag, type, count, flags) \
+	((type *) HbMem_Tag_AllocPagesElementsExplicit(tag, sizeof(type), count, flags, HbFalse, __func__, __LINE__))
+// Reserves address space for up to maxSize bytes, committing only the pages needed for the current size.
+// Reallocation within maxSize commits or decommits pages without moving the buffer, and fails beyond maxSize.
+void * HbMem_Tag_ReservePagesExplicit(HbMem_Tag * const tag, size_t const size, size_t const maxSize, HbBool const required,
+                                      char const * const originNameImmutable, unsigned const originLocation);
+void * HbMem_Tag_ReservePagesElementsExplicit(HbMem_Tag * const tag, size_t const elementSize, size_t const count, size_t const maxCount, HbBool const required,
+                                              char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_Tag_ReservePages(tag, type, count, maxCount) \
+	((type *) HbMem_Tag_ReservePagesElementsExplicit(tag, sizeof(type), count, maxCount, HbTrue, __func__, __LINE__))
+#define HbMem_Tag_ReservePagesChecked(tag, type, count, maxCount) \
+	((type *) HbMem_Tag_ReservePagesElementsExplicit(tag, sizeof(type), count, maxCount, HbFalse, __func__, __LINE__))
+// Lets the OS discard the pages fully within the range of the page allocation. Their contents are undefined afterwards until written.
+// The allocation stays accounted to the tag with its full size. Does nothing for large pages.
+void HbMem_Tag_PurgePages(void * const buffer, size_t const offset, size_t const size);
+
 // When the header is relatively not a waste of space - slightly bigger than HbMem_Tag_Allocation on a 64-bit target.
 #define HbMem_Tag_RecommendedMinAlloc ((size_t) 64)
 
+/********************************************************************************
+ * Small object allocator
+ * Backs tagged allocations up to HbMem_Slab_MaxSize including the header.
+ * Every thread has its own heap of spans, one size class per span.
+ * Blocks freed by other threads are sent back to the owner of the span.
+ * Empty spans are returned to the central pool to be reused by any thread.
+ ********************************************************************************/
+
+// Spans are aligned to their size, so the span of a block is found by masking the address.
+#define HbMem_Slab_SpanSize ((size_t) 1 << 16)
+#define HbMem_Slab_MaxSize ((size_t) 1024)
+#define HbMem_Slab_ClassCount 20
+#define HbMem_Slab_Class_None UINT_LEAST8_MAX
+// Not slab classes - used in the headers of page-level tagged allocations.
+#define HbMem_Slab_Class_Pages (UINT_LEAST8_MAX - 1)
+#define HbMem_Slab_Class_LargePages (UINT_LEAST8_MAX - 2)
+#define HbMem_Slab_Class_ReservedPages (UINT_LEAST8_MAX - 3)
+extern size_t const HbMem_Slab_ClassSizes[HbMem_Slab_ClassCount]; // 16, 32, 48... multiples of 16 to keep HbPlatform_AllocAlignment.
+
+// HbMem_Slab_Class_None if larger than HbMem_Slab_MaxSize.
+size_t HbMem_Slab_GetClass(size_t const size);
+// Returns NULL if failed to get memory for a new span from the OS.
+void * HbMem_Slab_Alloc(size_t const sizeClass);
+// Can be called from any thread.
+void HbMem_Slab_Free(void * const block);
+// Call before exiting a thread that has allocated small objects, so its heap with the blocks still in use can be taken by a new thread.
+void HbMem_Slab_Thread_Shutdown();
+
+/**************************************************************************
+ * Linear allocator
+ * For temporary data freed all at once - carving memory from tagged blocks
+ * that are kept when the arena is reset or rolled back to a mark.
+ **************************************************************************/
+
+typedef struct HbAligned(HbPlatform_AllocAlignment) HbMem_Arena_Block_i {
+	struct HbMem_Arena_Block_i * next_i;
+	size_t size_i;
+	// Followed by the data.
+} HbMem_Arena_Block_i;
+
+typedef struct HbMem_Arena {
+	HbMem_Tag * tag_e;
+	size_t blockSize_r; // Blocks are larger only for allocations that don't fit in a block of this size.
+	HbMem_Arena_Block_i * blockFirst_i;
+	HbMem_Arena_Block_i * blockCurrent_i; // Blocks after the current one are unused, but kept for reuse.
+	size_t blockCurrentUsed_i;
+	char const * originNameImmutable_r;
+	unsigned originLocation_r;
+} HbMem_Arena;
+
+// The block size doesn't include the headers, so it's preferable to have some space for them before the next power of two.
+#define HbMem_Arena_DefaultBlockSize ((size_t) 64 * 1024 - 256)
+
+HbForceInline void HbMem_Arena_InitExplicit(HbMem_Arena * const arena, size_t const blockSize, HbMem_Tag * const tag,
+                                            char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(arena != NULL);
+	HbReport_Assert_Assume(blockSize != 0);
+	arena->tag_e = tag;
+	arena->blockSize_r = blockSize;
+	arena->blockFirst_i = arena->blockCurrent_i = NULL;
+	arena->blockCurrentUsed_i = 0;
+	arena->originNameImmutable_r = originNameImmutable;
+	arena->originLocation_r = originLocation;
+}
+#define HbMem_Arena_Init(arena, blockSize, tag) HbMem_Arena_InitExplicit(arena, blockSize, tag, __func__, __LINE__)
+void HbMem_Arena_Shutdown(HbMem_Arena * const arena);
+
+// Switches to the next kept block, or allocates a new one, if the allocation doesn't fit in the current block.
+void * HbMem_Arena_AllocInNextBlock_i(HbMem_Arena * const arena, size_t const size, size_t const alignment, HbBool const required);
+
+// The alignment must be a power of two.
+HbForceInline void * HbMem_Arena_AllocAlignedExplicit(HbMem_Arena * const arena, size_t const size, size_t const alignment, HbBool const required) {
+	HbReport_Assert_Assume(arena != NULL);
+	HbReport_Assert_Assume(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	HbMem_Arena_Block_i * const block = arena->blockCurrent_i;
+	if (block != NULL) {
+		uintptr_t const blockData = (uintptr_t) (block + 1);
+		size_t const offset = (size_t) (HbMath_Align(blockData + arena->blockCurrentUsed_i, (uintptr_t) alignment) - blockData);
+		if (offset <= block->size_i && size <= block->size_i - offset) {
+			arena->blockCurrentUsed_i = offset + size;
+			return (void *) (blockData + offset);
+		}
+	}
+	return HbMem_Arena_AllocInNextBlock_i(arena, size, alignment, required);
+}
+void * HbMem_Arena_AllocAlignedElementsExplicit(HbMem_Arena * const arena, size_t const elementSize, size_t const count, size_t const alignment, HbBool const required);
+#define HbMem_Arena_Alloc(arena, type, count) \
+	((type *) HbMem_Arena_AllocAlignedElementsExplicit(arena, sizeof(type), count, HbPlatform_AllocAlignment, HbTrue))
+#define HbMem_Arena_AllocChecked(arena, type, count) \
+	((type *) HbMem_Arena_AllocAlignedElementsExplicit(arena, sizeof(type), count, HbPlatform_AllocAlignment, HbFalse))
+#define HbMem_Arena_AllocAligned(arena, type, count, alignment) \
+	((type *) HbMem_Arena_AllocAlignedElementsExplicit(arena, sizeof(type), count, alignment, HbTrue))
+#define HbMem_Arena_AllocAlignedChecked(arena, type, count, alignment) \
+	((type *) HbMem_Arena_AllocAlignedElementsExplicit(arena, sizeof(type), count, alignment, HbFalse))
+
+// Position to roll back to, freeing everything allocated after it while keeping the blocks.
+typedef struct HbMem_Arena_Mark {
+	HbMem_Arena_Block_i * block_i;
+	size_t blockUsed_i;
+} HbMem_Arena_Mark;
+
+HbForceInline HbMem_Arena_Mark HbMem_Arena_GetMark(HbMem_Arena const * const arena) {
+	HbReport_Assert_Assume(arena != NULL);
+	HbMem_Arena_Mark mark;
+	mark.block_i = arena->blockCurrent_i;
+	mark.blockUsed_i = arena->blockCurrentUsed_i;
+	return mark;
+}
+
+HbForceInline void HbMem_Arena_Rollback(HbMem_Arena * const arena, HbMem_Arena_Mark const mark) {
+	HbReport_Assert_Assume(arena != NULL);
+	// A mark taken before the first allocation refers to no block, that's the same as resetting.
+	arena->blockCurrent_i = mark.block_i != NULL ? mark.block_i : arena->blockFirst_i;
+	arena->blockCurrentUsed_i = mark.blockUsed_i;
+}
+
+HbForceInline void HbMem_Arena_Reset(HbMem_Arena * const arena) {
+	HbReport_Assert_Assume(arena != NULL);
+	arena->blockCurrent_i = arena->blockFirst_i;
+	arena->blockCurrentUsed_i = 0;
+}
+
+// Including padding for alignment and the unused ends of the blocks before the current one.
+size_t HbMem_Arena_GetUsedSize(HbMem_Arena const * const arena);
+
+/**********************************************************************************
+ * Per-thread frame scratch memory
+ * For data that must live for a fixed number of frames (like 2 or 3 when the GPU
+ * is behind the CPU by that many frames) - one arena per thread per frame in
+ * flight, reset when the frame that has used it last has been retired.
+ * Threads are identified by indices explicitly passed to the allocation functions.
+ **********************************************************************************/
+
+typedef struct HbAligned(HbPlatform_CacheLineSize) HbMem_Scratch_Thread_i {
+	HbMem_Arena * frameArenas_i; // [frameCount_r], aligned to the cache line size.
+	size_t highWaterMark_i; // Lock-free reads only when no frame is being begun.
+} HbMem_Scratch_Thread_i;
+
+typedef struct HbMem_Scratch {
+	size_t threadCount_r;
+	size_t frameCount_r;
+	uint64_t frame_r; // Incremented by HbMem_Scratch_BeginFrame.
+	size_t frameArenaIndex_i; // frame_r % frameCount_r.
+	size_t frameHighWaterMark_r; // The largest total size of all threads' data in one retired frame.
+	HbMem_Scratch_Thread_i * threads_i; // [threadCount_r]
+	HbMem_Tag * tag_e;
+} HbMem_Scratch;
+
+void HbMem_Scratch_InitExplicit(HbMem_Scratch * const scratch, size_t const threadCount, size_t const frameCount, size_t const blockSize,
+                                HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_Scratch_Init(scratch, threadCount, frameCount, blockSize, tag) \
+	HbMem_Scratch_InitExplicit(scratch, threadCount, frameCount, blockSize, tag, __func__, __LINE__)
+void HbMem_Scratch_Shutdown(HbMem_Scratch * const scratch);
+
+#define HbMem_Scratch_NoFrameToRetire UINT64_MAX
+// The frame which must be retired (with all its data not used anymore, like after waiting for its GPU fence) before the next HbMem_Scratch_BeginFrame.
+HbForceInline uint64_t HbMem_Scratch_GetFrameToRetire(HbMem_Scratch const * const scratch) {
+	HbReport_Assert_Assume(scratch != NULL);
+	uint64_t const nextFrame = scratch->frame_r + 1;
+	return nextFrame >= scratch->frameCount_r ? nextFrame - scratch->frameCount_r : HbMem_Scratch_NoFrameToRetire;
+}
+// Must not be called while any thread is allocating scratch memory.
+void HbMem_Scratch_BeginFrame(HbMem_Scratch * const scratch);
+
+HbForceInline HbMem_Arena * HbMem_Scratch_GetThreadArena(HbMem_Scratch * const scratch, size_t const threadIndex) {
+	HbReport_Assert_Assume(scratch != NULL);
+	HbReport_Assert_Assume(threadIndex < scratch->threadCount_r);
+	return &scratch->threads_i[threadIndex].frameArenas_i[scratch->frameArenaIndex_i];
+}
+#define HbMem_Scratch_Alloc(scratch, threadIndex, type, count) HbMem_Arena_Alloc(HbMem_Scratch_GetThreadArena(scratch, threadIndex), type, count)
+#define HbMem_Scratch_AllocAligned(scratch, threadIndex, type, count, alignment) \
+	HbMem_Arena_AllocAligned(HbMem_Scratch_GetThreadArena(scratch, threadIndex), type, count, alignment)
+
+// The largest size of the data of one thread in one retired frame, for choosing the block size.
+HbForceInline size_t HbMem_Scratch_GetThreadHighWaterMark(HbMem_Scratch const * const scratch, size_t const threadIndex) {
+	HbReport_Assert_Assume(scratch != NULL);
+	HbReport_Assert_Assume(threadIndex < scratch->threadCount_r);
+	return scratch->threads_i[threadIndex].highWaterMark_i;
+}
+
 /***********************
  * Dynamic-length array
  ***********************/
@@ -88,28 +515,67 @@ typedef struct HbMem_DynArray {
 	size_t elementSize_r;
 	size_t capacity_r;
 	size_t count_r;
+	size_t alignment_r;
+	size_t reservedCapacity_r; // Non-zero if the data is in reserved pages - never moved, but can't grow beyond this.
+	// Externally owned storage used while the count fits in it, so small arrays don't allocate from the tag at all.
+	void * inlineData_e;
+	size_t inlineCapacity_r; // 0 if there's no inline storage.
 	HbMem_Tag * tag_e;
 	char const * originNameImmutable_r;
 	unsigned originLocation_r;
 } HbMem_DynArray;
 
-HbForceInline void HbMem_DynArray_InitExplicit(HbMem_DynArray * const array, size_t const elementSize,
+HbForceInline void HbMem_DynArray_InitExplicit(HbMem_DynArray * const array, size_t const elementSize, size_t const alignment,
                                                HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
 	HbReport_Assert_Assume(array != NULL);
 	HbReport_Assert_Assume(elementSize != 0);
+	HbReport_Assert_Assume(alignment != 0 && (alignment & (alignment - 1)) == 0);
 	array->data_r = NULL;
 	array->elementSize_r = elementSize;
+	array->alignment_r = alignment;
+	array->reservedCapacity_r = 0;
+	array->inlineData_e = NULL;
+	array->inlineCapacity_r = 0;
 	array->capacity_r = 0;
 	array->count_r = 0;
 	array->tag_e = tag;
 	array->originNameImmutable_r = originNameImmutable;
 	array->originLocation_r = originLocation;
 }
-#define HbMem_DynArray_Init(array, elementType, tag) HbMem_DynArray_InitExplicit(array, sizeof(elementType), tag, __func__, __LINE__)
+#define HbMem_DynArray_Init(array, elementType, tag) HbMem_DynArray_InitExplicit(array, sizeof(elementType), HbPlatform_AllocAlignment, tag, __func__, __LINE__)
+#define HbMem_DynArray_InitAligned(array, elementType, alignment, tag) HbMem_DynArray_InitExplicit(array, sizeof(elementType), alignment, tag, __func__, __LINE__)
+// For large arrays with stable addresses - growing commits pages without copying, and trimming decommits them.
+// The address space is reserved on the first allocation of the data.
+HbForceInline void HbMem_DynArray_InitReservedExplicit(HbMem_DynArray * const array, size_t const elementSize, size_t const reservedCapacity,
+                                                       HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(reservedCapacity != 0);
+	HbMem_DynArray_InitExplicit(array, elementSize, HbPlatform_AllocAlignment, tag, originNameImmutable, originLocation);
+	array->reservedCapacity_r = reservedCapacity;
+}
+#define HbMem_DynArray_InitReserved(array, elementType, reservedCapacity, tag) \
+	HbMem_DynArray_InitReservedExplicit(array, sizeof(elementType), reservedCapacity, tag, __func__, __LINE__)
+// Keeps the elements in the inline storage (usually an array next to the HbMem_DynArray in the owning structure) until they don't fit there,
+// and moves them back when trimmed to fit. The array can't be copied or moved in memory while the data is inline.
+// The alignment is only for the heap data - the inline storage must be suitably aligned by its declaration.
+HbForceInline void HbMem_DynArray_InitInlineExplicit(HbMem_DynArray * const array, size_t const elementSize, size_t const alignment,
+                                                     void * const inlineData, size_t const inlineCapacity,
+                                                     HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(inlineData != NULL);
+	HbReport_Assert_Assume(inlineCapacity != 0);
+	HbMem_DynArray_InitExplicit(array, elementSize, alignment, tag, originNameImmutable, originLocation);
+	array->data_r = array->inlineData_e = inlineData;
+	array->capacity_r = array->inlineCapacity_r = inlineCapacity;
+}
+#define HbMem_DynArray_InitInline(array, elementType, inlineElements, tag) \
+	HbMem_DynArray_InitInlineExplicit(array, sizeof(elementType), HbPlatform_AllocAlignment, inlineElements, HbCountOf(inlineElements), tag, __func__, __LINE__)
+HbForceInline HbBool HbMem_DynArray_IsInline(HbMem_DynArray const * const array) {
+	HbReport_Assert_Assume(array != NULL);
+	return array->inlineCapacity_r != 0 && array->data_r == array->inlineData_e;
+}
 
 HbForceInline void HbMem_DynArray_Shutdown(HbMem_DynArray * const array) {
 	HbReport_Assert_Assume(array != NULL);
-	if (array->data_r != NULL) {
+	if (array->data_r != NULL && array->data_r != array->inlineData_e) {
 		HbMem_Tag_Free(array->data_r);
 	}
 }
@@ -119,14 +585,18 @@ size_t HbMem_DynArray_GetCapacityForGrowingExplicit(size_t const elementSize, si
 
 HbForceInline size_t HbMem_DynArray_GetCapacityForGrowing(HbMem_DynArray const * const array, size_t const neededSize) {
 	HbReport_Assert_Assume(array != NULL);
-	return HbMem_DynArray_GetCapacityForGrowingExplicit(array->elementSize_r, array->capacity_r, neededSize);
+	size_t const capacity = HbMem_DynArray_GetCapacityForGrowingExplicit(array->elementSize_r, array->capacity_r, neededSize);
+	if (array->reservedCapacity_r != 0 && neededSize <= array->reservedCapacity_r) {
+		return HbMath_Min_Size(capacity, array->reservedCapacity_r);
+	}
+	return capacity;
 }
 
 void HbMem_DynArray_ReserveExactly(HbMem_DynArray * const array, size_t const capacity, HbBool const trim);
 
 HbForceInline void HbMem_DynArray_TrimCapacity(HbMem_DynArray * const array) {
 	HbReport_Assert_Assume(array != NULL);
-	HbMem_DynArray_ReserveExactly(array, array->capacity_r, HbTrue);
+	HbMem_DynArray_ReserveExactly(array, array->count_r, HbTrue);
 }
 
 HbForceInline void HbMem_DynArray_ReserveForGrowing(HbMem_DynArray * const array, size_t const count) {
@@ -240,6 +710,24 @@ HbForceInline void HbMem_DynArray_RemoveFromEnd(HbMem_DynArray * const array, si
 	array->count_r -= count;
 }
 
+// Batch operations, moving every element at most once instead of once per inserted or removed element.
+// Returns the offset of the first appended element. The elements must not be in the array itself, as it may be reallocated.
+size_t HbMem_DynArray_AppendRange(HbMem_DynArray * const array, void const * const elements, size_t const count);
+// Sign of the result like in qsort.
+typedef int (* HbMem_DynArray_CompareCallback)(void const * const element1, void const * const element2, void * const userData);
+// Both the array and the elements must be sorted. Elements equal to existing ones are inserted after them.
+void HbMem_DynArray_InsertRangeIntoSorted(HbMem_DynArray * const array, void const * const elements, size_t const count,
+                                          HbMem_DynArray_CompareCallback const compare, void * const userData);
+typedef HbBool (* HbMem_DynArray_PredicateCallback)(void const * const element, void * const userData);
+// Keeps the order of the remaining elements. Returns the number of the removed elements.
+size_t HbMem_DynArray_RemoveIfFromSorted(HbMem_DynArray * const array, HbMem_DynArray_PredicateCallback const predicate, void * const userData);
+// The indices must be sorted and unique. Keeps the order of the remaining elements.
+void HbMem_DynArray_RemoveIndicesFromSorted(HbMem_DynArray * const array, size_t const * const indices, size_t const indexCount);
+// Moves the elements matching the predicate before the rest, keeping the order within both parts. Returns the number of the matching elements.
+// The predicate is called once for each element, in order.
+// Temporarily allocates memory from the array's tag for the elements not matching if there are any before matching ones.
+size_t HbMem_DynArray_PartitionStable(HbMem_DynArray * const array, HbMem_DynArray_PredicateCallback const predicate, void * const userData);
+
 HbForceInline void const * HbMem_DynArray_GetExplicit(HbMem_DynArray const * const array, size_t const index) {
 	HbReport_Assert_Assume(array != NULL && "Dynamic-length array must not be NULL. Additionally, this is triggered when GetC is called with a mismatching type size.");
 	HbReport_Assert_Assume(index < array->count_r);
@@ -259,8 +747,8 @@ HbForceInline void * HbMem_DynArray_GetMutExplicit(HbMem_DynArray * const array,
 #define HbMem_DynArray_Get(array, index, elementType) ((elementType const *) HbMem_DynArray_GetExplicit((array) != NULL && (array)->elementSize_r == sizeof(elementType) ? (array) : NULL, index))
 #define HbMem_DynArray_GetMut(array, index, elementType) ((elementType *) HbMem_DynArray_GetMutExplicit((array) != NULL && (array)->elementSize_r == sizeof(elementType) ? (array) : NULL, index))
 #else
-#define HbMem_DynArray_Get(array, index, elementType) (((elementType const *) (array)->data_r)[index])
-#define HbMem_DynArray_GetMut(array, index, elementType) (((elementType *) (array)->data_r)[index])
+#define HbMem_DynArray_Get(array, index, elementType) ((elementType const *) (array)->data_r + (index))
+#define HbMem_DynArray_GetMut(array, index, elementType) ((elementType *) (array)->data_r + (index))
 #endif
 
 /***********************************************
@@ -268,6 +756,11 @@ HbForceInline void * HbMem_DynArray_GetMutExplicit(HbMem_DynArray * const array,
  ***********************************************/
 
 extern size_t const HbMem_FibAlloc_Sizes[]; // 1, 2, 3, 5... the largest not above SIZE_MAX.
+#if HbPlatform_CPU_Bits >= 64
+#define HbMem_FibAlloc_LevelCount 92
+#else
+#define HbMem_FibAlloc_LevelCount 46
+#endif
 
 size_t HbMem_FibAlloc_ClosestLevelRoundingDown(size_t const size);
 size_t HbMem_FibAlloc_ClosestLevelRoundingUp(size_t const size);
@@ -277,11 +770,23 @@ size_t HbMem_FibAlloc_ClosestLevelRoundingUp(size_t const size);
 // Instead of giving the exact amount requested, the allocator will, in the best case, return the needed amount *plus fragmentation padding*.
 // If there's no free block of such size, it will try to give the largest possible block not smaller than the minimum needed size.
 
+// HbMem_Build_CompactFibAlloc may be enabled in the build configuration to store node indices and offsets as 32-bit (nodes of 24 bytes rather than 40
+// on 64-bit targets), if no allocator needs more than 2^31 nodes or a largest level above 45 (offsets above 2^32).
+
 typedef struct HbMem_FibAlloc {
 	size_t largestLevel_r;
 	HbMem_DynArray /* <HbMem_FibAlloc_Node_i> */ nodes_i; // Stable indices, recycling when both children are empty. [0] is the root.
-	size_t lastRecycledNodeIndex_i; // SIZE_MAX if no deallocated nodes.
+	size_t lastRecycledNodeIndex_i; // 0 (the root, which is never recycled) if no deallocated nodes.
 	struct HbMem_FibAlloc_FreeList_i * freeLists_i; // [largestLevel_r + 1], the last element contains the whole tree as the larger child if the tree is empty.
+	// Bit per level, set if any of the free lists of the level is not empty, for finding the closest free level without visiting every level.
+	size_t freeLevelMasks_i[(HbMem_FibAlloc_LevelCount + (HbPlatform_CPU_Bits - 1)) / HbPlatform_CPU_Bits];
+	// Open addressing hash table from the offsets of the live allocations to their nodes, so freeing doesn't need to search from the root.
+	struct HbMem_FibAlloc_Allocation_i * allocations_i;
+	size_t allocationCapacity_i; // Power of two or 0.
+	size_t allocationCount_i;
+	// Statistics updated on every change for monitoring without walking the tree.
+	size_t freeUnitCount_r;
+	size_t recycledNodeCount_r;
 } HbMem_FibAlloc;
 
 void HbMem_FibAlloc_InitExplicit(HbMem_FibAlloc * const fibAlloc, size_t const largestLevel, HbMem_Tag * const tag,
@@ -294,6 +799,511 @@ void HbMem_FibAlloc_Shutdown(HbMem_FibAlloc * const fibAlloc);
 size_t HbMem_FibAlloc_Alloc(HbMem_FibAlloc * const fibAlloc, size_t const minimumCount, size_t const preferredCount, size_t * const allocationLevelOut);
 void HbMem_FibAlloc_Free(HbMem_FibAlloc * const fibAlloc, size_t const allocation);
 
+HbForceInline size_t HbMem_FibAlloc_GetLiveAllocationCount(HbMem_FibAlloc const * const fibAlloc) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	return fibAlloc->allocationCount_i;
+}
+
+HbForceInline size_t HbMem_FibAlloc_GetFreeUnitCount(HbMem_FibAlloc const * const fibAlloc) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	return fibAlloc->freeUnitCount_r;
+}
+
+// SIZE_MAX if there are no free blocks.
+HbForceInline size_t HbMem_FibAlloc_GetLargestFreeLevel(HbMem_FibAlloc const * const fibAlloc) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	for (size_t maskIndex = HbCountOf(fibAlloc->freeLevelMasks_i); maskIndex-- != 0; ) {
+		size_t const mask = fibAlloc->freeLevelMasks_i[maskIndex];
+		if (mask != 0) {
+			return maskIndex * HbPlatform_CPU_Bits + (HbPlatform_CPU_Bits - 1 - HbMath_CountLeadingZeros_Size(mask));
+		}
+	}
+	return SIZE_MAX;
+}
+
+// An allocation with a minimum count not larger than this will succeed, 0 if there are no free blocks.
+HbForceInline size_t HbMem_FibAlloc_GetLargestFreeSize(HbMem_FibAlloc const * const fibAlloc) {
+	size_t const largestFreeLevel = HbMem_FibAlloc_GetLargestFreeLevel(fibAlloc);
+	return largestFreeLevel != SIZE_MAX ? HbMem_FibAlloc_Sizes[largestFreeLevel] : 0;
+}
+
+// The part of the free units that are not in the largest free block, from 0 (all free units are available for one allocation) to almost 1.
+HbForceInline float HbMem_FibAlloc_GetExternalFragmentation(HbMem_FibAlloc const * const fibAlloc) {
+	size_t const freeUnitCount = HbMem_FibAlloc_GetFreeUnitCount(fibAlloc);
+	if (freeUnitCount == 0) {
+		return 0;
+	}
+	return (float) (freeUnitCount - HbMem_FibAlloc_GetLargestFreeSize(fibAlloc)) / (float) freeUnitCount;
+}
+
+typedef struct HbMem_FibAlloc_Stats {
+	size_t liveAllocationCount_r;
+	size_t freeUnitCount_r;
+	size_t largestFreeLevel_r; // SIZE_MAX if there are no free blocks.
+	size_t nodeCount_r; // Not including the recycled nodes.
+	size_t recycledNodeCount_r;
+	size_t freeBlockCounts_r[HbMem_FibAlloc_LevelCount]; // Up to largestLevel_r, multiply by HbMem_FibAlloc_Sizes for the free units on each level.
+} HbMem_FibAlloc_Stats;
+void HbMem_FibAlloc_GetStats(HbMem_FibAlloc const * const fibAlloc, HbMem_FibAlloc_Stats * const stats);
+
+/**************************************************************************
+ * Concurrent Fibonacci number-sized block allocator
+ * HbMem_FibAlloc behind a mutex, with blocks of each level cached per
+ * thread shard, so most allocations and frees don't lock the tree.
+ * Blocks are taken from the tree in batches when a cache level is empty,
+ * and returned in batches when it's full. All cached blocks are returned
+ * to the tree, so they can be merged, if an allocation in it fails, or on
+ * HbMem_FibAlloc_Concurrent_Flush.
+ **************************************************************************/
+
+#define HbMem_FibAlloc_Concurrent_ShardCount 16
+#define HbMem_FibAlloc_Concurrent_CacheCapacity 8 // Blocks of each level in each shard.
+#define HbMem_FibAlloc_Concurrent_BatchCount 4 // Blocks taken from or returned to the tree at once.
+
+typedef struct HbAligned(HbPlatform_CacheLineSize) HbMem_FibAlloc_Concurrent_Shard_i {
+	HbPara_Spinlock lock_i;
+	// Both lock lock_i, allocated together with the tag of the allocator.
+	uint8_t * cachedCounts_i; // [largestLevel_r + 1].
+	size_t * cachedAllocations_i; // [largestLevel_r + 1][HbMem_FibAlloc_Concurrent_CacheCapacity], the most recently freed last.
+} HbMem_FibAlloc_Concurrent_Shard_i;
+
+typedef struct HbMem_FibAlloc_Concurrent {
+	HbPara_Mutex fibAllocMutex_i;
+	HbMem_FibAlloc fibAlloc_i; // Lock fibAllocMutex_i.
+	HbMem_FibAlloc_Concurrent_Shard_i shards_i[HbMem_FibAlloc_Concurrent_ShardCount];
+} HbMem_FibAlloc_Concurrent;
+
+void HbMem_FibAlloc_Concurrent_InitExplicit(HbMem_FibAlloc_Concurrent * const fibAlloc, size_t const largestLevel, HbMem_Tag * const tag,
+                                            char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_FibAlloc_Concurrent_Init(fibAlloc, largestLevel, tag) HbMem_FibAlloc_Concurrent_InitExplicit(fibAlloc, largestLevel, tag, __func__, __LINE__)
+// All blocks must be freed by the time of the shutdown, cached blocks are discarded.
+void HbMem_FibAlloc_Concurrent_Shutdown(HbMem_FibAlloc_Concurrent * const fibAlloc);
+
+// Same as HbMem_FibAlloc_Alloc.
+size_t HbMem_FibAlloc_Concurrent_Alloc(HbMem_FibAlloc_Concurrent * const fibAlloc, size_t const minimumCount, size_t const preferredCount,
+                                       size_t * const allocationLevelOut);
+// The level must be the one returned from the allocation, or HbMem_FibAlloc_ClosestLevelRoundingUp of the count if the minimum and the preferred counts were equal.
+// In assert builds, the level and double freeing are checked against the tree and the caches of all threads, serializing the frees.
+// Otherwise, freeing twice is only detected if the block is still cached by the shard of the freeing thread, or if both copies reach the tree.
+// A block freed twice from threads of different shards, or after leaving the cache, may be returned from two allocations without any error.
+void HbMem_FibAlloc_Concurrent_Free(HbMem_FibAlloc_Concurrent * const fibAlloc, size_t const allocation, size_t const allocationLevel);
+// Returns the blocks cached by all threads to the tree.
+void HbMem_FibAlloc_Concurrent_Flush(HbMem_FibAlloc_Concurrent * const fibAlloc);
+// Statistics of the tree, where the blocks cached by the threads are counted as live allocations.
+void HbMem_FibAlloc_Concurrent_GetStats(HbMem_FibAlloc_Concurrent * const fibAlloc, HbMem_FibAlloc_Stats * const stats);
+
+/*************************************************************************
+ * Ordered B+ tree
+ * Elements of a fixed size kept sorted in nodes of a few cache lines
+ * allocated from a tag, so insertion and removal only move the elements
+ * within one node. Elements are only in the leaves, which are linked for
+ * iteration, and are unique by the comparison. Pointers to elements and
+ * cursors are invalidated by insertion and removal.
+ *************************************************************************/
+
+// Enough to scan with few cache misses (adjacent lines are usually prefetched together), small enough to come from the slab allocator.
+#define HbMem_BTree_NodeSize (4 * HbPlatform_CacheLineSize)
+
+typedef struct HbMem_BTree_Leaf_i {
+	struct HbMem_BTree_Leaf_i * prev_i;
+	struct HbMem_BTree_Leaf_i * next_i;
+	size_t count_i;
+	// Followed by the elements at HbMem_BTree_LeafHeaderSize_i.
+} HbMem_BTree_Leaf_i;
+#define HbMem_BTree_LeafHeaderSize_i HbMath_Align(sizeof(HbMem_BTree_Leaf_i), HbPlatform_AllocAlignment)
+
+typedef struct HbMem_BTree {
+	size_t elementSize_r;
+	size_t count_r;
+	// Compares the elements in the tree with each other and with the keys passed to the search functions as the second argument.
+	HbMem_DynArray_CompareCallback compare_r;
+	void * compareUserData_r;
+	size_t leafCapacity_i;
+	size_t branchCapacity_i; // Children, one more than the keys.
+	size_t branchKeysOffset_i;
+	size_t height_i; // 0 if empty, 1 if the root is a leaf.
+	void * root_i;
+	HbMem_BTree_Leaf_i * leafFirst_i;
+	HbMem_BTree_Leaf_i * leafLast_i;
+	HbMem_Tag * tag_e;
+	char const * originNameImmutable_r;
+	unsigned originLocation_r;
+} HbMem_BTree;
+
+// The alignment of the elements is HbPlatform_AllocAlignment.
+void HbMem_BTree_InitExplicit(HbMem_BTree * const tree, size_t const elementSize, HbMem_DynArray_CompareCallback const compare, void * const compareUserData,
+                              HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_BTree_Init(tree, elementType, compare, compareUserData, tag) \
+	HbMem_BTree_InitExplicit(tree, sizeof(elementType), compare, compareUserData, tag, __func__, __LINE__)
+void HbMem_BTree_Shutdown(HbMem_BTree * const tree);
+void HbMem_BTree_Clear(HbMem_BTree * const tree);
+
+// Returns the element equal to the new one if it's already in the tree (without replacing it), or the inserted one.
+void * HbMem_BTree_Insert(HbMem_BTree * const tree, void const * const element, HbBool * const insertedOut);
+// Returns whether the element equal to the key was in the tree.
+HbBool HbMem_BTree_Remove(HbMem_BTree * const tree, void const * const key);
+// The tree must be empty, and the elements sorted and unique. Fills the nodes almost fully, unlike insertion in a loop.
+void HbMem_BTree_BuildFromSorted(HbMem_BTree * const tree, void const * const elements, size_t const count);
+
+// Position of an element for iteration in order. The leaf is NULL at the end.
+typedef struct HbMem_BTree_Cursor {
+	HbMem_BTree_Leaf_i * leaf_i;
+	size_t index_i;
+} HbMem_BTree_Cursor;
+HbForceInline HbMem_BTree_Cursor HbMem_BTree_GetFirst(HbMem_BTree const * const tree) {
+	HbReport_Assert_Assume(tree != NULL);
+	HbMem_BTree_Cursor cursor;
+	cursor.leaf_i = tree->leafFirst_i;
+	cursor.index_i = 0;
+	return cursor;
+}
+// The first element not less than the key.
+HbMem_BTree_Cursor HbMem_BTree_FindFirstNotLess(HbMem_BTree const * const tree, void const * const key);
+// NULL if not found.
+void * HbMem_BTree_Find(HbMem_BTree const * const tree, void const * const key);
+HbForceInline HbBool HbMem_BTree_Cursor_IsValid(HbMem_BTree_Cursor const cursor) {
+	return cursor.leaf_i != NULL;
+}
+HbForceInline void * HbMem_BTree_Cursor_Get(HbMem_BTree const * const tree, HbMem_BTree_Cursor const cursor) {
+	HbReport_Assert_Assume(tree != NULL);
+	HbReport_Assert_Assume(cursor.leaf_i != NULL && cursor.index_i < cursor.leaf_i->count_i);
+	return (HbByte *) cursor.leaf_i + HbMem_BTree_LeafHeaderSize_i + tree->elementSize_r * cursor.index_i;
+}
+HbForceInline void HbMem_BTree_Cursor_Next(HbMem_BTree_Cursor * const cursor) {
+	HbReport_Assert_Assume(cursor != NULL && cursor->leaf_i != NULL);
+	if (++cursor->index_i >= cursor->leaf_i->count_i) {
+		cursor->leaf_i = cursor->leaf_i->next_i;
+		cursor->index_i = 0;
+	}
+}
+
+/***************************************************************************
+ * Concurrent segmented array
+ * Append-only, with appending from multiple threads without locking. Each
+ * segment is twice as large as the previous one and is never moved, so the
+ * published elements can be read while other threads keep appending.
+ ***************************************************************************/
+
+// One 32-bit word of the flags marking the written elements.
+#define HbMem_SegArray_MinFirstSegmentCapacity 32
+#define HbMem_SegArray_DefaultFirstSegmentSize 4096
+
+// Allocate aligned to HbPlatform_CacheLineSize not to share the counters with other data.
+typedef struct HbAligned(HbPlatform_CacheLineSize) HbMem_SegArray {
+	size_t elementSize_r;
+	unsigned firstSegmentCapacityLog2_r;
+	HbMem_Tag * tag_e;
+	char const * originNameImmutable_r;
+	unsigned originLocation_r;
+	// Segment memory: elements, then uint32_t flags of the written elements at HbMem_SegArray_GetSegmentFlagsOffset_i.
+	HbByte * volatile segments_i[HbPlatform_CPU_Bits];
+	// Modified by every append, so on separate cache lines.
+	HbAligned(HbPlatform_CacheLineSize) size_t volatile reservedCount_i;
+	// Elements before this are written, the ones after may be not yet.
+	HbAligned(HbPlatform_CacheLineSize) size_t volatile publishedCount_r;
+} HbMem_SegArray;
+
+// The first segment capacity is rounded up to a power of two, at least HbMem_SegArray_MinFirstSegmentCapacity, 0 for the default.
+void HbMem_SegArray_InitExplicit(HbMem_SegArray * const array, size_t const elementSize, size_t const firstSegmentCapacity,
+                                 HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_SegArray_Init(array, elementType, tag) HbMem_SegArray_InitExplicit(array, sizeof(elementType), 0, tag, __func__, __LINE__)
+// No appending must be in progress.
+void HbMem_SegArray_Shutdown(HbMem_SegArray * const array);
+
+// Thread-safe. Return the index of the (first) new element.
+size_t HbMem_SegArray_Append(HbMem_SegArray * const array, void const * const element);
+size_t HbMem_SegArray_AppendRange(HbMem_SegArray * const array, void const * const elements, size_t const count);
+
+HbForceInline size_t HbMem_SegArray_GetPublishedCount(HbMem_SegArray const * const array) {
+	HbReport_Assert_Assume(array != NULL);
+	return array->publishedCount_r;
+}
+HbForceInline size_t HbMem_SegArray_GetSegmentCapacity_i(HbMem_SegArray const * const array, unsigned const segmentIndex) {
+	return (size_t) 1 << (array->firstSegmentCapacityLog2_r + (segmentIndex != 0 ? segmentIndex - 1 : 0));
+}
+HbForceInline size_t HbMem_SegArray_GetSegmentFlagsOffset_i(HbMem_SegArray const * const array, unsigned const segmentIndex) {
+	return HbMath_Align_Size(array->elementSize_r * HbMem_SegArray_GetSegmentCapacity_i(array, segmentIndex), sizeof(uint32_t));
+}
+// Segment 0 contains [0, first capacity), segment N contains [first capacity << (N - 1), first capacity << N).
+HbForceInline unsigned HbMem_SegArray_Locate_i(HbMem_SegArray const * const array, size_t const index, size_t * const indexInSegmentOut) {
+	size_t const firstSegmentsIndex = index >> array->firstSegmentCapacityLog2_r;
+	if (firstSegmentsIndex == 0) {
+		*indexInSegmentOut = index;
+		return 0;
+	}
+	unsigned const segmentIndex = HbPlatform_CPU_Bits - HbMath_CountLeadingZeros_Size(firstSegmentsIndex);
+	*indexInSegmentOut = index - HbMem_SegArray_GetSegmentCapacity_i(array, segmentIndex);
+	return segmentIndex;
+}
+// The element must be published, or appended by the calling thread.
+HbForceInline void * HbMem_SegArray_Get(HbMem_SegArray const * const array, size_t const index) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(index < array->reservedCount_i);
+	size_t indexInSegment;
+	unsigned const segmentIndex = HbMem_SegArray_Locate_i(array, index, &indexInSegment);
+	return array->segments_i[segmentIndex] + array->elementSize_r * indexInSegment;
+}
+// For iterating segment by segment - returns the published element and the number of the published elements after it in its segment including it.
+HbForceInline void * HbMem_SegArray_GetPublishedRun(HbMem_SegArray const * const array, size_t const index, size_t * const runCountOut) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(runCountOut != NULL);
+	size_t const publishedCount = array->publishedCount_r;
+	HbReport_Assert_Assume(index < publishedCount);
+	size_t indexInSegment;
+	unsigned const segmentIndex = HbMem_SegArray_Locate_i(array, index, &indexInSegment);
+	*runCountOut = HbMath_Min_Size(HbMem_SegArray_GetSegmentCapacity_i(array, segmentIndex) - indexInSegment, publishedCount - index);
+	return array->segments_i[segmentIndex] + array->elementSize_r * indexInSegment;
+}
+
+/***************************************************************************
+ * Struct-of-arrays
+ * Each field (column) of the records is in its own aligned array, so loops
+ * touching a few fields load only them. The columns have the same count
+ * and capacity, and the capacity is rounded up so SIMD loops can process
+ * whole vectors up to the padded count without a scalar remainder.
+ ***************************************************************************/
+
+#define HbMem_SoA_MaxColumns 16
+// Cache line alignment of the columns is enough for the widest vectors, and rows in different columns don't share cache lines.
+#define HbMem_SoA_DefaultAlignment HbPlatform_CacheLineSize
+// Elements in a 64-byte vector of 32-bit values.
+#define HbMem_SoA_CapacityGranularity 16
+
+typedef struct HbMem_SoA {
+	void * columns_r[HbMem_SoA_MaxColumns];
+	size_t columnElementSizes_r[HbMem_SoA_MaxColumns];
+	size_t columnCount_r;
+	size_t rowSize_r; // Sum of the column element sizes.
+	size_t count_r;
+	size_t capacity_r; // Multiple of HbMem_SoA_CapacityGranularity.
+	size_t alignment_r;
+	HbMem_Tag * tag_e;
+	char const * originNameImmutable_r;
+	unsigned originLocation_r;
+} HbMem_SoA;
+
+void HbMem_SoA_InitExplicit(HbMem_SoA * const soa, size_t const * const columnElementSizes, size_t const columnCount, size_t const alignment,
+                            HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation);
+// Use like size_t const columnElementSizes[] = { sizeof(float), sizeof(float), sizeof(uint32_t) }.
+#define HbMem_SoA_Init(soa, columnElementSizes, tag) \
+	HbMem_SoA_InitExplicit(soa, columnElementSizes, HbCountOf(columnElementSizes), HbMem_SoA_DefaultAlignment, tag, __func__, __LINE__)
+void HbMem_SoA_Shutdown(HbMem_SoA * const soa);
+
+void HbMem_SoA_ReserveExactly(HbMem_SoA * const soa, size_t const capacity, HbBool const trim);
+HbForceInline void HbMem_SoA_TrimCapacity(HbMem_SoA * const soa) {
+	HbReport_Assert_Assume(soa != NULL);
+	HbMem_SoA_ReserveExactly(soa, soa->count_r, HbTrue);
+}
+HbForceInline void HbMem_SoA_ReserveForGrowing(HbMem_SoA * const soa, size_t const count) {
+	HbReport_Assert_Assume(soa != NULL);
+	if (soa->capacity_r >= count) {
+		return;
+	}
+	HbMem_SoA_ReserveExactly(soa, HbMem_DynArray_GetCapacityForGrowingExplicit(soa->rowSize_r, soa->capacity_r, count), HbFalse);
+}
+
+// Returns the index of the first new row, which is not initialized.
+HbForceInline size_t HbMem_SoA_Append(HbMem_SoA * const soa, size_t const count) {
+	HbReport_Assert_Assume(soa != NULL);
+	if (soa->capacity_r - soa->count_r < count) {
+		HbMem_SoA_ReserveForGrowing(soa, soa->count_r + count);
+	}
+	return (soa->count_r += count) - count;
+}
+HbForceInline void HbMem_SoA_RemoveFromEnd(HbMem_SoA * const soa, size_t const count) {
+	HbReport_Assert_Assume(soa != NULL);
+	HbReport_Assert_Assume(count <= soa->count_r);
+	soa->count_r -= count;
+}
+// Moves the last row into the place of the removed one.
+void HbMem_SoA_RemoveFromUnsorted(HbMem_SoA * const soa, size_t const index);
+HbForceInline void HbMem_SoA_Clear(HbMem_SoA * const soa) {
+	HbReport_Assert_Assume(soa != NULL);
+	soa->count_r = 0;
+}
+
+// The count rounded up to HbMem_SoA_CapacityGranularity - elements up to it can be read (but have undefined values after the count) and written.
+HbForceInline size_t HbMem_SoA_GetPaddedCount(HbMem_SoA const * const soa) {
+	HbReport_Assert_Assume(soa != NULL);
+	return HbMath_Align_Size(soa->count_r, HbMem_SoA_CapacityGranularity);
+}
+HbForceInline void * HbMem_SoA_GetColumnExplicit(HbMem_SoA const * const soa, size_t const columnIndex) {
+	HbReport_Assert_Assume(soa != NULL && "Struct-of-arrays must not be NULL. Additionally, this is triggered when GetColumn is called with a mismatching type size.");
+	HbReport_Assert_Assume(columnIndex < soa->columnCount_r);
+	return soa->columns_r[columnIndex];
+}
+#ifdef HbReport_Build_Assert
+#define HbMem_SoA_GetColumn(soa, columnIndex, elementType) \
+	((elementType *) HbMem_SoA_GetColumnExplicit((soa) != NULL && (soa)->columnElementSizes_r[columnIndex] == sizeof(elementType) ? (soa) : NULL, columnIndex))
+#else
+#define HbMem_SoA_GetColumn(soa, columnIndex, elementType) ((elementType *) (soa)->columns_r[columnIndex])
+#endif
+// For iterating over the chosen columns together - the column pointers are written in the order of the indices.
+HbForceInline void HbMem_SoA_GetColumns(HbMem_SoA const * const soa, size_t const * const columnIndices, size_t const columnCount, void * * const columnsOut) {
+	HbReport_Assert_Assume(soa != NULL);
+	HbReport_Assert_Assume(columnIndices != NULL || columnCount == 0);
+	HbReport_Assert_Assume(columnsOut != NULL || columnCount == 0);
+	for (size_t index = 0; index < columnCount; ++index) {
+		columnsOut[index] = HbMem_SoA_GetColumnExplicit(soa, columnIndices[index]);
+	}
+}
+
+/**********************************************************************
+ * Slot map
+ * Values densely packed in a dynamic-length array for iteration, with
+ * stable handles to them that stay valid while the values are moved
+ * by removal of other values, and are detected as stale after the
+ * removal of their own value.
+ **********************************************************************/
+
+// Slot index in the low 32 bits, generation of the slot in the high 32 bits. 0 is never a valid handle.
+typedef uint64_t HbMem_SlotMap_Handle;
+#define HbMem_SlotMap_NullHandle ((HbMem_SlotMap_Handle) 0)
+#define HbMem_SlotMap_Handle_GetSlotIndex(handle) ((uint32_t) (handle))
+#define HbMem_SlotMap_Handle_GetGeneration(handle) ((uint32_t) ((handle) >> 32))
+#define HbMem_SlotMap_Handle_Make(slotIndex, generation) ((HbMem_SlotMap_Handle) (slotIndex) | ((HbMem_SlotMap_Handle) (generation) << 32))
+
+#define HbMem_SlotMap_MaxCount UINT32_MAX
+#define HbMem_SlotMap_NoFreeSlot_i UINT32_MAX
+
+typedef struct HbMem_SlotMap_Slot_i {
+	uint32_t denseIndexOrNextFree_i; // Index in the values if the slot is used, next slot in the free list otherwise.
+	uint32_t generation_i; // Incremented on removal, never 0.
+} HbMem_SlotMap_Slot_i;
+
+typedef struct HbMem_SlotMap {
+	HbMem_DynArray values_r;
+	HbMem_DynArray denseSlots_i; // uint32_t slot index of each value, for fixing up the slot of the value moved by removal.
+	HbMem_DynArray slots_i; // HbMem_SlotMap_Slot_i.
+	uint32_t freeSlotFirst_i;
+} HbMem_SlotMap;
+
+void HbMem_SlotMap_InitExplicit(HbMem_SlotMap * const map, size_t const elementSize, size_t const alignment,
+                                HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_SlotMap_Init(map, elementType, tag) HbMem_SlotMap_InitExplicit(map, sizeof(elementType), HbPlatform_AllocAlignment, tag, __func__, __LINE__)
+void HbMem_SlotMap_Shutdown(HbMem_SlotMap * const map);
+// Invalidates all handles.
+void HbMem_SlotMap_Clear(HbMem_SlotMap * const map);
+
+// Returns the new value, which is not initialized. Pointers to values are invalidated by insertion and removal, handles are not.
+void * HbMem_SlotMap_Insert(HbMem_SlotMap * const map, HbMem_SlotMap_Handle * const handleOut);
+// Returns whether the handle was valid. The last value is moved into the place of the removed one.
+HbBool HbMem_SlotMap_Remove(HbMem_SlotMap * const map, HbMem_SlotMap_Handle const handle);
+
+HbForceInline size_t HbMem_SlotMap_GetCount(HbMem_SlotMap const * const map) {
+	HbReport_Assert_Assume(map != NULL);
+	return map->values_r.count_r;
+}
+// The index of the value in the dense array, or SIZE_MAX if the handle is stale.
+HbForceInline size_t HbMem_SlotMap_GetDenseIndex(HbMem_SlotMap const * const map, HbMem_SlotMap_Handle const handle) {
+	HbReport_Assert_Assume(map != NULL);
+	uint32_t const slotIndex = HbMem_SlotMap_Handle_GetSlotIndex(handle);
+	if (slotIndex >= map->slots_i.count_r) {
+		return SIZE_MAX;
+	}
+	HbMem_SlotMap_Slot_i const * const slot = (HbMem_SlotMap_Slot_i const *) map->slots_i.data_r + slotIndex;
+	// Removal changes the generation, so free slots never match.
+	return slot->generation_i == HbMem_SlotMap_Handle_GetGeneration(handle) ? slot->denseIndexOrNextFree_i : SIZE_MAX;
+}
+// NULL if the handle is stale.
+HbForceInline void * HbMem_SlotMap_Get(HbMem_SlotMap const * const map, HbMem_SlotMap_Handle const handle) {
+	size_t const denseIndex = HbMem_SlotMap_GetDenseIndex(map, handle);
+	return denseIndex != SIZE_MAX ? (HbByte *) map->values_r.data_r + map->values_r.elementSize_r * denseIndex : NULL;
+}
+// For iteration over the values - map->values_r is the dense array.
+HbForceInline HbMem_SlotMap_Handle HbMem_SlotMap_GetHandleOfDenseIndex(HbMem_SlotMap const * const map, size_t const denseIndex) {
+	HbReport_Assert_Assume(map != NULL);
+	HbReport_Assert_Assume(denseIndex < map->values_r.count_r);
+	uint32_t const slotIndex = ((uint32_t const *) map->denseSlots_i.data_r)[denseIndex];
+	return HbMem_SlotMap_Handle_Make(slotIndex, ((HbMem_SlotMap_Slot_i const *) map->slots_i.data_r)[slotIndex].generation_i);
+}
+
+/****************************************************************************
+ * Paged array
+ * Elements in chunks of a power-of-two capacity, so indexing is a shift and
+ * a mask, the elements are never moved, and appending never copies them.
+ * Chunks are allocated from a tag, or from a Fibonacci allocator pool.
+ ****************************************************************************/
+
+#define HbMem_PagedArray_DefaultChunkSize 16384
+
+typedef struct HbMem_PagedArray {
+	HbMem_DynArray chunks_i; // void *, all full except for the ones after the count.
+	size_t elementSize_r;
+	size_t count_r;
+	size_t capacity_r; // Chunk count multiplied by the chunk capacity.
+	unsigned chunkCapacityLog2_r;
+	// If not NULL, chunks are allocated from the pool memory in units of the given size.
+	HbMem_FibAlloc * fibAlloc_e;
+	HbByte * poolMemory_e;
+	size_t poolUnitSize_r;
+} HbMem_PagedArray;
+
+// The chunk capacity is rounded up to a power of two, 0 for the default. Tag-allocated chunks are aligned to HbPlatform_AllocAlignment.
+void HbMem_PagedArray_InitExplicit(HbMem_PagedArray * const array, size_t const elementSize, size_t const chunkCapacity,
+                                   HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_PagedArray_Init(array, elementType, tag) HbMem_PagedArray_InitExplicit(array, sizeof(elementType), 0, tag, __func__, __LINE__)
+// Chunks are the allocations from the Fibonacci allocator, at poolMemory + allocation * poolUnitSize, which must be suitably aligned.
+// The tag is used for the list of the chunks.
+void HbMem_PagedArray_InitInPoolExplicit(HbMem_PagedArray * const array, size_t const elementSize, size_t const chunkCapacity,
+                                         HbMem_FibAlloc * const fibAlloc, void * const poolMemory, size_t const poolUnitSize,
+                                         HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation);
+#define HbMem_PagedArray_InitInPool(array, elementType, fibAlloc, poolMemory, poolUnitSize, tag) \
+	HbMem_PagedArray_InitInPoolExplicit(array, sizeof(elementType), 0, fibAlloc, poolMemory, poolUnitSize, tag, __func__, __LINE__)
+void HbMem_PagedArray_Shutdown(HbMem_PagedArray * const array);
+
+// Allocates the chunks up to the capacity.
+void HbMem_PagedArray_Reserve(HbMem_PagedArray * const array, size_t const capacity);
+// Frees the chunks after the one containing the last element.
+void HbMem_PagedArray_TrimCapacity(HbMem_PagedArray * const array);
+
+// Returns the index of the first new element, which is not initialized.
+HbForceInline size_t HbMem_PagedArray_Append(HbMem_PagedArray * const array, size_t const count) {
+	HbReport_Assert_Assume(array != NULL);
+	if (array->capacity_r - array->count_r < count) {
+		HbMem_PagedArray_Reserve(array, array->count_r + count);
+	}
+	return (array->count_r += count) - count;
+}
+HbForceInline void HbMem_PagedArray_RemoveFromEnd(HbMem_PagedArray * const array, size_t const count) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(count <= array->count_r);
+	array->count_r -= count;
+}
+HbForceInline void HbMem_PagedArray_Clear(HbMem_PagedArray * const array) {
+	HbReport_Assert_Assume(array != NULL);
+	array->count_r = 0;
+}
+
+HbForceInline void * HbMem_PagedArray_GetExplicit(HbMem_PagedArray const * const array, size_t const index) {
+	HbReport_Assert_Assume(array != NULL && "Paged array must not be NULL. Additionally, this is triggered when Get is called with a mismatching type size.");
+	HbReport_Assert_Assume(index < array->count_r);
+	return ((HbByte * const *) array->chunks_i.data_r)[index >> array->chunkCapacityLog2_r] +
+	       array->elementSize_r * (index & (((size_t) 1 << array->chunkCapacityLog2_r) - 1));
+}
+#ifdef HbReport_Build_Assert
+#define HbMem_PagedArray_Get(array, index, elementType) \
+	((elementType *) HbMem_PagedArray_GetExplicit((array) != NULL && (array)->elementSize_r == sizeof(elementType) ? (array) : NULL, index))
+#else
+#define HbMem_PagedArray_Get(array, index, elementType) \
+	((elementType *) ((HbByte * const *) (array)->chunks_i.data_r)[(index) >> (array)->chunkCapacityLog2_r] + \
+	 ((index) & (((size_t) 1 << (array)->chunkCapacityLog2_r) - 1)))
+#endif
+
+// For iterating chunk by chunk - returns the chunk and the number of the elements in it.
+HbForceInline size_t HbMem_PagedArray_GetUsedChunkCount(HbMem_PagedArray const * const array) {
+	HbReport_Assert_Assume(array != NULL);
+	return (array->count_r + (((size_t) 1 << array->chunkCapacityLog2_r) - 1)) >> array->chunkCapacityLog2_r;
+}
+HbForceInline void * HbMem_PagedArray_GetChunk(HbMem_PagedArray const * const array, size_t const chunkIndex, size_t * const countOut) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(countOut != NULL);
+	size_t const chunkStart = chunkIndex << array->chunkCapacityLog2_r;
+	HbReport_Assert_Assume(chunkStart < array->count_r);
+	*countOut = HbMath_Min_Size(array->count_r - chunkStart, (size_t) 1 << array->chunkCapacityLog2_r);
+	return ((void * const *) array->chunks_i.data_r)[chunkIndex];
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,301 @@
+#ifndef HbInclude_HbMem_Hpp
+#define HbInclude_HbMem_Hpp
+#include "HbMem.h"
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace HbMem {
+
+/****************************************************************************
+ * Typed dynamic-length array
+ * Over the same tagged storage as HbMem_DynArray, but with the element size
+ * known at compile time, and constructing, moving and destroying elements.
+ * Element constructors and destructors are assumed not to throw.
+ ****************************************************************************/
+
+template<typename T>
+class DynArray {
+public:
+	// Use like DynArray<Element> elements(tag, __func__, __LINE__) to track the origin.
+	DynArray(HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+		HbMem_DynArray_InitExplicit(&array_i, sizeof(T), alignof(T) > HbPlatform_AllocAlignment ? alignof(T) : HbPlatform_AllocAlignment,
+		                            tag, originNameImmutable, originLocation);
+	}
+	// Stable addresses, see HbMem_DynArray_InitReservedExplicit.
+	DynArray(HbMem_Tag * const tag, size_t const reservedCapacity, char const * const originNameImmutable, unsigned const originLocation) {
+		static_assert(alignof(T) <= HbPlatform_AllocAlignment, "Reserved arrays are only aligned to HbPlatform_AllocAlignment.");
+		HbMem_DynArray_InitReservedExplicit(&array_i, sizeof(T), reservedCapacity, tag, originNameImmutable, originLocation);
+	}
+	~DynArray() {
+		DestroyElements_i(0, array_i.count_r);
+		HbMem_DynArray_Shutdown(&array_i);
+	}
+	DynArray(DynArray const &) = delete;
+	DynArray & operator=(DynArray const &) = delete;
+	// The source is left empty, with the same tag and origin.
+	DynArray(DynArray && source) : array_i(source.array_i) {
+		source.ResetStorage_i();
+	}
+	DynArray & operator=(DynArray && source) {
+		if (this != &source) {
+			DestroyElements_i(0, array_i.count_r);
+			HbMem_DynArray_Shutdown(&array_i);
+			array_i = source.array_i;
+			source.ResetStorage_i();
+		}
+		return *this;
+	}
+
+	HbForceInline size_t GetCount() const { return array_i.count_r; }
+	HbForceInline size_t GetCapacity() const { return array_i.capacity_r; }
+	HbForceInline bool IsEmpty() const { return array_i.count_r == 0; }
+	HbForceInline T * GetData() { return static_cast<T *>(array_i.data_r); }
+	HbForceInline T const * GetData() const { return static_cast<T const *>(array_i.data_r); }
+	HbForceInline T & operator[](size_t const index) {
+		HbReport_Assert_Assume(index < array_i.count_r);
+		return GetData()[index];
+	}
+	HbForceInline T const & operator[](size_t const index) const {
+		HbReport_Assert_Assume(index < array_i.count_r);
+		return GetData()[index];
+	}
+	// Plain pointers, so range-based for loops are the same as loops over a raw buffer.
+	HbForceInline T * begin() { return GetData(); }
+	HbForceInline T * end() { return GetData() + array_i.count_r; }
+	HbForceInline T const * begin() const { return GetData(); }
+	HbForceInline T const * end() const { return GetData() + array_i.count_r; }
+
+	void ReserveExactly(size_t const capacity, bool const trim) {
+		size_t const neededCapacity = capacity > array_i.count_r ? capacity : array_i.count_r;
+		if (neededCapacity == array_i.capacity_r || (!trim && neededCapacity < array_i.capacity_r)) {
+			return;
+		}
+		// Trivially copyable elements can be moved by reallocation, and reserved arrays are never moved.
+		if (std::is_trivially_copyable<T>::value || array_i.reservedCapacity_r != 0 || array_i.count_r == 0) {
+			HbMem_DynArray_ReserveExactly(&array_i, neededCapacity, trim ? HbTrue : HbFalse);
+			return;
+		}
+		T * const newData = static_cast<T *>(HbMem_Tag_AllocAlignedElementsExplicit(
+			array_i.tag_e, sizeof(T), neededCapacity, array_i.alignment_r, HbTrue, array_i.originNameImmutable_r, array_i.originLocation_r));
+		T * const oldData = GetData();
+		for (size_t index = 0; index < array_i.count_r; ++index) {
+			new (newData + index) T(std::move(oldData[index]));
+			oldData[index].~T();
+		}
+		HbMem_Tag_Free(oldData);
+		array_i.data_r = newData;
+		array_i.capacity_r = neededCapacity;
+	}
+	HbForceInline void ReserveForGrowing(size_t const count) {
+		if (array_i.capacity_r < count) {
+			ReserveExactly(HbMem_DynArray_GetCapacityForGrowing(&array_i, count), false);
+		}
+	}
+	HbForceInline void TrimCapacity() { ReserveExactly(array_i.count_r, true); }
+
+	// New elements are value-initialized (zeroed for trivial types).
+	void ResizeExactly(size_t const count, bool const trim) {
+		if (count < array_i.count_r) {
+			RemoveFromEnd(array_i.count_r - count);
+		}
+		ReserveExactly(count, trim);
+		ConstructElements_i(count);
+	}
+	void ResizeForGrowing(size_t const count) {
+		if (count < array_i.count_r) {
+			RemoveFromEnd(array_i.count_r - count);
+			return;
+		}
+		ReserveForGrowing(count);
+		ConstructElements_i(count);
+	}
+
+	template<typename... Arguments>
+	HbForceInline T & Emplace(Arguments && ... arguments) {
+		if (array_i.count_r == array_i.capacity_r) {
+			return EmplaceGrowing_i(std::forward<Arguments>(arguments)...);
+		}
+		T * const element = new (GetData() + array_i.count_r) T(std::forward<Arguments>(arguments)...);
+		++array_i.count_r;
+		return *element;
+	}
+	HbForceInline T & Append(T const & value) { return Emplace(value); }
+	HbForceInline T & Append(T && value) { return Emplace(std::move(value)); }
+
+	HbForceInline void RemoveFromEnd(size_t const count) {
+		HbReport_Assert_Assume(count <= array_i.count_r);
+		DestroyElements_i(array_i.count_r - count, array_i.count_r);
+		array_i.count_r -= count;
+	}
+	// Moves the last element into the place of the removed one.
+	void RemoveFromUnsorted(size_t const index) {
+		HbReport_Assert_Assume(index < array_i.count_r);
+		T * const data = GetData();
+		size_t const lastIndex = array_i.count_r - 1;
+		if (index != lastIndex) {
+			data[index] = std::move(data[lastIndex]);
+		}
+		RemoveFromEnd(1);
+	}
+	// Shifts the following elements, keeping the order.
+	void RemoveFromSorted(size_t const index) {
+		HbReport_Assert_Assume(index < array_i.count_r);
+		T * const data = GetData();
+		for (size_t moveIndex = index + 1; moveIndex < array_i.count_r; ++moveIndex) {
+			data[moveIndex - 1] = std::move(data[moveIndex]);
+		}
+		RemoveFromEnd(1);
+	}
+	HbForceInline void Clear() { RemoveFromEnd(array_i.count_r); }
+
+private:
+	HbMem_DynArray array_i;
+
+	HbForceInline void DestroyElements_i(size_t const start, size_t const end) {
+		if (!std::is_trivially_destructible<T>::value) {
+			T * const data = GetData();
+			for (size_t index = start; index < end; ++index) {
+				data[index].~T();
+			}
+		}
+	}
+	// Capacity must be enough for the count.
+	void ConstructElements_i(size_t const count) {
+		T * const data = GetData();
+		for (size_t index = array_i.count_r; index < count; ++index) {
+			new (data + index) T();
+		}
+		array_i.count_r = count;
+	}
+	void ResetStorage_i() {
+		array_i.data_r = NULL;
+		array_i.capacity_r = 0;
+		array_i.count_r = 0;
+	}
+	// The arguments may reference an element of this array, so the new element is constructed before the storage moves.
+	template<typename... Arguments>
+	T & EmplaceGrowing_i(Arguments && ... arguments) {
+		T value(std::forward<Arguments>(arguments)...);
+		ReserveForGrowing(array_i.count_r + 1);
+		T * const element = new (GetData() + array_i.count_r) T(std::move(value));
+		++array_i.count_r;
+		return *element;
+	}
+};
+
+/************************************************************************
+ * Typed struct-of-arrays
+ * HbMem_SoA with the columns listed as the template arguments, accessed
+ * by index - an enum naming the columns keeps the code readable.
+ * The column types must be trivially copyable.
+ ************************************************************************/
+
+template<typename... Columns>
+class SoA {
+public:
+	template<size_t ColumnIndex>
+	using Column = typename std::tuple_element<ColumnIndex, std::tuple<Columns...>>::type;
+
+	// Use like SoA<float, float, uint32_t> particles(tag, __func__, __LINE__) to track the origin.
+	SoA(HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+		static_assert(sizeof...(Columns) != 0 && sizeof...(Columns) <= HbMem_SoA_MaxColumns, "Unsupported column count.");
+		static_assert(AreColumnsTriviallyCopyable_i(), "Columns are copied with memcpy.");
+		size_t const columnElementSizes[] = { sizeof(Columns)... };
+		HbMem_SoA_InitExplicit(&soa_i, columnElementSizes, sizeof...(Columns), GetAlignment_i(), tag, originNameImmutable, originLocation);
+	}
+	~SoA() {
+		HbMem_SoA_Shutdown(&soa_i);
+	}
+	SoA(SoA const &) = delete;
+	SoA & operator=(SoA const &) = delete;
+	// The source is left empty, with the same tag and origin.
+	SoA(SoA && source) : soa_i(source.soa_i) {
+		source.ResetStorage_i();
+	}
+	SoA & operator=(SoA && source) {
+		if (this != &source) {
+			HbMem_SoA_Shutdown(&soa_i);
+			soa_i = source.soa_i;
+			source.ResetStorage_i();
+		}
+		return *this;
+	}
+
+	HbForceInline size_t GetCount() const { return soa_i.count_r; }
+	HbForceInline size_t GetCapacity() const { return soa_i.capacity_r; }
+	HbForceInline size_t GetPaddedCount() const { return HbMem_SoA_GetPaddedCount(&soa_i); }
+	HbForceInline bool IsEmpty() const { return soa_i.count_r == 0; }
+	template<size_t ColumnIndex>
+	HbForceInline Column<ColumnIndex> * GetColumn() { return static_cast<Column<ColumnIndex> *>(soa_i.columns_r[ColumnIndex]); }
+	template<size_t ColumnIndex>
+	HbForceInline Column<ColumnIndex> const * GetColumn() const { return static_cast<Column<ColumnIndex> const *>(soa_i.columns_r[ColumnIndex]); }
+
+	HbForceInline void ReserveExactly(size_t const capacity, bool const trim) { HbMem_SoA_ReserveExactly(&soa_i, capacity, trim ? HbTrue : HbFalse); }
+	HbForceInline void ReserveForGrowing(size_t const count) { HbMem_SoA_ReserveForGrowing(&soa_i, count); }
+	HbForceInline void TrimCapacity() { HbMem_SoA_TrimCapacity(&soa_i); }
+
+	// Taking the values by copy since they may be in this SoA, which may be reallocated.
+	HbForceInline size_t Append(Columns const ... values) {
+		size_t const index = HbMem_SoA_Append(&soa_i, 1);
+		SetRow_i(index, std::index_sequence_for<Columns...>(), values...);
+		return index;
+	}
+	// Returns the index of the first new row, which is not initialized.
+	HbForceInline size_t AppendUninitialized(size_t const count) { return HbMem_SoA_Append(&soa_i, count); }
+	HbForceInline void RemoveFromEnd(size_t const count) { HbMem_SoA_RemoveFromEnd(&soa_i, count); }
+	// Moves the last row into the place of the removed one.
+	HbForceInline void RemoveFromUnsorted(size_t const index) { HbMem_SoA_RemoveFromUnsorted(&soa_i, index); }
+	HbForceInline void Clear() { HbMem_SoA_Clear(&soa_i); }
+
+	// Calls the function with references to the elements of the chosen columns in each row, like ForEachRow<PositionX, VelocityX>(...).
+	// The column pointers are loaded once, so the loop is the same as over raw arrays and can be vectorized.
+	template<size_t... ColumnIndices, typename Function>
+	HbForceInline void ForEachRow(Function && function) {
+		ForEachRow_i(function, soa_i.count_r, GetColumn<ColumnIndices>()...);
+	}
+
+private:
+	HbMem_SoA soa_i;
+
+	static constexpr bool AreColumnsTriviallyCopyable_i() {
+		bool const columnsTriviallyCopyable[] = { std::is_trivially_copyable<Columns>::value... };
+		for (bool const columnTriviallyCopyable : columnsTriviallyCopyable) {
+			if (!columnTriviallyCopyable) {
+				return false;
+			}
+		}
+		return true;
+	}
+	static constexpr size_t GetAlignment_i() {
+		size_t const columnAlignments[] = { alignof(Columns)... };
+		size_t alignment = HbMem_SoA_DefaultAlignment;
+		for (size_t const columnAlignment : columnAlignments) {
+			alignment = columnAlignment > alignment ? columnAlignment : alignment;
+		}
+		return alignment;
+	}
+	template<size_t... ColumnIndices>
+	HbForceInline void SetRow_i(size_t const index, std::index_sequence<ColumnIndices...>, Columns const ... values) {
+		int const assigned[] = { (GetColumn<ColumnIndices>()[index] = values, 0)... };
+		(void) assigned;
+	}
+	template<typename Function, typename... Elements>
+	HbForceInline static void ForEachRow_i(Function & function, size_t const count, Elements * const ... columns) {
+		for (size_t index = 0; index < count; ++index) {
+			function(columns[index]...);
+		}
+	}
+	void ResetStorage_i() {
+		for (size_t columnIndex = 0; columnIndex < soa_i.columnCount_r; ++columnIndex) {
+			soa_i.columns_r[columnIndex] = NULL;
+		}
+		soa_i.capacity_r = 0;
+		soa_i.count_r = 0;
+	}
+};
+
+}
+
+#endif
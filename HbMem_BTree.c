@@ -0,0 +1,446 @@
+#include "HbMath.h"
+#include "HbMem.h"
+#include "HbReport.h"
+
+// Branch layout: size_t childCount, void * children[branchCapacity_i], keys[branchCapacity_i - 1] at branchKeysOffset_i.
+// The key before each child except for the first is not greater than any element of the child, and greater than any element of the previous children.
+// Keys are copies of the elements, and may stay after the elements are removed.
+
+// All nodes except for the root are at least half full, so merging two nodes with the minimum count doesn't overflow.
+#define HbMem_BTree_MinCapacity_i 4
+
+HbForceInline HbByte * HbMem_BTree_GetLeafElement_i(HbMem_BTree const * const tree, HbMem_BTree_Leaf_i * const leaf, size_t const index) {
+	return (HbByte *) leaf + HbMem_BTree_LeafHeaderSize_i + tree->elementSize_r * index;
+}
+
+HbForceInline size_t * HbMem_BTree_GetBranchChildCount_i(void * const branch) {
+	return (size_t *) branch;
+}
+
+HbForceInline void * * HbMem_BTree_GetBranchChildren_i(void * const branch) {
+	return (void * *) ((size_t *) branch + 1);
+}
+
+HbForceInline HbByte * HbMem_BTree_GetBranchKey_i(HbMem_BTree const * const tree, void * const branch, size_t const index) {
+	return (HbByte *) branch + tree->branchKeysOffset_i + tree->elementSize_r * index;
+}
+
+HbForceInline size_t HbMem_BTree_GetNodeCount_i(void * const node, size_t const height) {
+	return height > 1 ? *HbMem_BTree_GetBranchChildCount_i(node) : ((HbMem_BTree_Leaf_i *) node)->count_i;
+}
+
+void HbMem_BTree_InitExplicit(HbMem_BTree * const tree, size_t const elementSize, HbMem_DynArray_CompareCallback const compare, void * const compareUserData,
+                              HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(tree != NULL);
+	HbReport_Assert_Assume(elementSize != 0);
+	HbReport_Assert_Assume(compare != NULL);
+	tree->elementSize_r = elementSize;
+	tree->count_r = 0;
+	tree->compare_r = compare;
+	tree->compareUserData_r = compareUserData;
+	// Larger nodes than HbMem_BTree_NodeSize for large elements so the tree doesn't degrade to a binary one.
+	tree->leafCapacity_i = HbMath_Max_Size((HbMem_BTree_NodeSize - HbMem_BTree_LeafHeaderSize_i) / elementSize, HbMem_BTree_MinCapacity_i);
+	size_t branchCapacity = (HbMem_BTree_NodeSize - sizeof(size_t) + elementSize) / (sizeof(void *) + elementSize);
+	while (branchCapacity > HbMem_BTree_MinCapacity_i &&
+	       HbMath_Align_Size(sizeof(size_t) + sizeof(void *) * branchCapacity, HbPlatform_AllocAlignment) + elementSize * (branchCapacity - 1) > HbMem_BTree_NodeSize) {
+		--branchCapacity;
+	}
+	tree->branchCapacity_i = HbMath_Max_Size(branchCapacity, HbMem_BTree_MinCapacity_i);
+	tree->branchKeysOffset_i = HbMath_Align_Size(sizeof(size_t) + sizeof(void *) * tree->branchCapacity_i, HbPlatform_AllocAlignment);
+	tree->height_i = 0;
+	tree->root_i = NULL;
+	tree->leafFirst_i = tree->leafLast_i = NULL;
+	tree->tag_e = tag;
+	tree->originNameImmutable_r = originNameImmutable;
+	tree->originLocation_r = originLocation;
+}
+
+static void HbMem_BTree_FreeNode_i(void * const node, size_t const height) {
+	if (height > 1) {
+		size_t const childCount = *HbMem_BTree_GetBranchChildCount_i(node);
+		void * const * const children = HbMem_BTree_GetBranchChildren_i(node);
+		for (size_t childIndex = 0; childIndex < childCount; ++childIndex) {
+			HbMem_BTree_FreeNode_i(children[childIndex], height - 1);
+		}
+	}
+	HbMem_Tag_Free(node);
+}
+
+void HbMem_BTree_Clear(HbMem_BTree * const tree) {
+	HbReport_Assert_Assume(tree != NULL);
+	if (tree->root_i != NULL) {
+		HbMem_BTree_FreeNode_i(tree->root_i, tree->height_i);
+	}
+	tree->count_r = 0;
+	tree->height_i = 0;
+	tree->root_i = NULL;
+	tree->leafFirst_i = tree->leafLast_i = NULL;
+}
+
+void HbMem_BTree_Shutdown(HbMem_BTree * const tree) {
+	HbMem_BTree_Clear(tree);
+}
+
+static HbMem_BTree_Leaf_i * HbMem_BTree_AllocLeaf_i(HbMem_BTree * const tree) {
+	HbMem_BTree_Leaf_i * const leaf = (HbMem_BTree_Leaf_i *) HbMem_Tag_AllocExplicit(tree->tag_e,
+		HbMem_BTree_LeafHeaderSize_i + tree->elementSize_r * tree->leafCapacity_i, HbTrue, tree->originNameImmutable_r, tree->originLocation_r);
+	leaf->prev_i = leaf->next_i = NULL;
+	leaf->count_i = 0;
+	return leaf;
+}
+
+static void * HbMem_BTree_AllocBranch_i(HbMem_BTree * const tree) {
+	void * const branch = HbMem_Tag_AllocExplicit(tree->tag_e, tree->branchKeysOffset_i + tree->elementSize_r * (tree->branchCapacity_i - 1), HbTrue,
+	                                              tree->originNameImmutable_r, tree->originLocation_r);
+	*HbMem_BTree_GetBranchChildCount_i(branch) = 0;
+	return branch;
+}
+
+// The index of the child that may contain the key.
+static size_t HbMem_BTree_FindChild_i(HbMem_BTree const * const tree, void * const branch, void const * const key) {
+	size_t start = 0, end = *HbMem_BTree_GetBranchChildCount_i(branch) - 1;
+	while (start < end) {
+		size_t const middle = start + (end - start) / 2;
+		if (tree->compare_r(HbMem_BTree_GetBranchKey_i(tree, branch, middle), key, tree->compareUserData_r) > 0) {
+			end = middle;
+		} else {
+			start = middle + 1;
+		}
+	}
+	return start;
+}
+
+static size_t HbMem_BTree_FindInLeaf_i(HbMem_BTree const * const tree, HbMem_BTree_Leaf_i * const leaf, void const * const key) {
+	size_t start = 0, end = leaf->count_i;
+	while (start < end) {
+		size_t const middle = start + (end - start) / 2;
+		if (tree->compare_r(HbMem_BTree_GetLeafElement_i(tree, leaf, middle), key, tree->compareUserData_r) >= 0) {
+			end = middle;
+		} else {
+			start = middle + 1;
+		}
+	}
+	return start;
+}
+
+// Inserts the key and the child after it into the branch, which must not be full.
+static void HbMem_BTree_InsertIntoBranch_i(HbMem_BTree const * const tree, void * const branch, size_t const keyIndex, void const * const key, void * const child) {
+	size_t * const childCount = HbMem_BTree_GetBranchChildCount_i(branch);
+	void * * const children = HbMem_BTree_GetBranchChildren_i(branch);
+	HbReport_Assert_Assume(*childCount < tree->branchCapacity_i);
+	memmove(children + keyIndex + 2, children + keyIndex + 1, sizeof(void *) * (*childCount - (keyIndex + 1)));
+	children[keyIndex + 1] = child;
+	memmove(HbMem_BTree_GetBranchKey_i(tree, branch, keyIndex + 1), HbMem_BTree_GetBranchKey_i(tree, branch, keyIndex),
+	        tree->elementSize_r * (*childCount - 1 - keyIndex));
+	memcpy(HbMem_BTree_GetBranchKey_i(tree, branch, keyIndex), key, tree->elementSize_r);
+	++(*childCount);
+}
+
+// Splits the full child in half, inserting the right half into the branch, which must not be full.
+static void HbMem_BTree_SplitChild_i(HbMem_BTree * const tree, void * const branch, size_t const childIndex, size_t const childHeight) {
+	void * const child = HbMem_BTree_GetBranchChildren_i(branch)[childIndex];
+	size_t const elementSize = tree->elementSize_r;
+	if (childHeight > 1) {
+		size_t * const childCount = HbMem_BTree_GetBranchChildCount_i(child);
+		size_t const leftCount = *childCount / 2, rightCount = *childCount - leftCount;
+		void * const right = HbMem_BTree_AllocBranch_i(tree);
+		memcpy(HbMem_BTree_GetBranchChildren_i(right), HbMem_BTree_GetBranchChildren_i(child) + leftCount, sizeof(void *) * rightCount);
+		memcpy(HbMem_BTree_GetBranchKey_i(tree, right, 0), HbMem_BTree_GetBranchKey_i(tree, child, leftCount), elementSize * (rightCount - 1));
+		*HbMem_BTree_GetBranchChildCount_i(right) = rightCount;
+		*childCount = leftCount;
+		// The key between the halves is moved up, it stays in the left half's memory until then.
+		HbMem_BTree_InsertIntoBranch_i(tree, branch, childIndex, HbMem_BTree_GetBranchKey_i(tree, child, leftCount - 1), right);
+	} else {
+		HbMem_BTree_Leaf_i * const left = (HbMem_BTree_Leaf_i *) child;
+		size_t const leftCount = left->count_i / 2, rightCount = left->count_i - leftCount;
+		HbMem_BTree_Leaf_i * const right = HbMem_BTree_AllocLeaf_i(tree);
+		memcpy(HbMem_BTree_GetLeafElement_i(tree, right, 0), HbMem_BTree_GetLeafElement_i(tree, left, leftCount), elementSize * rightCount);
+		right->count_i = rightCount;
+		left->count_i = leftCount;
+		right->prev_i = left;
+		right->next_i = left->next_i;
+		if (left->next_i != NULL) {
+			left->next_i->prev_i = right;
+		} else {
+			tree->leafLast_i = right;
+		}
+		left->next_i = right;
+		HbMem_BTree_InsertIntoBranch_i(tree, branch, childIndex, HbMem_BTree_GetLeafElement_i(tree, right, 0), right);
+	}
+}
+
+void * HbMem_BTree_Insert(HbMem_BTree * const tree, void const * const element, HbBool * const insertedOut) {
+	HbReport_Assert_Assume(tree != NULL);
+	HbReport_Assert_Assume(element != NULL);
+	if (tree->root_i == NULL) {
+		tree->root_i = tree->leafFirst_i = tree->leafLast_i = HbMem_BTree_AllocLeaf_i(tree);
+		tree->height_i = 1;
+	}
+	// Splitting full nodes on the way down so there's always space for the split of a child.
+	size_t const rootCapacity = tree->height_i > 1 ? tree->branchCapacity_i : tree->leafCapacity_i;
+	if (HbMem_BTree_GetNodeCount_i(tree->root_i, tree->height_i) == rootCapacity) {
+		void * const newRoot = HbMem_BTree_AllocBranch_i(tree);
+		*HbMem_BTree_GetBranchChildCount_i(newRoot) = 1;
+		HbMem_BTree_GetBranchChildren_i(newRoot)[0] = tree->root_i;
+		HbMem_BTree_SplitChild_i(tree, newRoot, 0, tree->height_i);
+		tree->root_i = newRoot;
+		++tree->height_i;
+	}
+	void * node = tree->root_i;
+	for (size_t height = tree->height_i; height > 1; --height) {
+		size_t childIndex = HbMem_BTree_FindChild_i(tree, node, element);
+		void * const child = HbMem_BTree_GetBranchChildren_i(node)[childIndex];
+		size_t const childCapacity = height > 2 ? tree->branchCapacity_i : tree->leafCapacity_i;
+		if (HbMem_BTree_GetNodeCount_i(child, height - 1) == childCapacity) {
+			HbMem_BTree_SplitChild_i(tree, node, childIndex, height - 1);
+			if (tree->compare_r(HbMem_BTree_GetBranchKey_i(tree, node, childIndex), element, tree->compareUserData_r) <= 0) {
+				++childIndex;
+			}
+		}
+		node = HbMem_BTree_GetBranchChildren_i(node)[childIndex];
+	}
+	HbMem_BTree_Leaf_i * const leaf = (HbMem_BTree_Leaf_i *) node;
+	size_t const index = HbMem_BTree_FindInLeaf_i(tree, leaf, element);
+	HbByte * const leafElement = HbMem_BTree_GetLeafElement_i(tree, leaf, index);
+	if (index < leaf->count_i && tree->compare_r(leafElement, element, tree->compareUserData_r) == 0) {
+		if (insertedOut != NULL) {
+			*insertedOut = HbFalse;
+		}
+		return leafElement;
+	}
+	memmove(leafElement + tree->elementSize_r, leafElement, tree->elementSize_r * (leaf->count_i - index));
+	memcpy(leafElement, element, tree->elementSize_r);
+	++leaf->count_i;
+	++tree->count_r;
+	if (insertedOut != NULL) {
+		*insertedOut = HbTrue;
+	}
+	return leafElement;
+}
+
+// Makes the child have more than the minimum count by borrowing from or merging with a sibling. Returns the new index of the child.
+static size_t HbMem_BTree_FillChild_i(HbMem_BTree * const tree, void * const branch, size_t const childIndex, size_t const childHeight) {
+	size_t const elementSize = tree->elementSize_r;
+	size_t * const branchChildCount = HbMem_BTree_GetBranchChildCount_i(branch);
+	void * * const branchChildren = HbMem_BTree_GetBranchChildren_i(branch);
+	size_t const minCount = (childHeight > 1 ? tree->branchCapacity_i : tree->leafCapacity_i) / 2;
+	void * const child = branchChildren[childIndex];
+	void * const left = childIndex != 0 ? branchChildren[childIndex - 1] : NULL;
+	void * const right = childIndex + 1 < *branchChildCount ? branchChildren[childIndex + 1] : NULL;
+
+	if (left != NULL && HbMem_BTree_GetNodeCount_i(left, childHeight) > minCount) {
+		HbByte * const separator = HbMem_BTree_GetBranchKey_i(tree, branch, childIndex - 1);
+		if (childHeight > 1) {
+			size_t * const childCount = HbMem_BTree_GetBranchChildCount_i(child);
+			size_t * const leftCount = HbMem_BTree_GetBranchChildCount_i(left);
+			void * * const childChildren = HbMem_BTree_GetBranchChildren_i(child);
+			memmove(childChildren + 1, childChildren, sizeof(void *) * *childCount);
+			childChildren[0] = HbMem_BTree_GetBranchChildren_i(left)[*leftCount - 1];
+			memmove(HbMem_BTree_GetBranchKey_i(tree, child, 1), HbMem_BTree_GetBranchKey_i(tree, child, 0), elementSize * (*childCount - 1));
+			memcpy(HbMem_BTree_GetBranchKey_i(tree, child, 0), separator, elementSize);
+			memcpy(separator, HbMem_BTree_GetBranchKey_i(tree, left, *leftCount - 2), elementSize);
+			++(*childCount);
+			--(*leftCount);
+		} else {
+			HbMem_BTree_Leaf_i * const childLeaf = (HbMem_BTree_Leaf_i *) child;
+			HbMem_BTree_Leaf_i * const leftLeaf = (HbMem_BTree_Leaf_i *) left;
+			memmove(HbMem_BTree_GetLeafElement_i(tree, childLeaf, 1), HbMem_BTree_GetLeafElement_i(tree, childLeaf, 0), elementSize * childLeaf->count_i);
+			memcpy(HbMem_BTree_GetLeafElement_i(tree, childLeaf, 0), HbMem_BTree_GetLeafElement_i(tree, leftLeaf, leftLeaf->count_i - 1), elementSize);
+			memcpy(separator, HbMem_BTree_GetLeafElement_i(tree, childLeaf, 0), elementSize);
+			++childLeaf->count_i;
+			--leftLeaf->count_i;
+		}
+		return childIndex;
+	}
+
+	if (right != NULL && HbMem_BTree_GetNodeCount_i(right, childHeight) > minCount) {
+		HbByte * const separator = HbMem_BTree_GetBranchKey_i(tree, branch, childIndex);
+		if (childHeight > 1) {
+			size_t * const childCount = HbMem_BTree_GetBranchChildCount_i(child);
+			size_t * const rightCount = HbMem_BTree_GetBranchChildCount_i(right);
+			void * * const rightChildren = HbMem_BTree_GetBranchChildren_i(right);
+			HbMem_BTree_GetBranchChildren_i(child)[*childCount] = rightChildren[0];
+			memcpy(HbMem_BTree_GetBranchKey_i(tree, child, *childCount - 1), separator, elementSize);
+			memcpy(separator, HbMem_BTree_GetBranchKey_i(tree, right, 0), elementSize);
+			memmove(rightChildren, rightChildren + 1, sizeof(void *) * (*rightCount - 1));
+			memmove(HbMem_BTree_GetBranchKey_i(tree, right, 0), HbMem_BTree_GetBranchKey_i(tree, right, 1), elementSize * (*rightCount - 2));
+			++(*childCount);
+			--(*rightCount);
+		} else {
+			HbMem_BTree_Leaf_i * const childLeaf = (HbMem_BTree_Leaf_i *) child;
+			HbMem_BTree_Leaf_i * const rightLeaf = (HbMem_BTree_Leaf_i *) right;
+			memcpy(HbMem_BTree_GetLeafElement_i(tree, childLeaf, childLeaf->count_i), HbMem_BTree_GetLeafElement_i(tree, rightLeaf, 0), elementSize);
+			memmove(HbMem_BTree_GetLeafElement_i(tree, rightLeaf, 0), HbMem_BTree_GetLeafElement_i(tree, rightLeaf, 1), elementSize * (rightLeaf->count_i - 1));
+			memcpy(separator, HbMem_BTree_GetLeafElement_i(tree, rightLeaf, 0), elementSize);
+			++childLeaf->count_i;
+			--rightLeaf->count_i;
+		}
+		return childIndex;
+	}
+
+	// Both siblings have the minimum count, merging with one of them.
+	HbReport_Assert_Assume(left != NULL || right != NULL);
+	size_t const mergedIndex = right != NULL ? childIndex : childIndex - 1;
+	void * const mergedLeft = branchChildren[mergedIndex];
+	void * const mergedRight = branchChildren[mergedIndex + 1];
+	if (childHeight > 1) {
+		size_t * const mergedLeftCount = HbMem_BTree_GetBranchChildCount_i(mergedLeft);
+		size_t const mergedRightCount = *HbMem_BTree_GetBranchChildCount_i(mergedRight);
+		memcpy(HbMem_BTree_GetBranchChildren_i(mergedLeft) + *mergedLeftCount, HbMem_BTree_GetBranchChildren_i(mergedRight), sizeof(void *) * mergedRightCount);
+		memcpy(HbMem_BTree_GetBranchKey_i(tree, mergedLeft, *mergedLeftCount - 1), HbMem_BTree_GetBranchKey_i(tree, branch, mergedIndex), elementSize);
+		memcpy(HbMem_BTree_GetBranchKey_i(tree, mergedLeft, *mergedLeftCount), HbMem_BTree_GetBranchKey_i(tree, mergedRight, 0), elementSize * (mergedRightCount - 1));
+		*mergedLeftCount += mergedRightCount;
+	} else {
+		HbMem_BTree_Leaf_i * const mergedLeftLeaf = (HbMem_BTree_Leaf_i *) mergedLeft;
+		HbMem_BTree_Leaf_i * const mergedRightLeaf = (HbMem_BTree_Leaf_i *) mergedRight;
+		memcpy(HbMem_BTree_GetLeafElement_i(tree, mergedLeftLeaf, mergedLeftLeaf->count_i), HbMem_BTree_GetLeafElement_i(tree, mergedRightLeaf, 0),
+		       elementSize * mergedRightLeaf->count_i);
+		mergedLeftLeaf->count_i += mergedRightLeaf->count_i;
+		mergedLeftLeaf->next_i = mergedRightLeaf->next_i;
+		if (mergedRightLeaf->next_i != NULL) {
+			mergedRightLeaf->next_i->prev_i = mergedLeftLeaf;
+		} else {
+			tree->leafLast_i = mergedLeftLeaf;
+		}
+	}
+	HbMem_Tag_Free(mergedRight);
+	memmove(branchChildren + mergedIndex + 1, branchChildren + mergedIndex + 2, sizeof(void *) * (*branchChildCount - (mergedIndex + 2)));
+	memmove(HbMem_BTree_GetBranchKey_i(tree, branch, mergedIndex), HbMem_BTree_GetBranchKey_i(tree, branch, mergedIndex + 1),
+	        elementSize * (*branchChildCount - (mergedIndex + 2)));
+	--(*branchChildCount);
+	return mergedIndex;
+}
+
+HbBool HbMem_BTree_Remove(HbMem_BTree * const tree, void const * const key) {
+	HbReport_Assert_Assume(tree != NULL);
+	HbReport_Assert_Assume(key != NULL);
+	if (tree->root_i == NULL) {
+		return HbFalse;
+	}
+	// Filling the nodes on the way down so removal from a child never makes it underfull.
+	void * node = tree->root_i;
+	for (size_t height = tree->height_i; height > 1; --height) {
+		size_t childIndex = HbMem_BTree_FindChild_i(tree, node, key);
+		size_t const childMinCount = (height > 2 ? tree->branchCapacity_i : tree->leafCapacity_i) / 2;
+		if (HbMem_BTree_GetNodeCount_i(HbMem_BTree_GetBranchChildren_i(node)[childIndex], height - 1) <= childMinCount) {
+			childIndex = HbMem_BTree_FillChild_i(tree, node, childIndex, height - 1);
+		}
+		node = HbMem_BTree_GetBranchChildren_i(node)[childIndex];
+	}
+	// Merging may have left the root with one child.
+	while (tree->height_i > 1 && *HbMem_BTree_GetBranchChildCount_i(tree->root_i) == 1) {
+		void * const oldRoot = tree->root_i;
+		tree->root_i = HbMem_BTree_GetBranchChildren_i(oldRoot)[0];
+		--tree->height_i;
+		HbMem_Tag_Free(oldRoot);
+	}
+
+	HbMem_BTree_Leaf_i * const leaf = (HbMem_BTree_Leaf_i *) node;
+	size_t const index = HbMem_BTree_FindInLeaf_i(tree, leaf, key);
+	if (index >= leaf->count_i || tree->compare_r(HbMem_BTree_GetLeafElement_i(tree, leaf, index), key, tree->compareUserData_r) != 0) {
+		return HbFalse;
+	}
+	memmove(HbMem_BTree_GetLeafElement_i(tree, leaf, index), HbMem_BTree_GetLeafElement_i(tree, leaf, index + 1),
+	        tree->elementSize_r * (leaf->count_i - (index + 1)));
+	--leaf->count_i;
+	if (--tree->count_r == 0) {
+		HbMem_BTree_Clear(tree);
+	}
+	return HbTrue;
+}
+
+void HbMem_BTree_BuildFromSorted(HbMem_BTree * const tree, void const * const elements, size_t const count) {
+	HbReport_Assert_Assume(tree != NULL);
+	HbReport_Assert_Assume(tree->root_i == NULL);
+	HbReport_Assert_Assume(elements != NULL || count == 0);
+	if (count == 0) {
+		return;
+	}
+	size_t const elementSize = tree->elementSize_r;
+
+	// Leaves, distributing the elements evenly so the last one isn't underfull.
+	size_t nodeCount = (count + (tree->leafCapacity_i - 1)) / tree->leafCapacity_i;
+	HbMem_DynArray level;
+	HbMem_DynArray_InitExplicit(&level, sizeof(void *), HbPlatform_AllocAlignment, tree->tag_e, tree->originNameImmutable_r, tree->originLocation_r);
+	HbMem_DynArray_ResizeExactly(&level, nodeCount, HbFalse);
+	HbByte const * elementCursor = (HbByte const *) elements;
+	HbMem_BTree_Leaf_i * leafPrev = NULL;
+	for (size_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex) {
+		HbMem_BTree_Leaf_i * const leaf = HbMem_BTree_AllocLeaf_i(tree);
+		leaf->count_i = count * (nodeIndex + 1) / nodeCount - count * nodeIndex / nodeCount;
+		memcpy(HbMem_BTree_GetLeafElement_i(tree, leaf, 0), elementCursor, elementSize * leaf->count_i);
+		elementCursor += elementSize * leaf->count_i;
+		leaf->prev_i = leafPrev;
+		if (leafPrev != NULL) {
+			leafPrev->next_i = leaf;
+		} else {
+			tree->leafFirst_i = leaf;
+		}
+		leafPrev = leaf;
+		*HbMem_DynArray_GetMut(&level, nodeIndex, void *) = leaf;
+	}
+	tree->leafLast_i = leafPrev;
+	tree->height_i = 1;
+
+	// Branches, replacing the nodes of the level below in place.
+	while (nodeCount > 1) {
+		size_t const childCount = nodeCount;
+		nodeCount = (childCount + (tree->branchCapacity_i - 1)) / tree->branchCapacity_i;
+		for (size_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex) {
+			size_t const childStart = childCount * nodeIndex / nodeCount, childEnd = childCount * (nodeIndex + 1) / nodeCount;
+			void * const branch = HbMem_BTree_AllocBranch_i(tree);
+			*HbMem_BTree_GetBranchChildCount_i(branch) = childEnd - childStart;
+			for (size_t childIndex = childStart; childIndex < childEnd; ++childIndex) {
+				void * const child = *HbMem_DynArray_Get(&level, childIndex, void *);
+				HbMem_BTree_GetBranchChildren_i(branch)[childIndex - childStart] = child;
+				if (childIndex == childStart) {
+					continue;
+				}
+				// The smallest element of the child.
+				void * leftmost = child;
+				for (size_t height = tree->height_i; height > 1; --height) {
+					leftmost = HbMem_BTree_GetBranchChildren_i(leftmost)[0];
+				}
+				memcpy(HbMem_BTree_GetBranchKey_i(tree, branch, childIndex - childStart - 1),
+				       HbMem_BTree_GetLeafElement_i(tree, (HbMem_BTree_Leaf_i *) leftmost, 0), elementSize);
+			}
+			*HbMem_DynArray_GetMut(&level, nodeIndex, void *) = branch;
+		}
+		++tree->height_i;
+	}
+	tree->root_i = *HbMem_DynArray_Get(&level, 0, void *);
+	tree->count_r = count;
+	HbMem_DynArray_Shutdown(&level);
+}
+
+HbMem_BTree_Cursor HbMem_BTree_FindFirstNotLess(HbMem_BTree const * const tree, void const * const key) {
+	HbReport_Assert_Assume(tree != NULL);
+	HbReport_Assert_Assume(key != NULL);
+	HbMem_BTree_Cursor cursor;
+	cursor.leaf_i = NULL;
+	cursor.index_i = 0;
+	if (tree->root_i == NULL) {
+		return cursor;
+	}
+	void * node = tree->root_i;
+	for (size_t height = tree->height_i; height > 1; --height) {
+		node = HbMem_BTree_GetBranchChildren_i(node)[HbMem_BTree_FindChild_i(tree, node, key)];
+	}
+	cursor.leaf_i = (HbMem_BTree_Leaf_i *) node;
+	cursor.index_i = HbMem_BTree_FindInLeaf_i(tree, cursor.leaf_i, key);
+	if (cursor.index_i >= cursor.leaf_i->count_i) {
+		// All elements of the leaf are less than the key, but the next leaf starts with a greater one.
+		cursor.leaf_i = cursor.leaf_i->next_i;
+		cursor.index_i = 0;
+	}
+	return cursor;
+}
+
+void * HbMem_BTree_Find(HbMem_BTree const * const tree, void const * const key) {
+	HbMem_BTree_Cursor const cursor = HbMem_BTree_FindFirstNotLess(tree, key);
+	if (!HbMem_BTree_Cursor_IsValid(cursor)) {
+		return NULL;
+	}
+	void * const element = HbMem_BTree_Cursor_Get(tree, cursor);
+	return tree->compare_r(element, key, tree->compareUserData_r) == 0 ? element : NULL;
+}
@@ -1,7 +1,7 @@
 #include "HbMath.h"
 #include "HbMem.h"
+#include "HbPara.h"
 #include "HbReport.h"
-#include "HbSort.h"
 
 HbStaticAssert(HbPlatform_CPU_Bits >= 32, "HbMem_FibAlloc_Sizes: Filled for 32-bit and 64-bit size_t.");
 size_t const HbMem_FibAlloc_Sizes[] = {
@@ -101,27 +101,67 @@ size_t const HbMem_FibAlloc_Sizes[] = {
 	#endif
 };
 
+HbStaticAssert(HbCountOf(HbMem_FibAlloc_Sizes) == HbMem_FibAlloc_LevelCount, "HbMem_FibAlloc_LevelCount must match HbMem_FibAlloc_Sizes.");
+
+// The first level not smaller than 1 << index (HbMem_FibAlloc_LevelCount if none).
+// The ratio of adjacent sizes is between 1.5 and 2, and the square of it is more than 2, so there are 1 or 2 levels in each power-of-two range.
+static uint8_t const HbMem_FibAlloc_FirstLevelsNotLessThanPowersOf2_i[HbPlatform_CPU_Bits] = {
+	0, 1, 3, 4, 6, 7, 9, 10, 12, 13, 15, 16, 17, 19, 20, 22, 23, 25, 26, 28, 29, 30, 32, 33, 35, 36, 38, 39, 41, 42, 43, 45,
+	#if HbPlatform_CPU_Bits >= 64
+	46, 48, 49, 51, 52, 53, 55, 56, 58, 59, 61, 62, 64, 65, 66, 68, 69, 71, 72, 74, 75, 77, 78, 79, 81, 82, 84, 85, 87, 88, 89, 91,
+	#endif
+};
+
+// Constant-time replacement of a binary search over HbMem_FibAlloc_Sizes. Returns HbMem_FibAlloc_LevelCount if all sizes are smaller.
+HbForceInline size_t HbMem_FibAlloc_FindFirstLevelNotLess_i(size_t const size) {
+	if (size <= 1) {
+		return 0;
+	}
+	size_t level = HbMem_FibAlloc_FirstLevelsNotLessThanPowersOf2_i[HbPlatform_CPU_Bits - 1 - HbMath_CountLeadingZeros_Size(size)];
+	// At most two levels to check within the power-of-two range of the size.
+	while (level < HbMem_FibAlloc_LevelCount && HbMem_FibAlloc_Sizes[level] < size) {
+		++level;
+	}
+	return level;
+}
+
 size_t HbMem_FibAlloc_ClosestLevelRoundingDown(size_t const size) {
-	size_t const greaterLevel = HbSort_Find_FirstGreater_Size(size, HbMem_FibAlloc_Sizes, HbCountOf(HbMem_FibAlloc_Sizes));
+	size_t const greaterLevel = size != SIZE_MAX ? HbMem_FibAlloc_FindFirstLevelNotLess_i(size + 1) : HbMem_FibAlloc_LevelCount;
 	return greaterLevel - (greaterLevel != 0);
 }
 
 size_t HbMem_FibAlloc_ClosestLevelRoundingUp(size_t const size) {
-	return HbMath_Min_Size(HbSort_Find_FirstNotLess_Size(size, HbMem_FibAlloc_Sizes, HbCountOf(HbMem_FibAlloc_Sizes)), HbCountOf(HbMem_FibAlloc_Sizes) - 1);
+	return HbMath_Min_Size(HbMem_FibAlloc_FindFirstLevelNotLess_i(size), HbMem_FibAlloc_LevelCount - 1);
 }
 
+// Type of the node indices and the offsets stored in the nodes and the allocation hash table.
+#ifdef HbMem_Build_CompactFibAlloc
+typedef uint32_t HbMem_FibAlloc_Word_i;
+#else
+typedef size_t HbMem_FibAlloc_Word_i;
+#endif
+#define HbMem_FibAlloc_WordBits_i (sizeof(HbMem_FibAlloc_Word_i) * CHAR_BIT)
+
+// Bits of the node level when packed with the parent node index, 0 if it's a separate byte.
+#if HbPlatform_CPU_Bits >= 64 && !defined(HbMem_Build_CompactFibAlloc)
+#define HbMem_FibAlloc_Node_LevelBits_i 7
+HbStaticAssert(HbMem_FibAlloc_LevelCount < (1 << HbMem_FibAlloc_Node_LevelBits_i), "HbMem_FibAlloc_Node_i::level_i must hold largestLevel_r + 1.");
+#else
+#define HbMem_FibAlloc_Node_LevelBits_i 0
+#endif
+
 #define HbMem_FibAlloc_Node_Child_ChildNodeIndex_Data_i 0
 typedef struct HbMem_FibAlloc_Node_Child_i {
-	size_t isFree_i : 1;
+	HbMem_FibAlloc_Word_i isFree_i : 1;
 	// For a split child, childOrNextFreeNodeIndex_i is the index of the node with its two children.
 	// For an allocation, this is set to HbMem_FibAlloc_Node_Child_ChildNodeIndex_Data_i.
 	// For a free node, it's the index of the next node with an equal free child (same level, same relation to the sibling) in the free looped linked list.
-	size_t childOrNextFreeNodeIndex_i : (sizeof(size_t) * CHAR_BIT - 1);
+	HbMem_FibAlloc_Word_i childOrNextFreeNodeIndex_i : (HbMem_FibAlloc_WordBits_i - 1);
 } HbMem_FibAlloc_Node_Child_i;
 
 typedef struct HbMem_FibAlloc_Node_i {
 	// Offset of the allocation address (of the smaller child).
-	size_t offset_i;
+	HbMem_FibAlloc_Word_i offset_i;
 	// [0] - smaller, [1] - larger.
 	// Smaller nodes are on the left, except for the root node, to keep the first allocations closer to 0, since smaller nodes are preferred for splitting.
 	// For node with size Fib[n], the smaller node has size Fib[n] - Fib[n - 1] because -2 is unsafe for 2, the larger node has size Fib[n - 1].
@@ -129,18 +169,164 @@ typedef struct HbMem_FibAlloc_Node_i {
 	HbMem_FibAlloc_Node_Child_i children_i[2];
 	// If it's an active node with a free child, this is the previous node in the free list (see HbMem_FibAlloc_Node_Child_i::childOrNextFreeNodeIndex_i).
 	// There can be at most one free child, so only one link needs to be stored.
-	// If it's a recycled node, this is the node that was recycled previously, SIZE_MAX if the end.
-	size_t prevFreeOrRecycledNodeIndex_i;
+	// If it's a recycled node, this is the node that was recycled previously, 0 (the root, which is never recycled) if the end.
+	HbMem_FibAlloc_Word_i prevFreeOrRecycledNodeIndex_i;
+	// The node with this node as a split child, for merging upwards from an allocation when it's freed. Not used for the root.
+	HbMem_FibAlloc_Word_i isLargerInParent_i : 1;
+	#if HbMem_FibAlloc_Node_LevelBits_i != 0
+	// Packed with the parent node index, which still has more bits than nodes can fit in memory, keeping the node at 40 bytes rather than 48.
+	HbMem_FibAlloc_Word_i level_i : HbMem_FibAlloc_Node_LevelBits_i; // The level of the block split into the children, largestLevel_r + 1 for the root.
+	HbMem_FibAlloc_Word_i parentNodeIndex_i : (HbMem_FibAlloc_WordBits_i - 1 - HbMem_FibAlloc_Node_LevelBits_i);
+	#else
+	HbMem_FibAlloc_Word_i parentNodeIndex_i : (HbMem_FibAlloc_WordBits_i - 1);
+	uint8_t level_i; // The level of the block split into the children, largestLevel_r + 1 for the root.
+	#endif
 } HbMem_FibAlloc_Node_i;
 
 // - HbMem_FibAlloc_Node_Child_i uses a bit for isFree_i and also reserves zero (HbMem_FibAlloc_Node_Child_ChildNodeIndex_Data_i - the root node index) for an allocation.
-// - HbMem_FibAlloc_PathStep_i uses a bit for isLarger_i.
-#define HbMem_FibAlloc_MaxNodes_i ((SIZE_MAX >> 1) + 1)
+// - HbMem_FibAlloc_Node_i::parentNodeIndex_i and HbMem_FibAlloc_Allocation_i::nodeIndex_i use a bit for whether the child is the larger one,
+//   and the parent node index may also share the word with the level.
+#define HbMem_FibAlloc_MaxNodes_i (((size_t) (HbMem_FibAlloc_Word_i) SIZE_MAX >> (1 + HbMem_FibAlloc_Node_LevelBits_i)) + 1)
 
 typedef struct HbMem_FibAlloc_FreeList_i {
 	size_t freeNodeIndices_i[2]; // [0] - first smaller child on this level, [1] - first larger child on this level, SIZE_MAX if no free nodes.
+	size_t freeBlockCount_i; // In both lists.
 } HbMem_FibAlloc_FreeList_i;
 
+// Never a valid offset - the sizes of the largest levels allowed are smaller.
+#define HbMem_FibAlloc_Allocation_Empty_i ((HbMem_FibAlloc_Word_i) SIZE_MAX)
+
+typedef struct HbMem_FibAlloc_Allocation_i {
+	HbMem_FibAlloc_Word_i offset_i; // HbMem_FibAlloc_Allocation_Empty_i for free hash table slots.
+	HbMem_FibAlloc_Word_i isLarger_i : 1;
+	HbMem_FibAlloc_Word_i nodeIndex_i : (HbMem_FibAlloc_WordBits_i - 1);
+} HbMem_FibAlloc_Allocation_i;
+
+HbForceInline size_t HbMem_FibAlloc_HashAllocation_i(size_t const offset, size_t const capacity) {
+	// Offsets are often multiples of the sizes of the levels, mixing the bits before masking.
+	#if HbPlatform_CPU_Bits >= 64
+	size_t const hash = offset * (size_t) 0x9E3779B97F4A7C15;
+	return (hash ^ (hash >> 29)) & (capacity - 1);
+	#else
+	size_t const hash = offset * (size_t) 0x9E3779B9;
+	return (hash ^ (hash >> 15)) & (capacity - 1);
+	#endif
+}
+
+static void HbMem_FibAlloc_AddAllocation_i(HbMem_FibAlloc * const fibAlloc, size_t const offset, size_t const nodeIndex, HbBool const isLarger) {
+	// Keeping the load factor no higher than 1/2.
+	if ((fibAlloc->allocationCount_i + 1) * 2 > fibAlloc->allocationCapacity_i) {
+		size_t const newCapacity = fibAlloc->allocationCapacity_i != 0 ? fibAlloc->allocationCapacity_i * 2 : 16;
+		HbMem_FibAlloc_Allocation_i * const newAllocations = (HbMem_FibAlloc_Allocation_i *) HbMem_Tag_AllocElementsExplicit(
+				fibAlloc->nodes_i.tag_e, sizeof(HbMem_FibAlloc_Allocation_i), newCapacity, HbTrue,
+				fibAlloc->nodes_i.originNameImmutable_r, fibAlloc->nodes_i.originLocation_r);
+		for (size_t allocationIndex = 0; allocationIndex < newCapacity; ++allocationIndex) {
+			newAllocations[allocationIndex].offset_i = HbMem_FibAlloc_Allocation_Empty_i;
+		}
+		for (size_t allocationIndex = 0; allocationIndex < fibAlloc->allocationCapacity_i; ++allocationIndex) {
+			HbMem_FibAlloc_Allocation_i const * const allocation = &fibAlloc->allocations_i[allocationIndex];
+			if (allocation->offset_i == HbMem_FibAlloc_Allocation_Empty_i) {
+				continue;
+			}
+			size_t newAllocationIndex = HbMem_FibAlloc_HashAllocation_i(allocation->offset_i, newCapacity);
+			while (newAllocations[newAllocationIndex].offset_i != HbMem_FibAlloc_Allocation_Empty_i) {
+				newAllocationIndex = (newAllocationIndex + 1) & (newCapacity - 1);
+			}
+			newAllocations[newAllocationIndex] = *allocation;
+		}
+		if (fibAlloc->allocations_i != NULL) {
+			HbMem_Tag_Free(fibAlloc->allocations_i);
+		}
+		fibAlloc->allocations_i = newAllocations;
+		fibAlloc->allocationCapacity_i = newCapacity;
+	}
+	size_t allocationIndex = HbMem_FibAlloc_HashAllocation_i(offset, fibAlloc->allocationCapacity_i);
+	while (fibAlloc->allocations_i[allocationIndex].offset_i != HbMem_FibAlloc_Allocation_Empty_i) {
+		HbReport_Assert_Assume(fibAlloc->allocations_i[allocationIndex].offset_i != offset);
+		allocationIndex = (allocationIndex + 1) & (fibAlloc->allocationCapacity_i - 1);
+	}
+	HbMem_FibAlloc_Allocation_i * const allocation = &fibAlloc->allocations_i[allocationIndex];
+	allocation->offset_i = (HbMem_FibAlloc_Word_i) offset;
+	allocation->isLarger_i = isLarger;
+	allocation->nodeIndex_i = (HbMem_FibAlloc_Word_i) nodeIndex;
+	++fibAlloc->allocationCount_i;
+}
+
+// Removes the allocation from the hash table, returning HbFalse if it's not there.
+static HbBool HbMem_FibAlloc_RemoveAllocation_i(HbMem_FibAlloc * const fibAlloc, size_t const offset, HbMem_FibAlloc_Allocation_i * const allocationOut) {
+	if (fibAlloc->allocationCount_i == 0 || offset >= HbMem_FibAlloc_Allocation_Empty_i) {
+		return HbFalse;
+	}
+	size_t const capacityMask = fibAlloc->allocationCapacity_i - 1;
+	HbMem_FibAlloc_Allocation_i * const allocations = fibAlloc->allocations_i;
+	size_t holeIndex = HbMem_FibAlloc_HashAllocation_i(offset, fibAlloc->allocationCapacity_i);
+	for (;;) {
+		if (allocations[holeIndex].offset_i == offset) {
+			break;
+		}
+		if (allocations[holeIndex].offset_i == HbMem_FibAlloc_Allocation_Empty_i) {
+			return HbFalse;
+		}
+		holeIndex = (holeIndex + 1) & capacityMask;
+	}
+	*allocationOut = allocations[holeIndex];
+	--fibAlloc->allocationCount_i;
+	// Shift the following entries of the cluster back if the hole is within their probe sequence, so lookups don't stop at it.
+	for (size_t allocationIndex = (holeIndex + 1) & capacityMask; allocations[allocationIndex].offset_i != HbMem_FibAlloc_Allocation_Empty_i;
+	     allocationIndex = (allocationIndex + 1) & capacityMask) {
+		size_t const homeIndex = HbMem_FibAlloc_HashAllocation_i(allocations[allocationIndex].offset_i, fibAlloc->allocationCapacity_i);
+		if (((allocationIndex - homeIndex) & capacityMask) >= ((allocationIndex - holeIndex) & capacityMask)) {
+			allocations[holeIndex] = allocations[allocationIndex];
+			holeIndex = allocationIndex;
+		}
+	}
+	allocations[holeIndex].offset_i = HbMem_FibAlloc_Allocation_Empty_i;
+	return HbTrue;
+}
+
+HbForceInline void HbMem_FibAlloc_SetLevelFree_i(HbMem_FibAlloc * const fibAlloc, size_t const level, HbBool const isFree) {
+	size_t const levelBit = (size_t) 1 << (level % HbPlatform_CPU_Bits);
+	if (isFree) {
+		fibAlloc->freeLevelMasks_i[level / HbPlatform_CPU_Bits] |= levelBit;
+	} else {
+		fibAlloc->freeLevelMasks_i[level / HbPlatform_CPU_Bits] &= ~levelBit;
+	}
+}
+
+// The smallest level not smaller than the given one with a free node, SIZE_MAX if there's none.
+static size_t HbMem_FibAlloc_FindFreeLevelNotLess_i(HbMem_FibAlloc const * const fibAlloc, size_t const level) {
+	size_t maskIndex = level / HbPlatform_CPU_Bits;
+	if (maskIndex >= HbCountOf(fibAlloc->freeLevelMasks_i)) {
+		return SIZE_MAX;
+	}
+	size_t mask = fibAlloc->freeLevelMasks_i[maskIndex] & ((size_t) SIZE_MAX << (level % HbPlatform_CPU_Bits));
+	while (mask == 0) {
+		if (++maskIndex >= HbCountOf(fibAlloc->freeLevelMasks_i)) {
+			return SIZE_MAX;
+		}
+		mask = fibAlloc->freeLevelMasks_i[maskIndex];
+	}
+	return maskIndex * HbPlatform_CPU_Bits + HbMath_CountTrailingZeros_Size(mask);
+}
+
+// The largest level smaller than the given one, but not smaller than the minimum, with a free node, SIZE_MAX if there's none.
+static size_t HbMem_FibAlloc_FindFreeLevelLess_i(HbMem_FibAlloc const * const fibAlloc, size_t const level, size_t const minimumLevel) {
+	if (level <= minimumLevel) {
+		return SIZE_MAX;
+	}
+	size_t const lastLevel = level - 1;
+	size_t maskIndex = lastLevel / HbPlatform_CPU_Bits;
+	size_t mask = fibAlloc->freeLevelMasks_i[maskIndex] & ((size_t) SIZE_MAX >> (HbPlatform_CPU_Bits - 1 - lastLevel % HbPlatform_CPU_Bits));
+	while (mask == 0) {
+		if (maskIndex == 0) {
+			return SIZE_MAX;
+		}
+		mask = fibAlloc->freeLevelMasks_i[--maskIndex];
+	}
+	size_t const freeLevel = maskIndex * HbPlatform_CPU_Bits + (HbPlatform_CPU_Bits - 1 - HbMath_CountLeadingZeros_Size(mask));
+	return freeLevel >= minimumLevel ? freeLevel : SIZE_MAX;
+}
+
 HbForceInline size_t HbMem_FibAlloc_GetChildLevel_i(size_t const parentLevel, HbBool const isLarger) {
 	HbReport_Assert_Assume(parentLevel != 0);
 	// Clamp because if level 1 is split, both smaller and larger children are level 0 (1-sized).
@@ -161,6 +347,8 @@ static void HbMem_FibAlloc_AddNodeChildToFreeList_i(HbMem_FibAlloc * const fibAl
 	HbMem_FibAlloc_Node_i * const node = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, nodeIndex, HbMem_FibAlloc_Node_i);
 	node->children_i[isLarger].isFree_i = HbTrue;
 	HbMem_FibAlloc_FreeList_i * const freeList = &fibAlloc->freeLists_i[childLevel];
+	++freeList->freeBlockCount_i;
+	fibAlloc->freeUnitCount_r += HbMem_FibAlloc_Sizes[childLevel];
 	size_t const nextFreeNodeIndex = freeList->freeNodeIndices_i[isLarger];
 	if (nextFreeNodeIndex != SIZE_MAX) {
 		HbMem_FibAlloc_Node_i * const nextFreeNode = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, nextFreeNodeIndex, HbMem_FibAlloc_Node_i);
@@ -169,13 +357,14 @@ static void HbMem_FibAlloc_AddNodeChildToFreeList_i(HbMem_FibAlloc * const fibAl
 		HbMem_FibAlloc_Node_i * const prevFreeNode = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, prevFreeNodeIndex, HbMem_FibAlloc_Node_i);
 		HbReport_Assert_Assume(prevFreeNode->children_i[isLarger].isFree_i);
 		HbReport_Assert_Assume(prevFreeNode->children_i[isLarger].childOrNextFreeNodeIndex_i == nextFreeNodeIndex);
-		prevFreeNode->children_i[isLarger].childOrNextFreeNodeIndex_i = nodeIndex;
-		nextFreeNode->prevFreeOrRecycledNodeIndex_i = nodeIndex;
-		node->children_i[isLarger].childOrNextFreeNodeIndex_i = nextFreeNodeIndex;
-		node->prevFreeOrRecycledNodeIndex_i = prevFreeNodeIndex;
+		prevFreeNode->children_i[isLarger].childOrNextFreeNodeIndex_i = (HbMem_FibAlloc_Word_i) nodeIndex;
+		nextFreeNode->prevFreeOrRecycledNodeIndex_i = (HbMem_FibAlloc_Word_i) nodeIndex;
+		node->children_i[isLarger].childOrNextFreeNodeIndex_i = (HbMem_FibAlloc_Word_i) nextFreeNodeIndex;
+		node->prevFreeOrRecycledNodeIndex_i = (HbMem_FibAlloc_Word_i) prevFreeNodeIndex;
 	} else {
-		node->children_i[isLarger].childOrNextFreeNodeIndex_i = node->prevFreeOrRecycledNodeIndex_i = nodeIndex;
+		node->children_i[isLarger].childOrNextFreeNodeIndex_i = node->prevFreeOrRecycledNodeIndex_i = (HbMem_FibAlloc_Word_i) nodeIndex;
 		freeList->freeNodeIndices_i[isLarger] = nodeIndex;
+		HbMem_FibAlloc_SetLevelFree_i(fibAlloc, childLevel, HbTrue);
 	}
 }
 
@@ -185,6 +374,9 @@ static void HbMem_FibAlloc_UnlinkNodeChildFromFreeList_i(HbMem_FibAlloc * const
 	HbMem_FibAlloc_Node_i * const node = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, nodeIndex, HbMem_FibAlloc_Node_i);
 	HbReport_Assert_Assume(node->children_i[isLarger].isFree_i);
 	HbMem_FibAlloc_FreeList_i * const freeList = &fibAlloc->freeLists_i[childLevel];
+	HbReport_Assert_Assume(freeList->freeBlockCount_i != 0);
+	--freeList->freeBlockCount_i;
+	fibAlloc->freeUnitCount_r -= HbMem_FibAlloc_Sizes[childLevel];
 	size_t const nextFreeNodeIndex = node->children_i[isLarger].childOrNextFreeNodeIndex_i;
 	size_t const prevFreeNodeIndex = node->prevFreeOrRecycledNodeIndex_i;
 	if (nextFreeNodeIndex != nodeIndex) {
@@ -192,11 +384,11 @@ static void HbMem_FibAlloc_UnlinkNodeChildFromFreeList_i(HbMem_FibAlloc * const
 		HbMem_FibAlloc_Node_i * const prevFreeNode = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, prevFreeNodeIndex, HbMem_FibAlloc_Node_i);
 		HbReport_Assert_Assume(prevFreeNode->children_i[isLarger].isFree_i);
 		HbReport_Assert_Assume(prevFreeNode->children_i[isLarger].childOrNextFreeNodeIndex_i == nodeIndex);
-		prevFreeNode->children_i[isLarger].childOrNextFreeNodeIndex_i = nextFreeNodeIndex;
+		prevFreeNode->children_i[isLarger].childOrNextFreeNodeIndex_i = (HbMem_FibAlloc_Word_i) nextFreeNodeIndex;
 		HbMem_FibAlloc_Node_i * const nextFreeNode = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, nextFreeNodeIndex, HbMem_FibAlloc_Node_i);
 		HbReport_Assert_Assume(nextFreeNode->children_i[isLarger].isFree_i);
 		HbReport_Assert_Assume(nextFreeNode->prevFreeOrRecycledNodeIndex_i == nodeIndex);
-		nextFreeNode->prevFreeOrRecycledNodeIndex_i = prevFreeNodeIndex;
+		nextFreeNode->prevFreeOrRecycledNodeIndex_i = (HbMem_FibAlloc_Word_i) prevFreeNodeIndex;
 		if (freeList->freeNodeIndices_i[isLarger] == nodeIndex) {
 			freeList->freeNodeIndices_i[isLarger] = nextFreeNodeIndex;
 		}
@@ -204,6 +396,9 @@ static void HbMem_FibAlloc_UnlinkNodeChildFromFreeList_i(HbMem_FibAlloc * const
 		HbReport_Assert_Assume(prevFreeNodeIndex == nodeIndex);
 		HbReport_Assert_Assume(freeList->freeNodeIndices_i[isLarger] == nodeIndex);
 		freeList->freeNodeIndices_i[isLarger] = SIZE_MAX;
+		if (freeList->freeNodeIndices_i[!isLarger] == SIZE_MAX) {
+			HbMem_FibAlloc_SetLevelFree_i(fibAlloc, childLevel, HbFalse);
+		}
 	}
 }
 
@@ -211,17 +406,24 @@ void HbMem_FibAlloc_InitExplicit(HbMem_FibAlloc * const fibAlloc, size_t const l
                                  char const * const originNameImmutable, unsigned const originLocation) {
 	HbReport_Assert_Assume(fibAlloc != NULL);
 	HbReport_Assert_Assume(largestLevel < HbCountOf(HbMem_FibAlloc_Sizes));
+	#ifdef HbMem_Build_CompactFibAlloc
+	if (HbMem_FibAlloc_Sizes[largestLevel] >= HbMem_FibAlloc_Allocation_Empty_i) {
+		HbReport_Crash("Too large Fibonacci number block allocator requested at %s:%u (largest level %zu), offsets must fit in 32 bits with HbMem_Build_CompactFibAlloc.",
+		               originNameImmutable, originLocation, largestLevel);
+	}
+	#endif
 
 	fibAlloc->largestLevel_r = largestLevel;
 
-	HbMem_DynArray_InitExplicit(&fibAlloc->nodes_i, sizeof(HbMem_FibAlloc_Node_i), tag, originNameImmutable, originLocation);
-	fibAlloc->lastRecycledNodeIndex_i = SIZE_MAX;
+	HbMem_DynArray_InitExplicit(&fibAlloc->nodes_i, sizeof(HbMem_FibAlloc_Node_i), HbPlatform_AllocAlignment, tag, originNameImmutable, originLocation);
+	fibAlloc->lastRecycledNodeIndex_i = 0;
 
 	fibAlloc->freeLists_i = (HbMem_FibAlloc_FreeList_i *) HbMem_Tag_AllocElementsExplicit(
 			tag, sizeof(HbMem_FibAlloc_FreeList_i), largestLevel + 1, HbTrue, originNameImmutable, originLocation);
 	for (size_t level = 0; level <= largestLevel; ++level) {
 		HbMem_FibAlloc_FreeList_i * const freeList = &fibAlloc->freeLists_i[level];
 		freeList->freeNodeIndices_i[0] = freeList->freeNodeIndices_i[1] = SIZE_MAX;
+		freeList->freeBlockCount_i = 0;
 	}
 
 	// Pre-allocate some memory for the first few allocations.
@@ -239,11 +441,26 @@ void HbMem_FibAlloc_InitExplicit(HbMem_FibAlloc * const fibAlloc, size_t const l
 	// Only one entry, link to self.
 	rootNode->children_i[1].childOrNextFreeNodeIndex_i = rootNodeIndex;
 	rootNode->prevFreeOrRecycledNodeIndex_i = rootNodeIndex;
+	rootNode->isLargerInParent_i = HbFalse;
+	rootNode->parentNodeIndex_i = rootNodeIndex;
+	rootNode->level_i = (uint8_t) (largestLevel + 1);
 	fibAlloc->freeLists_i[largestLevel].freeNodeIndices_i[1] = rootNodeIndex;
+	fibAlloc->freeLists_i[largestLevel].freeBlockCount_i = 1;
+	fibAlloc->freeUnitCount_r = HbMem_FibAlloc_Sizes[largestLevel];
+	fibAlloc->recycledNodeCount_r = 0;
+	memset(fibAlloc->freeLevelMasks_i, 0, sizeof(fibAlloc->freeLevelMasks_i));
+	HbMem_FibAlloc_SetLevelFree_i(fibAlloc, largestLevel, HbTrue);
+
+	fibAlloc->allocations_i = NULL;
+	fibAlloc->allocationCapacity_i = 0;
+	fibAlloc->allocationCount_i = 0;
 }
 
 void HbMem_FibAlloc_Shutdown(HbMem_FibAlloc * const fibAlloc) {
 	HbReport_Assert_Assume(fibAlloc != NULL);
+	if (fibAlloc->allocations_i != NULL) {
+		HbMem_Tag_Free(fibAlloc->allocations_i);
+	}
 	HbMem_Tag_Free(fibAlloc->freeLists_i);
 	HbMem_DynArray_Shutdown(&fibAlloc->nodes_i);
 }
@@ -252,36 +469,22 @@ size_t HbMem_FibAlloc_Alloc(HbMem_FibAlloc * const fibAlloc, size_t const minimu
 	HbReport_Assert_Assume(fibAlloc != NULL);
 	HbReport_Assert_Assume(minimumCount != 0);
 	HbReport_Assert_Assume((minimumCount == preferredCount || allocationLevelOut != NULL) && "If allocating a flexible amount, must handle the actual amount.");
-	size_t const minimumLevel = HbSort_Find_FirstNotLess_Size(minimumCount, HbMem_FibAlloc_Sizes, HbCountOf(HbMem_FibAlloc_Sizes));
+	size_t const minimumLevel = HbMem_FibAlloc_FindFirstLevelNotLess_i(minimumCount);
 	if (minimumLevel > fibAlloc->largestLevel_r) {
 		return HbMem_FibAlloc_Alloc_Failed;
 	}
-	size_t const preferredLevel = HbMath_Clamp_Size(HbSort_Find_FirstNotLess_Size(preferredCount, HbMem_FibAlloc_Sizes, HbCountOf(HbMem_FibAlloc_Sizes)),
-	                                                minimumLevel, fibAlloc->largestLevel_r);
+	size_t const preferredLevel = HbMath_Clamp_Size(HbMem_FibAlloc_FindFirstLevelNotLess_i(preferredCount), minimumLevel, fibAlloc->largestLevel_r);
 
 	size_t allocationLevel = preferredLevel;
-	size_t freeLevel = SIZE_MAX;
 	// Try to allocate on the preferred level - take a node on it or find a larger node (up to the head node with the whole tree as the larger node) to split.
-	for (size_t level = preferredLevel; level <= fibAlloc->largestLevel_r; ++level) {
-		HbMem_FibAlloc_FreeList_i const * const freeList = &fibAlloc->freeLists_i[level];
-		if (freeList->freeNodeIndices_i[0] != SIZE_MAX || freeList->freeNodeIndices_i[1] != SIZE_MAX) {
-			freeLevel = level;
-			break;
-		}
-	}
+	size_t freeLevel = HbMem_FibAlloc_FindFreeLevelNotLess_i(fibAlloc, preferredLevel);
 	if (freeLevel == SIZE_MAX) {
 		// Try to allocate on the largest available level not smaller than the minimum.
-		while (allocationLevel > minimumLevel) {
-			--allocationLevel;
-			HbMem_FibAlloc_FreeList_i const * const freeList = &fibAlloc->freeLists_i[allocationLevel];
-			if (freeList->freeNodeIndices_i[0] != SIZE_MAX || freeList->freeNodeIndices_i[1] != SIZE_MAX) {
-				freeLevel = allocationLevel;
-				break;
-			}
-		}
+		freeLevel = HbMem_FibAlloc_FindFreeLevelLess_i(fibAlloc, preferredLevel, minimumLevel);
 		if (freeLevel == SIZE_MAX) {
 			return HbMem_FibAlloc_Alloc_Failed;
 		}
+		allocationLevel = freeLevel;
 	}
 
 	// Take a free list entry on the closest level with one.
@@ -294,13 +497,13 @@ size_t HbMem_FibAlloc_Alloc(HbMem_FibAlloc * const fibAlloc, size_t const minimu
 	// Create a path from the closest level with a free node to the allocation level.
 	while (freeLevel > allocationLevel) {
 		// Create the new split node.
-		HbBool const newNodeFromRecycled = fibAlloc->lastRecycledNodeIndex_i != SIZE_MAX;
+		HbBool const newNodeFromRecycled = fibAlloc->lastRecycledNodeIndex_i != 0;
 		size_t newNodeIndex;
 		if (newNodeFromRecycled) {
 			newNodeIndex = fibAlloc->lastRecycledNodeIndex_i;
 		} else {
-			#ifdef HbMem_SizeMaxChecksNeeded
-			// HbMem_DynArray_Append itself will check normally.
+			#if defined(HbMem_SizeMaxChecksNeeded) || defined(HbMem_Build_CompactFibAlloc)
+			// HbMem_DynArray_Append itself will check normally, but compact nodes have a lower limit.
 			if (SIZE_MAX / sizeof(HbMem_FibAlloc_Node_i) > HbMem_FibAlloc_MaxNodes_i && fibAlloc->nodes_i.count_r >= HbMem_FibAlloc_MaxNodes_i) {
 				HbReport_Crash("Too many Fibonacci number block allocator nodes created, max 0x%zX.", HbMem_FibAlloc_MaxNodes_i);
 			}
@@ -310,11 +513,15 @@ size_t HbMem_FibAlloc_Alloc(HbMem_FibAlloc * const fibAlloc, size_t const minimu
 		HbMem_FibAlloc_Node_i * const newNode = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, newNodeIndex, HbMem_FibAlloc_Node_i);
 		if (newNodeFromRecycled) {
 			fibAlloc->lastRecycledNodeIndex_i = newNode->prevFreeOrRecycledNodeIndex_i;
+			--fibAlloc->recycledNodeCount_r;
 		}
 		HbMem_FibAlloc_Node_i * const freeChildNode = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, freeChildNodeIndex, HbMem_FibAlloc_Node_i);
 		freeChildNode->children_i[freeChildIsLarger].isFree_i = HbFalse;
-		freeChildNode->children_i[freeChildIsLarger].childOrNextFreeNodeIndex_i = newNodeIndex;
-		newNode->offset_i = freeChildNode->offset_i + HbMem_FibAlloc_GetChildRelativeOffset_i(freeLevel, fibAlloc->largestLevel_r, freeChildIsLarger);
+		freeChildNode->children_i[freeChildIsLarger].childOrNextFreeNodeIndex_i = (HbMem_FibAlloc_Word_i) newNodeIndex;
+		newNode->offset_i = freeChildNode->offset_i + (HbMem_FibAlloc_Word_i) HbMem_FibAlloc_GetChildRelativeOffset_i(freeLevel, fibAlloc->largestLevel_r, freeChildIsLarger);
+		newNode->isLargerInParent_i = freeChildIsLarger;
+		newNode->parentNodeIndex_i = (HbMem_FibAlloc_Word_i) freeChildNodeIndex;
+		newNode->level_i = (uint8_t) freeLevel;
 		// Add one child to the free list and take another one for the next iteration.
 		HbBool const continueInLargerChild = freeLevel - allocationLevel <= 1; // Prefer splitting smaller nodes, only split the larger node on the smallest level if have to.
 		HbMem_FibAlloc_AddNodeChildToFreeList_i(fibAlloc, newNodeIndex, !continueInLargerChild, HbMem_FibAlloc_GetChildLevel_i(freeLevel, !continueInLargerChild));
@@ -329,73 +536,301 @@ size_t HbMem_FibAlloc_Alloc(HbMem_FibAlloc * const fibAlloc, size_t const minimu
 	if (allocationLevelOut != NULL) {
 		*allocationLevelOut = allocationLevel;
 	}
-	return allocationNode->offset_i + HbMem_FibAlloc_GetChildRelativeOffset_i(allocationLevel, fibAlloc->largestLevel_r, freeChildIsLarger);
+	size_t const allocation = allocationNode->offset_i + HbMem_FibAlloc_GetChildRelativeOffset_i(allocationLevel, fibAlloc->largestLevel_r, freeChildIsLarger);
+	HbMem_FibAlloc_AddAllocation_i(fibAlloc, allocation, freeChildNodeIndex, freeChildIsLarger);
+	return allocation;
 }
 
-typedef struct HbMem_FibAlloc_PathStep_i {
-	size_t isLarger_i : 1; // Whether this step corresponds to largerChild (of a narrower level) or smallerChild (of a broader level).
-	size_t nodeIndex_i : (sizeof(size_t) * CHAR_BIT - 1);
-	size_t childLevel_i; // Need to store explicitly because level 0 is the smaller child of both levels 1 and 2.
-} HbMem_FibAlloc_PathStep_i;
-
-// Starts from the child on fibAlloc->largestLevel_r. Returns the number of references, or 0 if failed (still overwrites in case of failure).
-// pathOut must be large enough to store (fibAlloc->largestLevel_r + 1) elements, HbCountOf(HbMem_FibAlloc_Sizes) at most.
-static size_t HbMem_FibAlloc_GetPathToAllocation_i(HbMem_FibAlloc const * const fibAlloc, size_t const allocation, HbMem_FibAlloc_PathStep_i pathOut[]) {
+void HbMem_FibAlloc_Free(HbMem_FibAlloc * const fibAlloc, size_t const allocation) {
 	HbReport_Assert_Assume(fibAlloc != NULL);
-	HbReport_Assert_Assume(pathOut != NULL);
-	size_t pathLength = 0;
-	size_t nodeIndex = 0; // Start from the root, which contains the largest level as the larger child.
-	size_t nodeLevel = fibAlloc->largestLevel_r + 1;
+	HbMem_FibAlloc_Allocation_i allocationEntry;
+	if (!HbMem_FibAlloc_RemoveAllocation_i(fibAlloc, allocation, &allocationEntry)) {
+		HbReport_Crash("Tried to free an allocation that wasn't created with HbMem_FibAlloc_Alloc or has already been freed (%zu).", allocation);
+	}
+	size_t nodeIndex = allocationEntry.nodeIndex_i;
+	HbBool isLarger = (HbBool) allocationEntry.isLarger_i;
+	HbMem_FibAlloc_Node_i * node = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, nodeIndex, HbMem_FibAlloc_Node_i);
+	HbReport_Assert_Assume(!node->children_i[isLarger].isFree_i);
+	HbReport_Assert_Assume(node->children_i[isLarger].childOrNextFreeNodeIndex_i == HbMem_FibAlloc_Node_Child_ChildNodeIndex_Data_i);
+	size_t childLevel = HbMem_FibAlloc_GetChildLevel_i(node->level_i, isLarger);
+	// Combine split nodes into free nodes while both children are now free, going up only as far as merging happens.
+	for (;;) {
+		if (!node->children_i[!isLarger].isFree_i) {
+			HbMem_FibAlloc_AddNodeChildToFreeList_i(fibAlloc, nodeIndex, isLarger, childLevel);
+			break;
+		}
+		// If both are now free, destroy (recycle) the child node - first removing the sibling from the free list.
+		HbReport_Assert_Assume(nodeIndex != 0); // On the largest level, the sibling is never free.
+		HbMem_FibAlloc_UnlinkNodeChildFromFreeList_i(fibAlloc, nodeIndex, !isLarger, HbMem_FibAlloc_GetChildLevel_i(node->level_i, !isLarger));
+		size_t const parentNodeIndex = node->parentNodeIndex_i;
+		isLarger = (HbBool) node->isLargerInParent_i;
+		childLevel = node->level_i;
+		// Recycle the node with both now free children.
+		node->prevFreeOrRecycledNodeIndex_i = (HbMem_FibAlloc_Word_i) fibAlloc->lastRecycledNodeIndex_i;
+		fibAlloc->lastRecycledNodeIndex_i = nodeIndex;
+		++fibAlloc->recycledNodeCount_r;
+		nodeIndex = parentNodeIndex;
+		node = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, nodeIndex, HbMem_FibAlloc_Node_i);
+	}
+}
+
+#ifdef HbReport_Build_Assert
+// The level of the live allocation at the offset, SIZE_MAX if there's none.
+static size_t HbMem_FibAlloc_GetAllocationLevel_i(HbMem_FibAlloc const * const fibAlloc, size_t const offset) {
+	if (fibAlloc->allocationCount_i == 0 || offset >= HbMem_FibAlloc_Allocation_Empty_i) {
+		return SIZE_MAX;
+	}
+	size_t allocationIndex = HbMem_FibAlloc_HashAllocation_i(offset, fibAlloc->allocationCapacity_i);
 	for (;;) {
-		HbMem_FibAlloc_Node_i const * const node = HbMem_DynArray_Get(&fibAlloc->nodes_i, nodeIndex, HbMem_FibAlloc_Node_i);
-		size_t const largerChildOffset = node->offset_i + HbMem_FibAlloc_GetChildRelativeOffset_i(nodeLevel - 1, fibAlloc->largestLevel_r, HbTrue);
-		HbBool continueInLargerChild = allocation >= largerChildOffset; // < - smaller, >= larger, >= 0 for the root where the only node is larger.
-		size_t const childLevel = HbMem_FibAlloc_GetChildLevel_i(nodeLevel, continueInLargerChild);
-		HbMem_FibAlloc_PathStep_i * const pathStep = &pathOut[pathLength];
-		pathStep->isLarger_i = continueInLargerChild;
-		pathStep->nodeIndex_i = nodeIndex;
-		pathStep->childLevel_i = childLevel;
-		++pathLength;
-		HbMem_FibAlloc_Node_Child_i const * const child = &node->children_i[continueInLargerChild];
-		if (child->isFree_i) {
-			return 0;
+		HbMem_FibAlloc_Allocation_i const * const allocation = &fibAlloc->allocations_i[allocationIndex];
+		if (allocation->offset_i == offset) {
+			HbMem_FibAlloc_Node_i const * const node = HbMem_DynArray_Get(&fibAlloc->nodes_i, allocation->nodeIndex_i, HbMem_FibAlloc_Node_i);
+			return HbMem_FibAlloc_GetChildLevel_i(node->level_i, (HbBool) allocation->isLarger_i);
+		}
+		if (allocation->offset_i == HbMem_FibAlloc_Allocation_Empty_i) {
+			return SIZE_MAX;
+		}
+		allocationIndex = (allocationIndex + 1) & (fibAlloc->allocationCapacity_i - 1);
+	}
+}
+#endif
+
+void HbMem_FibAlloc_GetStats(HbMem_FibAlloc const * const fibAlloc, HbMem_FibAlloc_Stats * const stats) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	HbReport_Assert_Assume(stats != NULL);
+	memset(stats, 0, sizeof(HbMem_FibAlloc_Stats));
+	stats->liveAllocationCount_r = fibAlloc->allocationCount_i;
+	stats->freeUnitCount_r = fibAlloc->freeUnitCount_r;
+	stats->largestFreeLevel_r = HbMem_FibAlloc_GetLargestFreeLevel(fibAlloc);
+	stats->nodeCount_r = fibAlloc->nodes_i.count_r - fibAlloc->recycledNodeCount_r;
+	stats->recycledNodeCount_r = fibAlloc->recycledNodeCount_r;
+	for (size_t level = 0; level <= fibAlloc->largestLevel_r; ++level) {
+		stats->freeBlockCounts_r[level] = fibAlloc->freeLists_i[level].freeBlockCount_i;
+	}
+}
+
+HbStaticAssert(HbMem_FibAlloc_Concurrent_CacheCapacity <= UINT8_MAX, "HbMem_FibAlloc_Concurrent_Shard_i::cachedCounts_i are 8-bit.");
+HbStaticAssert(HbMem_FibAlloc_Concurrent_BatchCount <= HbMem_FibAlloc_Concurrent_CacheCapacity, "Returned batches are taken from a full cache level.");
+
+static uint32_t volatile HbMem_FibAlloc_Concurrent_NextThreadShardIndex_i = 0;
+static HbThreadLocal uint_least8_t HbMem_FibAlloc_Concurrent_ThreadShardIndexPlusOne_i = 0; // Zero if not assigned yet.
+
+HbForceInline HbMem_FibAlloc_Concurrent_Shard_i * HbMem_FibAlloc_Concurrent_GetThreadShard_i(HbMem_FibAlloc_Concurrent * const fibAlloc) {
+	size_t shardIndexPlusOne = HbMem_FibAlloc_Concurrent_ThreadShardIndexPlusOne_i;
+	if (shardIndexPlusOne == 0) {
+		shardIndexPlusOne = HbPara_Atomic_U32_Add(&HbMem_FibAlloc_Concurrent_NextThreadShardIndex_i, 1) % HbMem_FibAlloc_Concurrent_ShardCount + 1;
+		HbMem_FibAlloc_Concurrent_ThreadShardIndexPlusOne_i = (uint_least8_t) shardIndexPlusOne;
+	}
+	return &fibAlloc->shards_i[shardIndexPlusOne - 1];
+}
+
+void HbMem_FibAlloc_Concurrent_InitExplicit(HbMem_FibAlloc_Concurrent * const fibAlloc, size_t const largestLevel, HbMem_Tag * const tag,
+                                            char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	// Recursive for HbMem_FibAlloc_Concurrent_LockForChecks_i.
+	HbPara_Mutex_Init(&fibAlloc->fibAllocMutex_i, HbTrue);
+	HbMem_FibAlloc_InitExplicit(&fibAlloc->fibAlloc_i, largestLevel, tag, originNameImmutable, originLocation);
+	size_t const levelCount = largestLevel + 1;
+	for (size_t shardIndex = 0; shardIndex < HbMem_FibAlloc_Concurrent_ShardCount; ++shardIndex) {
+		HbMem_FibAlloc_Concurrent_Shard_i * const shard = &fibAlloc->shards_i[shardIndex];
+		memset(&shard->lock_i, 0, sizeof(shard->lock_i)); // HbPara_Spinlock is zero-initialized.
+		// A separate allocation for each shard not to share cache lines between threads.
+		shard->cachedAllocations_i = (size_t *) HbMem_Tag_AllocExplicit(
+				tag, (sizeof(size_t) * HbMem_FibAlloc_Concurrent_CacheCapacity + sizeof(uint8_t)) * levelCount, HbTrue, originNameImmutable, originLocation);
+		shard->cachedCounts_i = (uint8_t *) (shard->cachedAllocations_i + HbMem_FibAlloc_Concurrent_CacheCapacity * levelCount);
+		memset(shard->cachedCounts_i, 0, levelCount);
+	}
+}
+
+void HbMem_FibAlloc_Concurrent_Shutdown(HbMem_FibAlloc_Concurrent * const fibAlloc) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	for (size_t shardIndex = 0; shardIndex < HbMem_FibAlloc_Concurrent_ShardCount; ++shardIndex) {
+		HbMem_Tag_Free(fibAlloc->shards_i[shardIndex].cachedAllocations_i);
+	}
+	HbMem_FibAlloc_Shutdown(&fibAlloc->fibAlloc_i);
+	HbPara_Mutex_Shutdown(&fibAlloc->fibAllocMutex_i);
+}
+
+// In assert builds, the tree mutex is held while blocks are moved from the caches to the tree, so HbMem_FibAlloc_Concurrent_Free can check that a
+// block is live in the tree and not in any cache without missing the blocks in transit.
+HbForceInline void HbMem_FibAlloc_Concurrent_LockForChecks_i(HbMem_FibAlloc_Concurrent * const fibAlloc) {
+	#ifdef HbReport_Build_Assert
+	HbPara_Mutex_Lock(&fibAlloc->fibAllocMutex_i);
+	#else
+	HbUnused(fibAlloc);
+	#endif
+}
+
+HbForceInline void HbMem_FibAlloc_Concurrent_UnlockForChecks_i(HbMem_FibAlloc_Concurrent * const fibAlloc) {
+	#ifdef HbReport_Build_Assert
+	HbPara_Mutex_Unlock(&fibAlloc->fibAllocMutex_i);
+	#else
+	HbUnused(fibAlloc);
+	#endif
+}
+
+static void HbMem_FibAlloc_Concurrent_FreeInTree_i(HbMem_FibAlloc_Concurrent * const fibAlloc, size_t const * const allocations, size_t const count) {
+	HbPara_Mutex_Lock(&fibAlloc->fibAllocMutex_i);
+	for (size_t allocationIndex = 0; allocationIndex < count; ++allocationIndex) {
+		HbMem_FibAlloc_Free(&fibAlloc->fibAlloc_i, allocations[allocationIndex]);
+	}
+	HbPara_Mutex_Unlock(&fibAlloc->fibAllocMutex_i);
+}
+
+void HbMem_FibAlloc_Concurrent_Flush(HbMem_FibAlloc_Concurrent * const fibAlloc) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	size_t const levelCount = fibAlloc->fibAlloc_i.largestLevel_r + 1;
+	size_t flushedAllocations[HbMem_FibAlloc_LevelCount * HbMem_FibAlloc_Concurrent_CacheCapacity];
+	for (size_t shardIndex = 0; shardIndex < HbMem_FibAlloc_Concurrent_ShardCount; ++shardIndex) {
+		HbMem_FibAlloc_Concurrent_Shard_i * const shard = &fibAlloc->shards_i[shardIndex];
+		size_t flushedCount = 0;
+		HbMem_FibAlloc_Concurrent_LockForChecks_i(fibAlloc);
+		HbPara_Spinlock_Lock(&shard->lock_i);
+		for (size_t level = 0; level < levelCount; ++level) {
+			size_t const cachedCount = shard->cachedCounts_i[level];
+			memcpy(flushedAllocations + flushedCount, shard->cachedAllocations_i + HbMem_FibAlloc_Concurrent_CacheCapacity * level, sizeof(size_t) * cachedCount);
+			flushedCount += cachedCount;
+			shard->cachedCounts_i[level] = 0;
+		}
+		HbPara_Spinlock_Unlock(&shard->lock_i);
+		if (flushedCount != 0) {
+			HbMem_FibAlloc_Concurrent_FreeInTree_i(fibAlloc, flushedAllocations, flushedCount);
+		}
+		HbMem_FibAlloc_Concurrent_UnlockForChecks_i(fibAlloc);
+	}
+}
+
+size_t HbMem_FibAlloc_Concurrent_Alloc(HbMem_FibAlloc_Concurrent * const fibAlloc, size_t const minimumCount, size_t const preferredCount,
+                                       size_t * const allocationLevelOut) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	HbReport_Assert_Assume(minimumCount != 0);
+	HbReport_Assert_Assume((minimumCount == preferredCount || allocationLevelOut != NULL) && "If allocating a flexible amount, must handle the actual amount.");
+	size_t const minimumLevel = HbMem_FibAlloc_FindFirstLevelNotLess_i(minimumCount);
+	if (minimumLevel > fibAlloc->fibAlloc_i.largestLevel_r) {
+		return HbMem_FibAlloc_Alloc_Failed;
+	}
+	size_t const preferredLevel = HbMath_Clamp_Size(HbMem_FibAlloc_FindFirstLevelNotLess_i(preferredCount), minimumLevel, fibAlloc->fibAlloc_i.largestLevel_r);
+	size_t allocationLevel = preferredLevel;
+	size_t allocation = HbMem_FibAlloc_Alloc_Failed;
+
+	// Take the most recently freed block of the preferred level from the cache of the thread.
+	HbMem_FibAlloc_Concurrent_Shard_i * const shard = HbMem_FibAlloc_Concurrent_GetThreadShard_i(fibAlloc);
+	HbPara_Spinlock_Lock(&shard->lock_i);
+	size_t const cachedCount = shard->cachedCounts_i[preferredLevel];
+	if (cachedCount != 0) {
+		allocation = shard->cachedAllocations_i[HbMem_FibAlloc_Concurrent_CacheCapacity * preferredLevel + (cachedCount - 1)];
+		shard->cachedCounts_i[preferredLevel] = (uint8_t) (cachedCount - 1);
+	}
+	HbPara_Spinlock_Unlock(&shard->lock_i);
+	if (allocation != HbMem_FibAlloc_Alloc_Failed) {
+		if (allocationLevelOut != NULL) {
+			*allocationLevelOut = allocationLevel;
 		}
-		if (child->childOrNextFreeNodeIndex_i == HbMem_FibAlloc_Node_Child_ChildNodeIndex_Data_i) {
-			if (allocation != (continueInLargerChild ? largerChildOffset : node->offset_i)) {
-				return 0; // Reached an allocation, but not what was asked.
+		return allocation;
+	}
+
+	// Allocate in the tree, also taking more blocks of the same level for the next allocations.
+	size_t batchAllocations[HbMem_FibAlloc_Concurrent_BatchCount - 1];
+	size_t batchCount = 0;
+	HbPara_Mutex_Lock(&fibAlloc->fibAllocMutex_i);
+	allocation = HbMem_FibAlloc_Alloc(&fibAlloc->fibAlloc_i, minimumCount, preferredCount, &allocationLevel);
+	if (allocation != HbMem_FibAlloc_Alloc_Failed && allocationLevel == preferredLevel) {
+		size_t const levelSize = HbMem_FibAlloc_Sizes[preferredLevel];
+		while (batchCount < HbCountOf(batchAllocations)) {
+			size_t const batchAllocation = HbMem_FibAlloc_Alloc(&fibAlloc->fibAlloc_i, levelSize, levelSize, NULL);
+			if (batchAllocation == HbMem_FibAlloc_Alloc_Failed) {
+				break;
 			}
-			break;
+			batchAllocations[batchCount++] = batchAllocation;
+		}
+	}
+	HbPara_Mutex_Unlock(&fibAlloc->fibAllocMutex_i);
+	if (allocation == HbMem_FibAlloc_Alloc_Failed) {
+		// The blocks cached by the threads may be merged with their free neighbors into a large enough one.
+		HbMem_FibAlloc_Concurrent_Flush(fibAlloc);
+		HbPara_Mutex_Lock(&fibAlloc->fibAllocMutex_i);
+		allocation = HbMem_FibAlloc_Alloc(&fibAlloc->fibAlloc_i, minimumCount, preferredCount, &allocationLevel);
+		HbPara_Mutex_Unlock(&fibAlloc->fibAllocMutex_i);
+		if (allocation == HbMem_FibAlloc_Alloc_Failed) {
+			return HbMem_FibAlloc_Alloc_Failed;
+		}
+	}
+	if (batchCount != 0) {
+		// Another thread of the shard may have filled the cache level in the meantime.
+		HbPara_Spinlock_Lock(&shard->lock_i);
+		size_t const batchCachedCount = shard->cachedCounts_i[preferredLevel];
+		size_t const batchCachingCount = HbMath_Min_Size(batchCount, HbMem_FibAlloc_Concurrent_CacheCapacity - batchCachedCount);
+		memcpy(shard->cachedAllocations_i + (HbMem_FibAlloc_Concurrent_CacheCapacity * preferredLevel + batchCachedCount), batchAllocations,
+		       sizeof(size_t) * batchCachingCount);
+		shard->cachedCounts_i[preferredLevel] = (uint8_t) (batchCachedCount + batchCachingCount);
+		HbPara_Spinlock_Unlock(&shard->lock_i);
+		if (batchCachingCount < batchCount) {
+			HbMem_FibAlloc_Concurrent_FreeInTree_i(fibAlloc, batchAllocations + batchCachingCount, batchCount - batchCachingCount);
 		}
-		HbReport_Assert_Assume(nodeLevel != 0);
-		nodeIndex = child->childOrNextFreeNodeIndex_i;
-		nodeLevel = childLevel;
 	}
-	return pathLength;
+	if (allocationLevelOut != NULL) {
+		*allocationLevelOut = allocationLevel;
+	}
+	return allocation;
 }
 
-void HbMem_FibAlloc_Free(HbMem_FibAlloc * const fibAlloc, size_t const allocation) {
+void HbMem_FibAlloc_Concurrent_Free(HbMem_FibAlloc_Concurrent * const fibAlloc, size_t const allocation, size_t const allocationLevel) {
 	HbReport_Assert_Assume(fibAlloc != NULL);
-	HbMem_FibAlloc_PathStep_i path[HbCountOf(HbMem_FibAlloc_Sizes)];
-	size_t const pathLength = HbMem_FibAlloc_GetPathToAllocation_i(fibAlloc, allocation, path);
-	if (pathLength == 0) {
-		HbReport_Crash("Tried to free an allocation that wasn't created with HbMem_FibAlloc_Alloc or has already been freed (%zu).", allocation);
+	HbReport_Assert_Assume(allocationLevel <= fibAlloc->fibAlloc_i.largestLevel_r);
+	size_t returnedAllocations[HbMem_FibAlloc_Concurrent_BatchCount];
+	size_t returnedCount = 0;
+	// Held until the block is cached, so concurrent frees of the same block are checked one after another.
+	HbMem_FibAlloc_Concurrent_LockForChecks_i(fibAlloc);
+	#ifdef HbReport_Build_Assert
+	// Cached blocks are still live in the tree, so the block must be live there with the same level, and not cached by any thread yet.
+	size_t const liveAllocationLevel = HbMem_FibAlloc_GetAllocationLevel_i(&fibAlloc->fibAlloc_i, allocation);
+	if (liveAllocationLevel == SIZE_MAX) {
+		HbReport_Crash("Tried to free an allocation that wasn't created with HbMem_FibAlloc_Concurrent_Alloc or has already been freed (%zu).", allocation);
 	}
-	// Combine split nodes into free nodes while both children are now free.
-	size_t pathRemaining = pathLength;
-	while (pathRemaining > 0) {
-		size_t const pathStepIndex = --pathRemaining;
-		HbMem_FibAlloc_PathStep_i const * const pathStep = &path[pathStepIndex];
-		HbMem_FibAlloc_Node_i * const pathStepNode = HbMem_DynArray_GetMut(&fibAlloc->nodes_i, pathStep->nodeIndex_i, HbMem_FibAlloc_Node_i);
-		if (!pathStepNode->children_i[!pathStep->isLarger_i].isFree_i) {
-			HbMem_FibAlloc_AddNodeChildToFreeList_i(fibAlloc, pathStep->nodeIndex_i, (HbBool) pathStep->isLarger_i, pathStep->childLevel_i);
-			break;
+	if (liveAllocationLevel != allocationLevel) {
+		HbReport_Crash("Tried to free an allocation (%zu) of level %zu as level %zu.", allocation, liveAllocationLevel, allocationLevel);
+	}
+	for (size_t shardIndex = 0; shardIndex < HbMem_FibAlloc_Concurrent_ShardCount; ++shardIndex) {
+		HbMem_FibAlloc_Concurrent_Shard_i * const checkedShard = &fibAlloc->shards_i[shardIndex];
+		HbPara_Spinlock_Lock(&checkedShard->lock_i);
+		size_t const * const checkedCachedAllocations = checkedShard->cachedAllocations_i + HbMem_FibAlloc_Concurrent_CacheCapacity * allocationLevel;
+		for (size_t cachedIndex = 0; cachedIndex < checkedShard->cachedCounts_i[allocationLevel]; ++cachedIndex) {
+			if (checkedCachedAllocations[cachedIndex] == allocation) {
+				HbReport_Crash("Tried to free an allocation that has already been freed (%zu).", allocation);
+			}
 		}
-		// If both are now free, destroy (recycle) the child node - first removing the sibling from the free list.
-		HbReport_Assert_Assume(pathStepIndex != 0); // On the largest level, the sibling is never free.
-		HbMem_FibAlloc_UnlinkNodeChildFromFreeList_i(fibAlloc, pathStep->nodeIndex_i, !pathStep->isLarger_i,
-		                                             HbMem_FibAlloc_GetChildLevel_i(path[pathStepIndex - 1].childLevel_i, !pathStep->isLarger_i));
-		// Recycle the node with both now free children.
-		pathStepNode->prevFreeOrRecycledNodeIndex_i = fibAlloc->lastRecycledNodeIndex_i;
-		fibAlloc->lastRecycledNodeIndex_i = pathStep->nodeIndex_i;
+		HbPara_Spinlock_Unlock(&checkedShard->lock_i);
+	}
+	#endif
+	HbMem_FibAlloc_Concurrent_Shard_i * const shard = HbMem_FibAlloc_Concurrent_GetThreadShard_i(fibAlloc);
+	HbPara_Spinlock_Lock(&shard->lock_i);
+	size_t * const levelCachedAllocations = shard->cachedAllocations_i + HbMem_FibAlloc_Concurrent_CacheCapacity * allocationLevel;
+	size_t cachedCount = shard->cachedCounts_i[allocationLevel];
+	// Also checked without assertions, as it's only a few comparisons within the cache lines already being accessed.
+	for (size_t cachedIndex = 0; cachedIndex < cachedCount; ++cachedIndex) {
+		if (levelCachedAllocations[cachedIndex] == allocation) {
+			HbReport_Crash("Tried to free an allocation that has already been freed (%zu).", allocation);
+		}
+	}
+	if (cachedCount == HbMem_FibAlloc_Concurrent_CacheCapacity) {
+		// Return the least recently freed blocks to the tree.
+		returnedCount = HbMem_FibAlloc_Concurrent_BatchCount;
+		memcpy(returnedAllocations, levelCachedAllocations, sizeof(size_t) * returnedCount);
+		memmove(levelCachedAllocations, levelCachedAllocations + returnedCount, sizeof(size_t) * (cachedCount - returnedCount));
+		cachedCount -= returnedCount;
 	}
+	levelCachedAllocations[cachedCount] = allocation;
+	shard->cachedCounts_i[allocationLevel] = (uint8_t) (cachedCount + 1);
+	HbPara_Spinlock_Unlock(&shard->lock_i);
+	if (returnedCount != 0) {
+		HbMem_FibAlloc_Concurrent_FreeInTree_i(fibAlloc, returnedAllocations, returnedCount);
+	}
+	HbMem_FibAlloc_Concurrent_UnlockForChecks_i(fibAlloc);
+}
+
+void HbMem_FibAlloc_Concurrent_GetStats(HbMem_FibAlloc_Concurrent * const fibAlloc, HbMem_FibAlloc_Stats * const stats) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	HbPara_Mutex_Lock(&fibAlloc->fibAllocMutex_i);
+	HbMem_FibAlloc_GetStats(&fibAlloc->fibAlloc_i, stats);
+	HbPara_Mutex_Unlock(&fibAlloc->fibAllocMutex_i);
 }
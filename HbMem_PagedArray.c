@@ -0,0 +1,94 @@
+#include "HbMath.h"
+#include "HbMem.h"
+#include "HbReport.h"
+
+void HbMem_PagedArray_InitExplicit(HbMem_PagedArray * const array, size_t const elementSize, size_t const chunkCapacity,
+                                   HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(elementSize != 0);
+	HbMem_DynArray_InitExplicit(&array->chunks_i, sizeof(void *), HbPlatform_AllocAlignment, tag, originNameImmutable, originLocation);
+	array->elementSize_r = elementSize;
+	array->count_r = 0;
+	array->capacity_r = 0;
+	size_t const neededChunkCapacity = HbMath_Max_Size(chunkCapacity != 0 ? chunkCapacity : HbMem_PagedArray_DefaultChunkSize / elementSize, 1);
+	// Rounding up to a power of two.
+	array->chunkCapacityLog2_r = neededChunkCapacity > 1 ? HbPlatform_CPU_Bits - HbMath_CountLeadingZeros_Size(neededChunkCapacity - 1) : 0;
+	array->fibAlloc_e = NULL;
+	array->poolMemory_e = NULL;
+	array->poolUnitSize_r = 0;
+}
+
+void HbMem_PagedArray_InitInPoolExplicit(HbMem_PagedArray * const array, size_t const elementSize, size_t const chunkCapacity,
+                                         HbMem_FibAlloc * const fibAlloc, void * const poolMemory, size_t const poolUnitSize,
+                                         HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(fibAlloc != NULL);
+	HbReport_Assert_Assume(poolMemory != NULL);
+	HbReport_Assert_Assume(poolUnitSize != 0);
+	HbMem_PagedArray_InitExplicit(array, elementSize, chunkCapacity, tag, originNameImmutable, originLocation);
+	array->fibAlloc_e = fibAlloc;
+	array->poolMemory_e = (HbByte *) poolMemory;
+	array->poolUnitSize_r = poolUnitSize;
+}
+
+static void HbMem_PagedArray_FreeChunk_i(HbMem_PagedArray * const array, void * const chunk) {
+	if (array->fibAlloc_e != NULL) {
+		HbMem_FibAlloc_Free(array->fibAlloc_e, (size_t) ((HbByte *) chunk - array->poolMemory_e) / array->poolUnitSize_r);
+	} else {
+		HbMem_Tag_Free(chunk);
+	}
+}
+
+void HbMem_PagedArray_Shutdown(HbMem_PagedArray * const array) {
+	HbReport_Assert_Assume(array != NULL);
+	void * const * const chunks = (void * const *) array->chunks_i.data_r;
+	for (size_t chunkIndex = 0; chunkIndex < array->chunks_i.count_r; ++chunkIndex) {
+		HbMem_PagedArray_FreeChunk_i(array, chunks[chunkIndex]);
+	}
+	HbMem_DynArray_Shutdown(&array->chunks_i);
+}
+
+void HbMem_PagedArray_Reserve(HbMem_PagedArray * const array, size_t const capacity) {
+	HbReport_Assert_Assume(array != NULL);
+	if (capacity <= array->capacity_r) {
+		return;
+	}
+	size_t const chunkCapacity = (size_t) 1 << array->chunkCapacityLog2_r;
+	size_t const chunkCount = (capacity >> array->chunkCapacityLog2_r) + ((capacity & (chunkCapacity - 1)) != 0 ? 1 : 0);
+	#ifdef HbMem_SizeMaxChecksNeeded
+	if (chunkCapacity > SIZE_MAX / array->elementSize_r) {
+		HbReport_Crash("Too large chunks of %zu elements of size %zu requested for the paged array created at %s:%u.",
+		               chunkCapacity, array->elementSize_r, array->chunks_i.originNameImmutable_r, array->chunks_i.originLocation_r);
+	}
+	#endif
+	size_t const chunkSize = array->elementSize_r * chunkCapacity;
+	size_t chunkIndex = array->chunks_i.count_r;
+	// Only the list of the chunks is reallocated, not the chunks themselves.
+	HbMem_DynArray_ResizeForGrowing(&array->chunks_i, chunkCount);
+	void * * const chunks = (void * *) array->chunks_i.data_r;
+	for (; chunkIndex < chunkCount; ++chunkIndex) {
+		if (array->fibAlloc_e != NULL) {
+			size_t const unitCount = (chunkSize + (array->poolUnitSize_r - 1)) / array->poolUnitSize_r;
+			size_t const allocation = HbMem_FibAlloc_Alloc(array->fibAlloc_e, unitCount, unitCount, NULL);
+			if (allocation == HbMem_FibAlloc_Alloc_Failed) {
+				HbReport_Crash("Failed to allocate a chunk of %zu units of size %zu for the paged array created at %s:%u.",
+				               unitCount, array->poolUnitSize_r, array->chunks_i.originNameImmutable_r, array->chunks_i.originLocation_r);
+			}
+			chunks[chunkIndex] = array->poolMemory_e + array->poolUnitSize_r * allocation;
+		} else {
+			chunks[chunkIndex] = HbMem_Tag_AllocExplicit(array->chunks_i.tag_e, chunkSize, HbTrue,
+			                                             array->chunks_i.originNameImmutable_r, array->chunks_i.originLocation_r);
+		}
+	}
+	array->capacity_r = chunkCount << array->chunkCapacityLog2_r;
+}
+
+void HbMem_PagedArray_TrimCapacity(HbMem_PagedArray * const array) {
+	HbReport_Assert_Assume(array != NULL);
+	size_t const usedChunkCount = HbMem_PagedArray_GetUsedChunkCount(array);
+	void * const * const chunks = (void * const *) array->chunks_i.data_r;
+	for (size_t chunkIndex = usedChunkCount; chunkIndex < array->chunks_i.count_r; ++chunkIndex) {
+		HbMem_PagedArray_FreeChunk_i(array, chunks[chunkIndex]);
+	}
+	HbMem_DynArray_ResizeExactly(&array->chunks_i, usedChunkCount, HbTrue);
+	array->capacity_r = usedChunkCount << array->chunkCapacityLog2_r;
+}
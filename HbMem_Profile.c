@@ -0,0 +1,229 @@
+#include "HbMem.h"
+#include "HbPara.h"
+#include "HbReport.h"
+#include "HbText.h"
+#include <math.h>
+#if defined(HbPlatform_OS_Microsoft)
+#include <Windows.h>
+#include <TlHelp32.h>
+#endif
+
+size_t volatile HbMem_Profile_SamplingInterval_i = 0;
+
+typedef struct HbMem_Profile_Sample_i {
+	struct HbMem_Profile_Sample_i * next_i;
+	void const * allocation_i;
+	size_t size_i;
+	size_t stackDepth_i;
+	void * stack_i[HbMem_Profile_MaxStackDepth];
+} HbMem_Profile_Sample_i;
+
+// Samples are allocated with the system allocator not to be tracked themselves.
+#define HbMem_Profile_SampleBucketCount 4096
+static HbPara_Spinlock HbMem_Profile_SampleLock_i; // Zero-initialized.
+static HbMem_Profile_Sample_i * HbMem_Profile_SampleBuckets_i[HbMem_Profile_SampleBucketCount]; // Lock HbMem_Profile_SampleLock_i.
+static size_t HbMem_Profile_SampleCount_i; // Lock HbMem_Profile_SampleLock_i.
+
+static HbThreadLocal size_t HbMem_Profile_ThreadBytesUntilSample_i = 0;
+static HbThreadLocal uint64_t HbMem_Profile_ThreadRandom_i = 0; // xorshift64 state, seeded on the first sample.
+
+void HbMem_Profile_SetSamplingInterval(size_t const interval) {
+	// Threads pick the new interval up when their current countdown ends.
+	HbMem_Profile_SamplingInterval_i = interval;
+}
+
+HbForceInline size_t HbMem_Profile_HashAllocation_i(void const * const allocation) {
+	// Allocations are at least HbPlatform_AllocAlignment-aligned.
+	return ((uintptr_t) allocation / HbPlatform_AllocAlignment) % HbMem_Profile_SampleBucketCount;
+}
+
+static size_t HbMem_Profile_GetNextSampleDistance_i(size_t const interval) {
+	// Exponentially distributed, so allocation patterns don't align with the sampling.
+	uint64_t random = HbMem_Profile_ThreadRandom_i;
+	if (random == 0) {
+		random = ((uint64_t) (uintptr_t) &HbMem_Profile_ThreadRandom_i * UINT64_C(0x9E3779B97F4A7C15)) | 1;
+	}
+	random ^= random << 13;
+	random ^= random >> 7;
+	random ^= random << 17;
+	HbMem_Profile_ThreadRandom_i = random;
+	double const uniform = ((double) (random >> 11) + 1.0) * (1.0 / 9007199254740992.0); // (0, 1].
+	double const distance = -log(uniform) * (double) interval;
+	return distance < (double) SIZE_MAX ? (size_t) distance + 1 : SIZE_MAX;
+}
+
+HbBool HbMem_Profile_ShouldSample_i(size_t const size) {
+	size_t bytesUntilSample = HbMem_Profile_ThreadBytesUntilSample_i;
+	if (size < bytesUntilSample) {
+		HbMem_Profile_ThreadBytesUntilSample_i = bytesUntilSample - size;
+		return HbFalse;
+	}
+	size_t const interval = HbMem_Profile_SamplingInterval_i;
+	if (interval == 0) {
+		return HbFalse;
+	}
+	if (bytesUntilSample == 0) {
+		// First allocation on this thread - not sampling it unconditionally.
+		bytesUntilSample = HbMem_Profile_GetNextSampleDistance_i(interval);
+		if (size < bytesUntilSample) {
+			HbMem_Profile_ThreadBytesUntilSample_i = bytesUntilSample - size;
+			return HbFalse;
+		}
+	}
+	HbMem_Profile_ThreadBytesUntilSample_i = HbMem_Profile_GetNextSampleDistance_i(interval);
+	return HbTrue;
+}
+
+HbBool HbMem_Profile_AddSample_i(void const * const allocation, size_t const size) {
+	HbReport_Assert_Assume(allocation != NULL);
+	HbMem_Profile_Sample_i * const sample = (HbMem_Profile_Sample_i *) malloc(sizeof(HbMem_Profile_Sample_i));
+	if (sample == NULL) {
+		return HbFalse;
+	}
+	sample->allocation_i = allocation;
+	sample->size_i = size;
+	// Skipping this function and the tagged allocation function.
+	#if defined(HbPlatform_OS_Microsoft)
+	sample->stackDepth_i = RtlCaptureStackBackTrace(2, HbMem_Profile_MaxStackDepth, sample->stack_i, NULL);
+	#else
+	#error HbMem_Profile_AddSample_i: No stack trace implementation for the target OS.
+	#endif
+	HbMem_Profile_Sample_i * * const bucket = &HbMem_Profile_SampleBuckets_i[HbMem_Profile_HashAllocation_i(allocation)];
+	HbPara_Spinlock_Lock(&HbMem_Profile_SampleLock_i);
+	sample->next_i = *bucket;
+	*bucket = sample;
+	++HbMem_Profile_SampleCount_i;
+	HbPara_Spinlock_Unlock(&HbMem_Profile_SampleLock_i);
+	return HbTrue;
+}
+
+HbMem_Profile_Sample_i * HbMem_Profile_DetachSample_i(void const * const allocation) {
+	HbReport_Assert_Assume(allocation != NULL);
+	HbMem_Profile_Sample_i * * sampleLink = &HbMem_Profile_SampleBuckets_i[HbMem_Profile_HashAllocation_i(allocation)];
+	HbPara_Spinlock_Lock(&HbMem_Profile_SampleLock_i);
+	HbMem_Profile_Sample_i * sample;
+	for (sample = *sampleLink; sample != NULL; sampleLink = &sample->next_i, sample = sample->next_i) {
+		if (sample->allocation_i == allocation) {
+			*sampleLink = sample->next_i;
+			--HbMem_Profile_SampleCount_i;
+			break;
+		}
+	}
+	HbPara_Spinlock_Unlock(&HbMem_Profile_SampleLock_i);
+	return sample;
+}
+
+void HbMem_Profile_AttachSample_i(HbMem_Profile_Sample_i * const sample) {
+	HbReport_Assert_Assume(sample != NULL);
+	HbMem_Profile_Sample_i * * const bucket = &HbMem_Profile_SampleBuckets_i[HbMem_Profile_HashAllocation_i(sample->allocation_i)];
+	HbPara_Spinlock_Lock(&HbMem_Profile_SampleLock_i);
+	sample->next_i = *bucket;
+	*bucket = sample;
+	++HbMem_Profile_SampleCount_i;
+	HbPara_Spinlock_Unlock(&HbMem_Profile_SampleLock_i);
+}
+
+void HbMem_Profile_FreeDetachedSample_i(HbMem_Profile_Sample_i * const sample) {
+	free(sample); // NULL if the sample was not found, which is fine.
+}
+
+void HbMem_Profile_RemoveSample_i(void const * const allocation) {
+	HbMem_Profile_FreeDetachedSample_i(HbMem_Profile_DetachSample_i(allocation));
+}
+
+static int HbMem_Profile_CompareSampleStacks_i(void const * const aPointer, void const * const bPointer) {
+	HbMem_Profile_Sample_i const * const a = (HbMem_Profile_Sample_i const *) aPointer;
+	HbMem_Profile_Sample_i const * const b = (HbMem_Profile_Sample_i const *) bPointer;
+	if (a->stackDepth_i != b->stackDepth_i) {
+		return a->stackDepth_i < b->stackDepth_i ? -1 : 1;
+	}
+	for (size_t frameIndex = 0; frameIndex < a->stackDepth_i; ++frameIndex) {
+		if (a->stack_i[frameIndex] != b->stack_i[frameIndex]) {
+			return (uintptr_t) a->stack_i[frameIndex] < (uintptr_t) b->stack_i[frameIndex] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+// Long enough for a line with HbMem_Profile_MaxStackDepth frames, or a module path.
+#define HbMem_Profile_LineBufferSize 1024
+
+HbBool HbMem_Profile_WriteHeapProfile(HbMem_WriteCallback const write, void * const userData) {
+	HbReport_Assert_Assume(write != NULL);
+
+	// Copying the samples not to stall allocations while writing.
+	HbPara_Spinlock_Lock(&HbMem_Profile_SampleLock_i);
+	size_t const sampleCount = HbMem_Profile_SampleCount_i;
+	HbMem_Profile_Sample_i * const samples = (HbMem_Profile_Sample_i *) malloc(HbMath_Max_Size(sampleCount, 1) * sizeof(HbMem_Profile_Sample_i));
+	if (samples == NULL) {
+		HbPara_Spinlock_Unlock(&HbMem_Profile_SampleLock_i);
+		return HbFalse;
+	}
+	size_t copiedSampleCount = 0;
+	for (size_t bucketIndex = 0; bucketIndex < HbMem_Profile_SampleBucketCount; ++bucketIndex) {
+		HbMem_Profile_Sample_i const * sample;
+		for (sample = HbMem_Profile_SampleBuckets_i[bucketIndex]; sample != NULL; sample = sample->next_i) {
+			samples[copiedSampleCount++] = *sample;
+		}
+	}
+	HbPara_Spinlock_Unlock(&HbMem_Profile_SampleLock_i);
+	HbReport_Assert_Assume(copiedSampleCount == sampleCount);
+
+	// Grouping the samples with the same stack.
+	qsort(samples, sampleCount, sizeof(HbMem_Profile_Sample_i), HbMem_Profile_CompareSampleStacks_i);
+	size_t totalSize = 0;
+	for (size_t sampleIndex = 0; sampleIndex < sampleCount; ++sampleIndex) {
+		totalSize += samples[sampleIndex].size_i;
+	}
+
+	char line[HbMem_Profile_LineBufferSize];
+	// Only live samples are tracked, so the allocated totals are the same as the in-use ones.
+	size_t lineLength = HbTextA_Format(line, sizeof(line), 0, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n",
+	                                   sampleCount, totalSize, sampleCount, totalSize, (size_t) HbMem_Profile_SamplingInterval_i);
+	HbBool written = write(line, lineLength, userData);
+	size_t groupStart = 0;
+	while (written && groupStart < sampleCount) {
+		HbMem_Profile_Sample_i const * const groupSample = &samples[groupStart];
+		size_t groupEnd = groupStart + 1, groupSize = groupSample->size_i;
+		while (groupEnd < sampleCount && HbMem_Profile_CompareSampleStacks_i(groupSample, &samples[groupEnd]) == 0) {
+			groupSize += samples[groupEnd++].size_i;
+		}
+		lineLength = HbTextA_Format(line, sizeof(line), 0, "%zu: %zu [%zu: %zu] @",
+		                            groupEnd - groupStart, groupSize, groupEnd - groupStart, groupSize);
+		for (size_t frameIndex = 0; frameIndex < groupSample->stackDepth_i; ++frameIndex) {
+			lineLength += HbTextA_Format(line, sizeof(line), lineLength, " 0x%zx", (size_t) (uintptr_t) groupSample->stack_i[frameIndex]);
+		}
+		lineLength += HbTextA_Format(line, sizeof(line), lineLength, "\n");
+		written = write(line, lineLength, userData);
+		groupStart = groupEnd;
+	}
+	free(samples);
+
+	// Modules in the /proc/self/maps format for symbolization.
+	if (written) {
+		static char const mappedLibrariesHeader[] = "\nMAPPED_LIBRARIES:\n";
+		written = write(mappedLibrariesHeader, sizeof(mappedLibrariesHeader) - 1, userData);
+	}
+	#if defined(HbPlatform_OS_Microsoft)
+	HANDLE const moduleSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE, 0);
+	if (moduleSnapshot != INVALID_HANDLE_VALUE) {
+		// Wide names regardless of the character set of the build, converted to UTF-8.
+		MODULEENTRY32W moduleEntry;
+		moduleEntry.dwSize = sizeof(moduleEntry);
+		BOOL moduleFound;
+		for (moduleFound = Module32FirstW(moduleSnapshot, &moduleEntry); written && moduleFound; moduleFound = Module32NextW(moduleSnapshot, &moduleEntry)) {
+			uintptr_t const moduleStart = (uintptr_t) moduleEntry.modBaseAddr;
+			lineLength = HbTextA_Format(line, sizeof(line), 0, "%zx-%zx r-xp 00000000 00:00 0 ",
+			                            (size_t) moduleStart, (size_t) (moduleStart + moduleEntry.modBaseSize));
+			// Leaving space for the line break and the terminator.
+			lineLength += HbTextU8_FromU16(line, sizeof(line) - 2, lineLength, (HbTextU16 const *) moduleEntry.szExePath, HbFalse);
+			lineLength += HbTextA_Format(line, sizeof(line), lineLength, "\n");
+			written = write(line, lineLength, userData);
+		}
+		CloseHandle(moduleSnapshot);
+	}
+	#else
+	#error HbMem_Profile_WriteHeapProfile: No module enumeration implementation for the target OS.
+	#endif
+	return written;
+}
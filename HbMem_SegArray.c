@@ -0,0 +1,126 @@
+#include "HbMath.h"
+#include "HbMem.h"
+#include "HbPara.h"
+#include "HbReport.h"
+
+void HbMem_SegArray_InitExplicit(HbMem_SegArray * const array, size_t const elementSize, size_t const firstSegmentCapacity,
+                                 HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(elementSize != 0);
+	array->elementSize_r = elementSize;
+	size_t const neededFirstSegmentCapacity = HbMath_Max_Size(
+		firstSegmentCapacity != 0 ? firstSegmentCapacity : HbMem_SegArray_DefaultFirstSegmentSize / elementSize, HbMem_SegArray_MinFirstSegmentCapacity);
+	// Rounding up to a power of two.
+	array->firstSegmentCapacityLog2_r = HbPlatform_CPU_Bits - HbMath_CountLeadingZeros_Size(neededFirstSegmentCapacity - 1);
+	array->tag_e = tag;
+	array->originNameImmutable_r = originNameImmutable;
+	array->originLocation_r = originLocation;
+	for (unsigned segmentIndex = 0; segmentIndex < HbCountOf(array->segments_i); ++segmentIndex) {
+		array->segments_i[segmentIndex] = NULL;
+	}
+	array->reservedCount_i = 0;
+	array->publishedCount_r = 0;
+}
+
+void HbMem_SegArray_Shutdown(HbMem_SegArray * const array) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Checked(array->publishedCount_r == array->reservedCount_i && "Appending is still in progress.");
+	for (unsigned segmentIndex = 0; segmentIndex < HbCountOf(array->segments_i); ++segmentIndex) {
+		if (array->segments_i[segmentIndex] != NULL) {
+			HbMem_Tag_Free(array->segments_i[segmentIndex]);
+			array->segments_i[segmentIndex] = NULL;
+		}
+	}
+	array->reservedCount_i = 0;
+	array->publishedCount_r = 0;
+}
+
+static HbByte * HbMem_SegArray_GetSegmentForWriting_i(HbMem_SegArray * const array, unsigned const segmentIndex) {
+	HbByte * const segment = array->segments_i[segmentIndex];
+	if (segment != NULL) {
+		return segment;
+	}
+	// Threads appending to a new segment at the same time all allocate it, and all but one free theirs.
+	size_t const flagsOffset = HbMem_SegArray_GetSegmentFlagsOffset_i(array, segmentIndex);
+	size_t const flagsSize = sizeof(uint32_t) * (HbMem_SegArray_GetSegmentCapacity_i(array, segmentIndex) / 32);
+	HbByte * const newSegment = (HbByte *) HbMem_Tag_AllocExplicit(array->tag_e, flagsOffset + flagsSize, HbTrue,
+	                                                               array->originNameImmutable_r, array->originLocation_r);
+	memset(newSegment + flagsOffset, 0, flagsSize);
+	HbByte * const previousSegment = (HbByte *) HbPara_Atomic_Pointer_CompareExchange((void * volatile *) &array->segments_i[segmentIndex], newSegment, NULL);
+	if (previousSegment != NULL) {
+		HbMem_Tag_Free(newSegment);
+		return previousSegment;
+	}
+	return newSegment;
+}
+
+HbForceInline uint32_t volatile * HbMem_SegArray_GetSegmentFlags_i(HbMem_SegArray const * const array, HbByte * const segment, unsigned const segmentIndex) {
+	return (uint32_t volatile *) (segment + HbMem_SegArray_GetSegmentFlagsOffset_i(array, segmentIndex));
+}
+
+// Moves the published count over the elements written after it. The thread that writes the element at the published count is the one that moves it,
+// unless another thread sees the flag first - setting the flag happens before checking the count, so one of them is guaranteed to see both.
+static void HbMem_SegArray_Publish_i(HbMem_SegArray * const array) {
+	for (;;) {
+		size_t const publishedCount = array->publishedCount_r;
+		size_t indexInSegment;
+		unsigned const segmentIndex = HbMem_SegArray_Locate_i(array, publishedCount, &indexInSegment);
+		HbByte * const segment = array->segments_i[segmentIndex];
+		if (segment == NULL) {
+			return;
+		}
+		uint32_t const flags = ~(HbMem_SegArray_GetSegmentFlags_i(array, segment, segmentIndex)[indexInSegment / 32] >> (indexInSegment % 32));
+		// The shifted-in high bits are 0, so not written, and the run ends at the end of the word.
+		size_t const writtenCount = flags != 0 ? HbMath_CountTrailingZeros_Size(flags) : 32;
+		if (writtenCount == 0) {
+			return;
+		}
+		HbPara_Atomic_Size_CompareExchange(&array->publishedCount_r, publishedCount + writtenCount, publishedCount);
+	}
+}
+
+// Copies the elements to the reserved range and marks them as written.
+static void HbMem_SegArray_Write_i(HbMem_SegArray * const array, size_t const firstIndex, HbByte const * elements, size_t const count) {
+	size_t const elementSize = array->elementSize_r;
+	size_t index = firstIndex, remainingCount = count;
+	while (remainingCount != 0) {
+		size_t indexInSegment;
+		unsigned const segmentIndex = HbMem_SegArray_Locate_i(array, index, &indexInSegment);
+		HbByte * const segment = HbMem_SegArray_GetSegmentForWriting_i(array, segmentIndex);
+		size_t const segmentCount = HbMath_Min_Size(HbMem_SegArray_GetSegmentCapacity_i(array, segmentIndex) - indexInSegment, remainingCount);
+		memcpy(segment + elementSize * indexInSegment, elements, elementSize * segmentCount);
+		// Atomic operations are full barriers, so the elements are written before the flags are visible.
+		uint32_t volatile * const flags = HbMem_SegArray_GetSegmentFlags_i(array, segment, segmentIndex);
+		size_t flagIndex = indexInSegment;
+		size_t const flagEnd = indexInSegment + segmentCount;
+		while (flagIndex < flagEnd) {
+			size_t const wordFlagCount = HbMath_Min_Size(32 - flagIndex % 32, flagEnd - flagIndex);
+			uint32_t const wordMask = (wordFlagCount < 32 ? (UINT32_C(1) << wordFlagCount) - 1 : UINT32_MAX) << (flagIndex % 32);
+			HbPara_Atomic_U32_Or(&flags[flagIndex / 32], wordMask);
+			flagIndex += wordFlagCount;
+		}
+		index += segmentCount;
+		elements += elementSize * segmentCount;
+		remainingCount -= segmentCount;
+	}
+	HbMem_SegArray_Publish_i(array);
+}
+
+size_t HbMem_SegArray_Append(HbMem_SegArray * const array, void const * const element) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(element != NULL);
+	size_t const index = HbPara_Atomic_Size_Add(&array->reservedCount_i, 1);
+	HbMem_SegArray_Write_i(array, index, (HbByte const *) element, 1);
+	return index;
+}
+
+size_t HbMem_SegArray_AppendRange(HbMem_SegArray * const array, void const * const elements, size_t const count) {
+	HbReport_Assert_Assume(array != NULL);
+	HbReport_Assert_Assume(elements != NULL || count == 0);
+	if (count == 0) {
+		return array->reservedCount_i;
+	}
+	size_t const firstIndex = HbPara_Atomic_Size_Add(&array->reservedCount_i, count);
+	HbMem_SegArray_Write_i(array, firstIndex, (HbByte const *) elements, count);
+	return firstIndex;
+}
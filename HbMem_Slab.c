@@ -0,0 +1,260 @@
+#include "HbMem.h"
+#include "HbPara.h"
+#include "HbReport.h"
+#if defined(HbPlatform_OS_Microsoft)
+#include <Windows.h>
+#endif
+
+size_t const HbMem_Slab_ClassSizes[HbMem_Slab_ClassCount] = {
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256,
+	320, 384, 448, 512,
+	640, 768, 896, 1024,
+};
+
+// Class for the size in 16-byte units, rounded up.
+static uint_least8_t const HbMem_Slab_ClassesBy16_i[HbMem_Slab_MaxSize / 16 + 1] = {
+	0, 0, 1, 2, 3, 4, 5, 6, 7,
+	8, 8, 9, 9, 10, 10, 11, 11,
+	12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15,
+	16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17, 17, 17, 17, 17, 17,
+	18, 18, 18, 18, 18, 18, 18, 18, 19, 19, 19, 19, 19, 19, 19, 19,
+};
+
+size_t HbMem_Slab_GetClass(size_t const size) {
+	if (size > HbMem_Slab_MaxSize) {
+		return HbMem_Slab_Class_None;
+	}
+	return HbMem_Slab_ClassesBy16_i[(size + 15) >> 4];
+}
+
+typedef struct HbMem_Slab_Span_i {
+	// The heap of the owner thread. Only changed when the span is empty, so other threads can read it to send blocks back.
+	struct HbMem_Slab_Heap_i * heap_i;
+	// In the list of spans with free blocks of the class in the heap (only full spans are not linked), or in the central pool.
+	struct HbMem_Slab_Span_i * prev_i;
+	struct HbMem_Slab_Span_i * next_i;
+	void * freeFirst_i; // Blocks freed by the owner or collected from other threads, linked through their first pointer.
+	size_t usedCount_i; // Including the blocks sent back by other threads but not collected yet.
+	size_t carvedCount_i; // Blocks after this have never been allocated, and are taken sequentially instead of being in freeFirst_i.
+	size_t blockCount_i;
+	size_t sizeClass_i;
+} HbMem_Slab_Span_i;
+#define HbMem_Slab_BlocksOffset_i (2 * HbPlatform_CacheLineSize)
+HbStaticAssert(sizeof(HbMem_Slab_Span_i) <= HbMem_Slab_BlocksOffset_i, "The span header must fit before the blocks.");
+
+typedef struct HbAligned(HbPlatform_CacheLineSize) HbMem_Slab_Heap_i {
+	HbMem_Slab_Span_i * availableSpans_i[HbMem_Slab_ClassCount];
+	struct HbMem_Slab_Heap_i * nextOrphan_i;
+	// Written by other threads, so on a separate cache line.
+	HbAligned(HbPlatform_CacheLineSize) void * volatile remoteFreeFirst_i;
+} HbMem_Slab_Heap_i;
+
+static HbThreadLocal HbMem_Slab_Heap_i * HbMem_Slab_ThreadHeap_i = NULL;
+
+// Empty spans are kept for reuse up to this count, the rest are released to the OS.
+#define HbMem_Slab_CentralMaxEmptySpans_i 64
+static HbPara_Spinlock HbMem_Slab_CentralLock_i;
+static HbMem_Slab_Span_i * HbMem_Slab_CentralEmptySpanFirst_i = NULL; // Lock HbMem_Slab_CentralLock_i.
+static size_t HbMem_Slab_CentralEmptySpanCount_i = 0; // Lock HbMem_Slab_CentralLock_i.
+static HbMem_Slab_Heap_i * HbMem_Slab_CentralOrphanHeapFirst_i = NULL; // Lock HbMem_Slab_CentralLock_i.
+
+static HbMem_Slab_Heap_i * HbMem_Slab_GetThreadHeap_i() {
+	HbMem_Slab_Heap_i * heap = HbMem_Slab_ThreadHeap_i;
+	if (heap != NULL) {
+		return heap;
+	}
+	// Take the heap of an exited thread if there is one to reuse its spans.
+	HbPara_Spinlock_Lock(&HbMem_Slab_CentralLock_i);
+	heap = HbMem_Slab_CentralOrphanHeapFirst_i;
+	if (heap != NULL) {
+		HbMem_Slab_CentralOrphanHeapFirst_i = heap->nextOrphan_i;
+	}
+	HbPara_Spinlock_Unlock(&HbMem_Slab_CentralLock_i);
+	if (heap == NULL) {
+		#if defined(HbPlatform_OS_Microsoft)
+		heap = (HbMem_Slab_Heap_i *) _aligned_malloc(sizeof(HbMem_Slab_Heap_i), HbPlatform_CacheLineSize);
+		#else
+		#error HbMem_Slab_GetThreadHeap_i: No aligned allocation implementation for the target OS.
+		#endif
+		if (heap == NULL) {
+			HbReport_Crash("Failed to allocate memory for a small object allocator thread heap.");
+		}
+		memset(heap, 0, sizeof(HbMem_Slab_Heap_i));
+	}
+	HbMem_Slab_ThreadHeap_i = heap;
+	return heap;
+}
+
+static void HbMem_Slab_LinkAvailableSpan_i(HbMem_Slab_Heap_i * const heap, HbMem_Slab_Span_i * const span) {
+	HbReport_Assert_Assume(heap != NULL);
+	HbReport_Assert_Assume(span != NULL);
+	HbMem_Slab_Span_i * * const availableFirst = &heap->availableSpans_i[span->sizeClass_i];
+	span->prev_i = NULL;
+	span->next_i = *availableFirst;
+	if (*availableFirst != NULL) {
+		(*availableFirst)->prev_i = span;
+	}
+	*availableFirst = span;
+}
+
+static void HbMem_Slab_UnlinkAvailableSpan_i(HbMem_Slab_Heap_i * const heap, HbMem_Slab_Span_i * const span) {
+	HbReport_Assert_Assume(heap != NULL);
+	HbReport_Assert_Assume(span != NULL);
+	if (span->prev_i != NULL) {
+		span->prev_i->next_i = span->next_i;
+	} else {
+		HbReport_Assert_Assume(heap->availableSpans_i[span->sizeClass_i] == span);
+		heap->availableSpans_i[span->sizeClass_i] = span->next_i;
+	}
+	if (span->next_i != NULL) {
+		span->next_i->prev_i = span->prev_i;
+	}
+}
+
+static HbMem_Slab_Span_i * HbMem_Slab_AcquireSpan_i(HbMem_Slab_Heap_i * const heap, size_t const sizeClass) {
+	HbReport_Assert_Assume(heap != NULL);
+	HbReport_Assert_Assume(sizeClass < HbMem_Slab_ClassCount);
+	HbPara_Spinlock_Lock(&HbMem_Slab_CentralLock_i);
+	HbMem_Slab_Span_i * span = HbMem_Slab_CentralEmptySpanFirst_i;
+	if (span != NULL) {
+		HbMem_Slab_CentralEmptySpanFirst_i = span->next_i;
+		--HbMem_Slab_CentralEmptySpanCount_i;
+	}
+	HbPara_Spinlock_Unlock(&HbMem_Slab_CentralLock_i);
+	if (span == NULL) {
+		#if defined(HbPlatform_OS_Microsoft)
+		// The allocation granularity on Windows is 64 KiB, so the span is aligned to its size.
+		span = (HbMem_Slab_Span_i *) VirtualAlloc(NULL, HbMem_Slab_SpanSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		#else
+		#error HbMem_Slab_AcquireSpan_i: No implementation for the target OS.
+		#endif
+		if (span == NULL) {
+			return NULL;
+		}
+		HbReport_Assert_Checked(((uintptr_t) span & (HbMem_Slab_SpanSize - 1)) == 0);
+	}
+	span->heap_i = heap;
+	span->freeFirst_i = NULL;
+	span->usedCount_i = 0;
+	span->carvedCount_i = 0;
+	span->blockCount_i = (HbMem_Slab_SpanSize - HbMem_Slab_BlocksOffset_i) / HbMem_Slab_ClassSizes[sizeClass];
+	span->sizeClass_i = sizeClass;
+	HbMem_Slab_LinkAvailableSpan_i(heap, span);
+	return span;
+}
+
+static void HbMem_Slab_ReleaseSpan_i(HbMem_Slab_Span_i * const span) {
+	HbReport_Assert_Assume(span != NULL);
+	HbReport_Assert_Assume(span->usedCount_i == 0);
+	HbPara_Spinlock_Lock(&HbMem_Slab_CentralLock_i);
+	if (HbMem_Slab_CentralEmptySpanCount_i < HbMem_Slab_CentralMaxEmptySpans_i) {
+		span->next_i = HbMem_Slab_CentralEmptySpanFirst_i;
+		HbMem_Slab_CentralEmptySpanFirst_i = span;
+		++HbMem_Slab_CentralEmptySpanCount_i;
+		HbPara_Spinlock_Unlock(&HbMem_Slab_CentralLock_i);
+		return;
+	}
+	HbPara_Spinlock_Unlock(&HbMem_Slab_CentralLock_i);
+	#if defined(HbPlatform_OS_Microsoft)
+	VirtualFree(span, 0, MEM_RELEASE);
+	#else
+	#error HbMem_Slab_ReleaseSpan_i: No implementation for the target OS.
+	#endif
+}
+
+HbForceInline HbMem_Slab_Span_i * HbMem_Slab_GetBlockSpan_i(void * const block) {
+	HbReport_Assert_Assume(block != NULL);
+	return (HbMem_Slab_Span_i *) ((uintptr_t) block & ~((uintptr_t) HbMem_Slab_SpanSize - 1));
+}
+
+static void HbMem_Slab_FreeOwned_i(HbMem_Slab_Heap_i * const heap, void * const block) {
+	HbReport_Assert_Assume(heap != NULL);
+	HbMem_Slab_Span_i * const span = HbMem_Slab_GetBlockSpan_i(block);
+	HbReport_Assert_Assume(span->heap_i == heap);
+	HbReport_Assert_Assume(span->usedCount_i != 0);
+	*((void * *) block) = span->freeFirst_i;
+	span->freeFirst_i = block;
+	if (span->usedCount_i-- == span->blockCount_i) {
+		HbMem_Slab_LinkAvailableSpan_i(heap, span);
+	}
+	// Keep the only span of the class not to acquire and release it repeatedly when allocating and freeing one block.
+	if (span->usedCount_i == 0 && (span->prev_i != NULL || span->next_i != NULL)) {
+		HbMem_Slab_UnlinkAvailableSpan_i(heap, span);
+		HbMem_Slab_ReleaseSpan_i(span);
+	}
+}
+
+static void HbMem_Slab_CollectRemoteFrees_i(HbMem_Slab_Heap_i * const heap) {
+	HbReport_Assert_Assume(heap != NULL);
+	if (heap->remoteFreeFirst_i == NULL) {
+		return;
+	}
+	void * block = HbPara_Atomic_Pointer_Exchange(&heap->remoteFreeFirst_i, NULL);
+	while (block != NULL) {
+		void * const nextBlock = *((void * *) block);
+		HbMem_Slab_FreeOwned_i(heap, block);
+		block = nextBlock;
+	}
+}
+
+void * HbMem_Slab_Alloc(size_t const sizeClass) {
+	HbReport_Assert_Assume(sizeClass < HbMem_Slab_ClassCount);
+	HbMem_Slab_Heap_i * const heap = HbMem_Slab_GetThreadHeap_i();
+	HbMem_Slab_Span_i * span = heap->availableSpans_i[sizeClass];
+	if (span == NULL) {
+		// Only take blocks sent back by other threads when out of free blocks to do it in batches.
+		HbMem_Slab_CollectRemoteFrees_i(heap);
+		span = heap->availableSpans_i[sizeClass];
+		if (span == NULL) {
+			span = HbMem_Slab_AcquireSpan_i(heap, sizeClass);
+			if (span == NULL) {
+				return NULL;
+			}
+		}
+	}
+	void * block = span->freeFirst_i;
+	if (block != NULL) {
+		span->freeFirst_i = *((void * *) block);
+	} else {
+		HbReport_Assert_Assume(span->carvedCount_i < span->blockCount_i);
+		block = (HbByte *) span + HbMem_Slab_BlocksOffset_i + HbMem_Slab_ClassSizes[sizeClass] * span->carvedCount_i++;
+	}
+	if (++span->usedCount_i == span->blockCount_i) {
+		HbMem_Slab_UnlinkAvailableSpan_i(heap, span);
+	}
+	return block;
+}
+
+void HbMem_Slab_Free(void * const block) {
+	HbReport_Assert_Assume(block != NULL);
+	HbMem_Slab_Heap_i * const heap = HbMem_Slab_GetBlockSpan_i(block)->heap_i;
+	if (heap == HbMem_Slab_ThreadHeap_i) {
+		HbMem_Slab_FreeOwned_i(heap, block);
+		return;
+	}
+	// Send the block back to the owner thread.
+	void * remoteFreeFirst = heap->remoteFreeFirst_i;
+	for (;;) {
+		*((void * *) block) = remoteFreeFirst;
+		void * const previousRemoteFreeFirst = HbPara_Atomic_Pointer_CompareExchange(&heap->remoteFreeFirst_i, block, remoteFreeFirst);
+		if (previousRemoteFreeFirst == remoteFreeFirst) {
+			break;
+		}
+		remoteFreeFirst = previousRemoteFreeFirst;
+	}
+}
+
+void HbMem_Slab_Thread_Shutdown() {
+	HbMem_Slab_Heap_i * const heap = HbMem_Slab_ThreadHeap_i;
+	if (heap == NULL) {
+		return;
+	}
+	HbMem_Slab_CollectRemoteFrees_i(heap);
+	HbMem_Slab_ThreadHeap_i = NULL;
+	// Blocks still in use will be sent to the heap as remote frees until another thread takes it.
+	HbPara_Spinlock_Lock(&HbMem_Slab_CentralLock_i);
+	heap->nextOrphan_i = HbMem_Slab_CentralOrphanHeapFirst_i;
+	HbMem_Slab_CentralOrphanHeapFirst_i = heap;
+	HbPara_Spinlock_Unlock(&HbMem_Slab_CentralLock_i);
+}
@@ -0,0 +1,80 @@
+#include "HbMem.h"
+#include "HbReport.h"
+
+void HbMem_SlotMap_InitExplicit(HbMem_SlotMap * const map, size_t const elementSize, size_t const alignment,
+                                HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(map != NULL);
+	HbMem_DynArray_InitExplicit(&map->values_r, elementSize, alignment, tag, originNameImmutable, originLocation);
+	HbMem_DynArray_InitExplicit(&map->denseSlots_i, sizeof(uint32_t), HbPlatform_AllocAlignment, tag, originNameImmutable, originLocation);
+	HbMem_DynArray_InitExplicit(&map->slots_i, sizeof(HbMem_SlotMap_Slot_i), HbPlatform_AllocAlignment, tag, originNameImmutable, originLocation);
+	map->freeSlotFirst_i = HbMem_SlotMap_NoFreeSlot_i;
+}
+
+void HbMem_SlotMap_Shutdown(HbMem_SlotMap * const map) {
+	HbReport_Assert_Assume(map != NULL);
+	HbMem_DynArray_Shutdown(&map->slots_i);
+	HbMem_DynArray_Shutdown(&map->denseSlots_i);
+	HbMem_DynArray_Shutdown(&map->values_r);
+}
+
+HbForceInline void HbMem_SlotMap_FreeSlot_i(HbMem_SlotMap * const map, uint32_t const slotIndex) {
+	HbMem_SlotMap_Slot_i * const slot = (HbMem_SlotMap_Slot_i *) map->slots_i.data_r + slotIndex;
+	if (++slot->generation_i == 0) {
+		slot->generation_i = 1;
+	}
+	slot->denseIndexOrNextFree_i = map->freeSlotFirst_i;
+	map->freeSlotFirst_i = slotIndex;
+}
+
+void HbMem_SlotMap_Clear(HbMem_SlotMap * const map) {
+	HbReport_Assert_Assume(map != NULL);
+	uint32_t const * const denseSlots = (uint32_t const *) map->denseSlots_i.data_r;
+	for (size_t denseIndex = 0; denseIndex < map->denseSlots_i.count_r; ++denseIndex) {
+		HbMem_SlotMap_FreeSlot_i(map, denseSlots[denseIndex]);
+	}
+	HbMem_DynArray_RemoveFromEnd(&map->values_r, map->values_r.count_r);
+	HbMem_DynArray_RemoveFromEnd(&map->denseSlots_i, map->denseSlots_i.count_r);
+}
+
+void * HbMem_SlotMap_Insert(HbMem_SlotMap * const map, HbMem_SlotMap_Handle * const handleOut) {
+	HbReport_Assert_Assume(map != NULL);
+	HbReport_Assert_Assume(handleOut != NULL);
+	uint32_t slotIndex = map->freeSlotFirst_i;
+	HbMem_SlotMap_Slot_i * slot;
+	if (slotIndex != HbMem_SlotMap_NoFreeSlot_i) {
+		slot = (HbMem_SlotMap_Slot_i *) map->slots_i.data_r + slotIndex;
+		map->freeSlotFirst_i = slot->denseIndexOrNextFree_i;
+	} else {
+		if (map->slots_i.count_r >= HbMem_SlotMap_MaxCount) {
+			HbReport_Crash("Too many values (%zu) in the slot map created at %s:%u.",
+			               map->slots_i.count_r, map->values_r.originNameImmutable_r, map->values_r.originLocation_r);
+		}
+		slotIndex = (uint32_t) HbMem_DynArray_Append(&map->slots_i, 1);
+		slot = (HbMem_SlotMap_Slot_i *) map->slots_i.data_r + slotIndex;
+		slot->generation_i = 1;
+	}
+	size_t const denseIndex = HbMem_DynArray_Append(&map->values_r, 1);
+	slot->denseIndexOrNextFree_i = (uint32_t) denseIndex;
+	HbMem_DynArray_Append(&map->denseSlots_i, 1);
+	((uint32_t *) map->denseSlots_i.data_r)[denseIndex] = slotIndex;
+	*handleOut = HbMem_SlotMap_Handle_Make(slotIndex, slot->generation_i);
+	return (HbByte *) map->values_r.data_r + map->values_r.elementSize_r * denseIndex;
+}
+
+HbBool HbMem_SlotMap_Remove(HbMem_SlotMap * const map, HbMem_SlotMap_Handle const handle) {
+	size_t const denseIndex = HbMem_SlotMap_GetDenseIndex(map, handle);
+	if (denseIndex == SIZE_MAX) {
+		return HbFalse;
+	}
+	uint32_t * const denseSlots = (uint32_t *) map->denseSlots_i.data_r;
+	size_t const lastDenseIndex = map->values_r.count_r - 1;
+	if (denseIndex != lastDenseIndex) {
+		uint32_t const movedSlotIndex = denseSlots[lastDenseIndex];
+		((HbMem_SlotMap_Slot_i *) map->slots_i.data_r)[movedSlotIndex].denseIndexOrNextFree_i = (uint32_t) denseIndex;
+		denseSlots[denseIndex] = movedSlotIndex;
+	}
+	HbMem_DynArray_RemoveFromUnsorted(&map->values_r, denseIndex, 1);
+	HbMem_DynArray_RemoveFromEnd(&map->denseSlots_i, 1);
+	HbMem_SlotMap_FreeSlot_i(map, HbMem_SlotMap_Handle_GetSlotIndex(handle));
+	return HbTrue;
+}
@@ -0,0 +1,78 @@
+#include "HbMath.h"
+#include "HbMem.h"
+#include "HbReport.h"
+
+void HbMem_SoA_InitExplicit(HbMem_SoA * const soa, size_t const * const columnElementSizes, size_t const columnCount, size_t const alignment,
+                            HbMem_Tag * const tag, char const * const originNameImmutable, unsigned const originLocation) {
+	HbReport_Assert_Assume(soa != NULL);
+	HbReport_Assert_Assume(columnElementSizes != NULL);
+	HbReport_Assert_Assume(columnCount != 0 && columnCount <= HbMem_SoA_MaxColumns);
+	HbReport_Assert_Assume(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	soa->columnCount_r = columnCount;
+	soa->rowSize_r = 0;
+	for (size_t columnIndex = 0; columnIndex < columnCount; ++columnIndex) {
+		HbReport_Assert_Assume(columnElementSizes[columnIndex] != 0);
+		soa->columns_r[columnIndex] = NULL;
+		soa->columnElementSizes_r[columnIndex] = columnElementSizes[columnIndex];
+		soa->rowSize_r += columnElementSizes[columnIndex];
+	}
+	soa->count_r = 0;
+	soa->capacity_r = 0;
+	soa->alignment_r = alignment;
+	soa->tag_e = tag;
+	soa->originNameImmutable_r = originNameImmutable;
+	soa->originLocation_r = originLocation;
+}
+
+void HbMem_SoA_Shutdown(HbMem_SoA * const soa) {
+	HbReport_Assert_Assume(soa != NULL);
+	if (soa->capacity_r != 0) {
+		for (size_t columnIndex = 0; columnIndex < soa->columnCount_r; ++columnIndex) {
+			HbMem_Tag_Free(soa->columns_r[columnIndex]);
+		}
+	}
+}
+
+void HbMem_SoA_ReserveExactly(HbMem_SoA * const soa, size_t const capacity, HbBool const trim) {
+	HbReport_Assert_Assume(soa != NULL);
+	size_t const neededCapacity = HbMath_Align_Size(HbMath_Max_Size(capacity, soa->count_r), HbMem_SoA_CapacityGranularity);
+	if (neededCapacity == soa->capacity_r || (!trim && neededCapacity < soa->capacity_r)) {
+		return;
+	}
+	#ifdef HbMem_SizeMaxChecksNeeded
+	// Also catches wrapping around by the alignment.
+	size_t const maxCapacity = SIZE_MAX / soa->rowSize_r;
+	if (neededCapacity > maxCapacity || neededCapacity < capacity) {
+		HbReport_Crash("Too many rows of size %zu requested (%zu, max %zu) for the struct-of-arrays created at %s:%u.",
+		               soa->rowSize_r, capacity, maxCapacity, soa->originNameImmutable_r, soa->originLocation_r);
+	}
+	#endif
+	for (size_t columnIndex = 0; columnIndex < soa->columnCount_r; ++columnIndex) {
+		size_t const elementSize = soa->columnElementSizes_r[columnIndex];
+		if (soa->capacity_r == 0) {
+			soa->columns_r[columnIndex] = HbMem_Tag_AllocAlignedElementsExplicit(soa->tag_e, elementSize, neededCapacity, soa->alignment_r, HbTrue,
+			                                                                     soa->originNameImmutable_r, soa->originLocation_r);
+		} else if (neededCapacity == 0) {
+			HbMem_Tag_Free(soa->columns_r[columnIndex]);
+			soa->columns_r[columnIndex] = NULL;
+		} else {
+			// Reallocation keeps the alignment.
+			HbMem_Tag_ReallocElementsExplicit(&soa->columns_r[columnIndex], elementSize, neededCapacity, HbTrue);
+		}
+	}
+	soa->capacity_r = neededCapacity;
+}
+
+void HbMem_SoA_RemoveFromUnsorted(HbMem_SoA * const soa, size_t const index) {
+	HbReport_Assert_Assume(soa != NULL);
+	HbReport_Assert_Assume(index < soa->count_r);
+	size_t const lastIndex = --soa->count_r;
+	if (index == lastIndex) {
+		return;
+	}
+	for (size_t columnIndex = 0; columnIndex < soa->columnCount_r; ++columnIndex) {
+		size_t const elementSize = soa->columnElementSizes_r[columnIndex];
+		HbByte * const column = (HbByte *) soa->columns_r[columnIndex];
+		memcpy(column + elementSize * index, column + elementSize * lastIndex, elementSize);
+	}
+}
@@ -0,0 +1,21 @@
+#include "HbMem.hpp"
+
+// Explicit instantiations, so the templates of HbMem.hpp are compiled with the library, not only in the projects using them.
+
+namespace HbMem {
+
+// Not trivially copyable or destructible, so elements are constructed, moved and destroyed one by one rather than reallocated.
+struct NonTrivialElement_i {
+	uint32_t * value_i;
+	NonTrivialElement_i() : value_i(NULL) {}
+	NonTrivialElement_i(NonTrivialElement_i const & source) : value_i(source.value_i) {}
+	NonTrivialElement_i(NonTrivialElement_i && source) : value_i(source.value_i) { source.value_i = NULL; }
+	NonTrivialElement_i & operator=(NonTrivialElement_i const & source) { value_i = source.value_i; return *this; }
+	NonTrivialElement_i & operator=(NonTrivialElement_i && source) { value_i = source.value_i; source.value_i = NULL; return *this; }
+	~NonTrivialElement_i() { value_i = NULL; }
+};
+
+template class DynArray<uint32_t>;
+template class DynArray<NonTrivialElement_i>;
+
+}
@@ -8,6 +8,102 @@
 extern "C" {
 #endif
 
+/**********************************************************
+ * Atomic operations
+ * Full memory barriers, returning the value before the operation
+ **********************************************************/
+HbForceInline uint32_t HbPara_Atomic_U32_Add(uint32_t volatile * const target, uint32_t const value) {
+	HbReport_Assert_Assume(target != NULL);
+	#if defined(HbPlatform_OS_Microsoft)
+	return (uint32_t) InterlockedExchangeAdd((LONG volatile *) target, (LONG) value);
+	#else
+	#error HbPara_Atomic_U32_Add: No implementation for the target OS.
+	#endif
+}
+HbForceInline uint32_t HbPara_Atomic_U32_Exchange(uint32_t volatile * const target, uint32_t const value) {
+	HbReport_Assert_Assume(target != NULL);
+	#if defined(HbPlatform_OS_Microsoft)
+	return (uint32_t) InterlockedExchange((LONG volatile *) target, (LONG) value);
+	#else
+	#error HbPara_Atomic_U32_Exchange: No implementation for the target OS.
+	#endif
+}
+HbForceInline uint32_t HbPara_Atomic_U32_Or(uint32_t volatile * const target, uint32_t const value) {
+	HbReport_Assert_Assume(target != NULL);
+	#if defined(HbPlatform_OS_Microsoft)
+	return (uint32_t) InterlockedOr((LONG volatile *) target, (LONG) value);
+	#else
+	#error HbPara_Atomic_U32_Or: No implementation for the target OS.
+	#endif
+}
+HbForceInline size_t HbPara_Atomic_Size_Add(size_t volatile * const target, size_t const value) {
+	HbReport_Assert_Assume(target != NULL);
+	#if defined(HbPlatform_OS_Microsoft)
+	#if HbPlatform_CPU_Bits >= 64
+	return (size_t) InterlockedExchangeAdd64((LONGLONG volatile *) target, (LONGLONG) value);
+	#else
+	return (size_t) InterlockedExchangeAdd((LONG volatile *) target, (LONG) value);
+	#endif
+	#else
+	#error HbPara_Atomic_Size_Add: No implementation for the target OS.
+	#endif
+}
+HbForceInline size_t HbPara_Atomic_Size_CompareExchange(size_t volatile * const target, size_t const exchange, size_t const comparand) {
+	HbReport_Assert_Assume(target != NULL);
+	#if defined(HbPlatform_OS_Microsoft)
+	#if HbPlatform_CPU_Bits >= 64
+	return (size_t) InterlockedCompareExchange64((LONGLONG volatile *) target, (LONGLONG) exchange, (LONGLONG) comparand);
+	#else
+	return (size_t) InterlockedCompareExchange((LONG volatile *) target, (LONG) exchange, (LONG) comparand);
+	#endif
+	#else
+	#error HbPara_Atomic_Size_CompareExchange: No implementation for the target OS.
+	#endif
+}
+HbForceInline void * HbPara_Atomic_Pointer_Exchange(void * volatile * const target, void * const value) {
+	HbReport_Assert_Assume(target != NULL);
+	#if defined(HbPlatform_OS_Microsoft)
+	return InterlockedExchangePointer(target, value);
+	#else
+	#error HbPara_Atomic_Pointer_Exchange: No implementation for the target OS.
+	#endif
+}
+HbForceInline void * HbPara_Atomic_Pointer_CompareExchange(void * volatile * const target, void * const exchange, void * const comparand) {
+	HbReport_Assert_Assume(target != NULL);
+	#if defined(HbPlatform_OS_Microsoft)
+	return InterlockedCompareExchangePointer(target, exchange, comparand);
+	#else
+	#error HbPara_Atomic_Pointer_CompareExchange: No implementation for the target OS.
+	#endif
+}
+
+/*************************************************************************
+ * Spinlock
+ * Zero-initialized, so usable in static storage without initialization.
+ * Only for very short critical sections. Not recursive!
+ *************************************************************************/
+typedef struct HbPara_Spinlock {
+	uint32_t volatile locked_i;
+} HbPara_Spinlock;
+HbForceInline void HbPara_Spinlock_Lock(HbPara_Spinlock * const spinlock) {
+	HbReport_Assert_Assume(spinlock != NULL);
+	while (HbPara_Atomic_U32_Exchange(&spinlock->locked_i, 1) != 0) {
+		// Wait without writing to the cache line not to slow down the owner.
+		while (spinlock->locked_i != 0) {
+			#if defined(HbPlatform_OS_Microsoft)
+			YieldProcessor();
+			#else
+			#error HbPara_Spinlock_Lock: No implementation for the target OS.
+			#endif
+		}
+	}
+}
+HbForceInline void HbPara_Spinlock_Unlock(HbPara_Spinlock * const spinlock) {
+	HbReport_Assert_Assume(spinlock != NULL);
+	HbReport_Assert_Assume(spinlock->locked_i != 0);
+	HbPara_Atomic_U32_Exchange(&spinlock->locked_i, 0);
+}
+
 /********
  * Mutex
  ********/
@@ -0,0 +1,134 @@
+// Compares HbMem_BTree with a sorted HbMem_DynArray searched with HbSort_Find_FirstNotLess_Size, at sizes from 1K to the maximum in steps of 10x.
+// Usage: HbMemBTreeBench [max element count, 10000000 by default] [insertions and removals, 2000 by default] [lookups, 200000 by default]
+// For each size, both are built from the same sorted keys, then measured for random lookups of the first element not less than a key,
+// inserting new keys and removing them again (so the size stays the same), and iterating in order. The elements are size_t keys.
+
+#include "HbMemBench.h"
+#include "../HbSort.h"
+
+static int HbMemBTreeBench_Compare(void const * const element1, void const * const element2, void * const userData) {
+	HbUnused(userData);
+	size_t const key1 = *(size_t const *) element1, key2 = *(size_t const *) element2;
+	return (key1 > key2) - (key1 < key2);
+}
+
+// Even keys are in the containers, odd keys are new, up to 4 * count.
+HbForceInline size_t HbMemBTreeBench_GetNewKey(uint64_t * const random, size_t const count) {
+	return (size_t) (HbMemBench_Random(random) % ((uint64_t) count * 4)) | 1;
+}
+
+static void HbMemBTreeBench_Report(char const * const name, double const treeTime, double const arrayTime, size_t const operationCount) {
+	printf("  %-24s %10.1f ns  %10.1f ns  %8.2fx\n", name, treeTime * 1.0e9 / (double) operationCount, arrayTime * 1.0e9 / (double) operationCount, arrayTime / treeTime);
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	size_t const maxCount = argumentCount > 1 ? HbMath_Max_Size((size_t) strtoull(arguments[1], NULL, 10), 1000) : 10000000;
+	size_t const changeCount = argumentCount > 2 ? HbMath_Max_Size((size_t) strtoull(arguments[2], NULL, 10), 1) : 2000;
+	size_t const lookupCount = argumentCount > 3 ? HbMath_Max_Size((size_t) strtoull(arguments[3], NULL, 10), 1) : 200000;
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemBTreeBench");
+	size_t * const keys = HbMem_Tag_Alloc(tag, size_t, maxCount);
+	for (size_t keyIndex = 0; keyIndex < maxCount; ++keyIndex) {
+		keys[keyIndex] = keyIndex * 4;
+	}
+
+	printf("  %-24s %13s  %13s  %9s\n", "Time per operation", "B+ tree", "Sorted array", "Array/tree");
+	for (size_t count = 1000; count <= maxCount; count *= 10) {
+		printf("%zu elements:\n", count);
+		HbMem_BTree tree;
+		HbMem_BTree_Init(&tree, size_t, HbMemBTreeBench_Compare, NULL, tag);
+		HbMem_DynArray array;
+		HbMem_DynArray_Init(&array, size_t, tag);
+
+		double startTime = HbMemBench_GetTime();
+		HbMem_BTree_BuildFromSorted(&tree, keys, count);
+		double const treeBuildTime = HbMemBench_GetTime() - startTime;
+		startTime = HbMemBench_GetTime();
+		HbMem_DynArray_AppendRange(&array, keys, count);
+		double const arrayBuildTime = HbMemBench_GetTime() - startTime;
+		HbMemBTreeBench_Report("Build from sorted", treeBuildTime, arrayBuildTime, count);
+
+		uint64_t random = HbMemBench_RandomSeed(count);
+		size_t treeFoundSum = 0;
+		startTime = HbMemBench_GetTime();
+		for (size_t lookupIndex = 0; lookupIndex < lookupCount; ++lookupIndex) {
+			size_t const key = HbMemBTreeBench_GetNewKey(&random, count);
+			HbMem_BTree_Cursor const cursor = HbMem_BTree_FindFirstNotLess(&tree, &key);
+			treeFoundSum += HbMem_BTree_Cursor_IsValid(cursor) ? *(size_t const *) HbMem_BTree_Cursor_Get(&tree, cursor) : 0;
+		}
+		double const treeLookupTime = HbMemBench_GetTime() - startTime;
+		random = HbMemBench_RandomSeed(count);
+		size_t arrayFoundSum = 0;
+		startTime = HbMemBench_GetTime();
+		for (size_t lookupIndex = 0; lookupIndex < lookupCount; ++lookupIndex) {
+			size_t const key = HbMemBTreeBench_GetNewKey(&random, count);
+			size_t const index = HbSort_Find_FirstNotLess_Size(key, (size_t const *) array.data_r, array.count_r);
+			arrayFoundSum += index < array.count_r ? *HbMem_DynArray_Get(&array, index, size_t) : 0;
+		}
+		double const arrayLookupTime = HbMemBench_GetTime() - startTime;
+		HbMemBench_Check(treeFoundSum == arrayFoundSum, "Lookup results differ", count);
+		HbMemBTreeBench_Report("Find first not less", treeLookupTime, arrayLookupTime, lookupCount);
+
+		random = HbMemBench_RandomSeed(count);
+		startTime = HbMemBench_GetTime();
+		for (size_t changeIndex = 0; changeIndex < changeCount; ++changeIndex) {
+			size_t const key = HbMemBTreeBench_GetNewKey(&random, count);
+			HbMem_BTree_Insert(&tree, &key, NULL);
+		}
+		random = HbMemBench_RandomSeed(count);
+		for (size_t changeIndex = 0; changeIndex < changeCount; ++changeIndex) {
+			size_t const key = HbMemBTreeBench_GetNewKey(&random, count);
+			HbMem_BTree_Remove(&tree, &key);
+		}
+		double const treeChangeTime = HbMemBench_GetTime() - startTime;
+		random = HbMemBench_RandomSeed(count);
+		startTime = HbMemBench_GetTime();
+		for (size_t changeIndex = 0; changeIndex < changeCount; ++changeIndex) {
+			size_t const key = HbMemBTreeBench_GetNewKey(&random, count);
+			size_t const index = HbSort_Find_FirstNotLess_Size(key, (size_t const *) array.data_r, array.count_r);
+			if (index >= array.count_r || *HbMem_DynArray_Get(&array, index, size_t) != key) {
+				HbMem_DynArray_MakeGapInSorted(&array, index, 1);
+				*HbMem_DynArray_GetMut(&array, index, size_t) = key;
+			}
+		}
+		random = HbMemBench_RandomSeed(count);
+		for (size_t changeIndex = 0; changeIndex < changeCount; ++changeIndex) {
+			size_t const key = HbMemBTreeBench_GetNewKey(&random, count);
+			size_t const index = HbSort_Find_FirstNotLess_Size(key, (size_t const *) array.data_r, array.count_r);
+			if (index < array.count_r && *HbMem_DynArray_Get(&array, index, size_t) == key) {
+				HbMem_DynArray_RemoveFromSorted(&array, index, 1);
+			}
+		}
+		double const arrayChangeTime = HbMemBench_GetTime() - startTime;
+		HbMemBench_Check(tree.count_r == count && array.count_r == count, "Count changed by inserting and removing", tree.count_r);
+		HbMemBTreeBench_Report("Insert and remove", treeChangeTime, arrayChangeTime, changeCount * 2);
+
+		size_t treeSum = 0;
+		startTime = HbMemBench_GetTime();
+		for (HbMem_BTree_Cursor cursor = HbMem_BTree_GetFirst(&tree); HbMem_BTree_Cursor_IsValid(cursor); HbMem_BTree_Cursor_Next(&cursor)) {
+			treeSum += *(size_t const *) HbMem_BTree_Cursor_Get(&tree, cursor);
+		}
+		double const treeIterateTime = HbMemBench_GetTime() - startTime;
+		size_t arraySum = 0;
+		startTime = HbMemBench_GetTime();
+		for (size_t index = 0; index < array.count_r; ++index) {
+			arraySum += *HbMem_DynArray_Get(&array, index, size_t);
+		}
+		double const arrayIterateTime = HbMemBench_GetTime() - startTime;
+		HbMemBench_Check(treeSum == arraySum, "Iteration results differ", count);
+		HbMemBTreeBench_Report("Iterate", treeIterateTime, arrayIterateTime, count);
+
+		HbMem_DynArray_Shutdown(&array);
+		HbMem_BTree_Shutdown(&tree);
+		if (count > maxCount / 10) {
+			break;
+		}
+	}
+
+	HbMem_Tag_Free(keys);
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+#ifndef HbInclude_HbMemBench
+#define HbInclude_HbMemBench
+// Helpers shared by the HbMem benchmark and stress test tools - timing, threads started at once, pseudo-random numbers and failing checks.
+// The tools are console applications built from one source file linked with the Hardbytes library, with the repository root in the include paths.
+// Timings are only meaningful in the release configuration, though the stress tests are useful with assertions as well.
+
+#include "../HbMem.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined(HbPlatform_OS_Microsoft)
+#error HbMemBench: No implementation for the target OS.
+#endif
+
+// Limit of WaitForMultipleObjects.
+#define HbMemBench_MaxThreadCount 64
+
+inline double HbMemBench_GetTime(void) {
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double) counter.QuadPart / (double) frequency.QuadPart;
+}
+
+inline size_t HbMemBench_GetProcessorCount(void) {
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return HbMath_Clamp_Size((size_t) systemInfo.dwNumberOfProcessors, 1, HbMemBench_MaxThreadCount);
+}
+
+// xorshift64, the state must not be 0.
+HbForceInline uint64_t HbMemBench_Random(uint64_t * const state) {
+	uint64_t random = *state;
+	random ^= random << 13;
+	random ^= random >> 7;
+	random ^= random << 17;
+	*state = random;
+	return random;
+}
+
+HbForceInline uint64_t HbMemBench_RandomSeed(size_t const index) {
+	return ((uint64_t) index + 1) * UINT64_C(0x9E3779B97F4A7C15);
+}
+
+// Prints the message and exits with a failure - unlike assertions, also checked in release builds.
+inline void HbMemBench_Check(HbBool const condition, char const * const message, size_t const value) {
+	if (!condition) {
+		fprintf(stderr, "Check failed: %s (%zu).\n", message, value);
+		exit(EXIT_FAILURE);
+	}
+}
+
+typedef void (* HbMemBench_ThreadFunction)(size_t const threadIndex, void * const userData);
+
+typedef struct HbMemBench_Thread {
+	HbMemBench_ThreadFunction function;
+	void * userData;
+	size_t threadIndex;
+	uint32_t volatile * readyCount;
+	uint32_t volatile * started;
+} HbMemBench_Thread;
+
+inline DWORD WINAPI HbMemBench_ThreadEntry(LPVOID const parameter) {
+	HbMemBench_Thread const * const thread = (HbMemBench_Thread const *) parameter;
+	HbPara_Atomic_U32_Add(thread->readyCount, 1);
+	while (*thread->started == 0) {
+		YieldProcessor();
+	}
+	thread->function(thread->threadIndex, thread->userData);
+	// Threads using the small object allocator must give their heaps back before exiting.
+	HbMem_Slab_Thread_Shutdown();
+	return 0;
+}
+
+// Runs the function on new threads started at once, returning the seconds from the start until all of them have finished.
+inline double HbMemBench_RunThreads(size_t const threadCount, HbMemBench_ThreadFunction const function, void * const userData) {
+	HbMemBench_Check(threadCount != 0 && threadCount <= HbMemBench_MaxThreadCount, "Unsupported thread count", threadCount);
+	HbMemBench_Thread threads[HbMemBench_MaxThreadCount];
+	HANDLE threadHandles[HbMemBench_MaxThreadCount];
+	uint32_t volatile readyCount = 0, started = 0;
+	for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+		HbMemBench_Thread * const thread = &threads[threadIndex];
+		thread->function = function;
+		thread->userData = userData;
+		thread->threadIndex = threadIndex;
+		thread->readyCount = &readyCount;
+		thread->started = &started;
+		threadHandles[threadIndex] = CreateThread(NULL, 0, HbMemBench_ThreadEntry, thread, 0, NULL);
+		HbMemBench_Check(threadHandles[threadIndex] != NULL, "Failed to create a thread", threadIndex);
+	}
+	while (readyCount != threadCount) {
+		YieldProcessor();
+	}
+	double const startTime = HbMemBench_GetTime();
+	HbPara_Atomic_U32_Exchange(&started, 1);
+	WaitForMultipleObjects((DWORD) threadCount, threadHandles, TRUE, INFINITE);
+	double const endTime = HbMemBench_GetTime();
+	for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+		CloseHandle(threadHandles[threadIndex]);
+	}
+	return endTime - startTime;
+}
+
+#endif
@@ -0,0 +1,116 @@
+// Compares loops over HbMem::DynArray with the same loops over a raw buffer, which should compile to the same code.
+// Usage: HbMemDynArrayBench [element count, 1000000 by default] [repetitions, 50 by default]
+// The fastest repetition of each loop is reported. For the generated code itself, compile with /FAs and compare the inner loops of the functions below.
+
+#include "HbMemBench.h"
+#include "../HbMem.hpp"
+
+static uint32_t volatile HbMemDynArrayBench_Sink;
+
+template<typename Function>
+static double HbMemDynArrayBench_Measure(size_t const repetitionCount, Function && function) {
+	double fastestTime = HUGE_VAL;
+	for (size_t repetitionIndex = 0; repetitionIndex < repetitionCount; ++repetitionIndex) {
+		double const startTime = HbMemBench_GetTime();
+		function();
+		double const time = HbMemBench_GetTime() - startTime;
+		fastestTime = time < fastestTime ? time : fastestTime;
+	}
+	return fastestTime;
+}
+
+static uint32_t HbMemDynArrayBench_SumRaw(uint32_t const * const data, size_t const count) {
+	uint32_t sum = 0;
+	for (uint32_t const * element = data; element != data + count; ++element) {
+		sum += *element;
+	}
+	return sum;
+}
+
+static uint32_t HbMemDynArrayBench_SumRangeFor(HbMem::DynArray<uint32_t> const & array) {
+	uint32_t sum = 0;
+	for (uint32_t const element : array) {
+		sum += element;
+	}
+	return sum;
+}
+
+static uint32_t HbMemDynArrayBench_SumIndexed(HbMem::DynArray<uint32_t> const & array) {
+	uint32_t sum = 0;
+	for (size_t index = 0; index < array.GetCount(); ++index) {
+		sum += array[index];
+	}
+	return sum;
+}
+
+// The untyped C array for reference - the element size is not known at compile time there.
+static uint32_t HbMemDynArrayBench_SumUntyped(HbMem_DynArray const * const array) {
+	uint32_t sum = 0;
+	for (size_t index = 0; index < array->count_r; ++index) {
+		sum += *HbMem_DynArray_Get(array, index, uint32_t);
+	}
+	return sum;
+}
+
+static void HbMemDynArrayBench_FillRaw(uint32_t * const data, size_t const count) {
+	for (size_t index = 0; index < count; ++index) {
+		data[index] = (uint32_t) index;
+	}
+}
+
+static void HbMemDynArrayBench_FillAppend(HbMem::DynArray<uint32_t> & array, size_t const count) {
+	array.Clear();
+	for (size_t index = 0; index < count; ++index) {
+		array.Append((uint32_t) index);
+	}
+}
+
+static void HbMemDynArrayBench_Report(char const * const name, double const time, double const rawTime, size_t const count) {
+	printf("%-28s %8.3f ns/element  %6.2fx raw\n", name, time * 1.0e9 / (double) count, time / rawTime);
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	size_t const count = argumentCount > 1 ? HbMath_Max_Size((size_t) strtoull(arguments[1], NULL, 10), 1) : 1000000;
+	size_t const repetitionCount = argumentCount > 2 ? HbMath_Max_Size((size_t) strtoull(arguments[2], NULL, 10), 1) : 50;
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemDynArrayBench");
+	{
+		uint32_t * const raw = HbMem_Tag_Alloc(tag, uint32_t, count);
+		HbMem::DynArray<uint32_t> typed(tag, __func__, __LINE__);
+		typed.ReserveExactly(count, false);
+		HbMem_DynArray untyped;
+		HbMem_DynArray_Init(&untyped, uint32_t, tag);
+		HbMem_DynArray_ResizeExactly(&untyped, count, HbFalse);
+
+		double const fillRawTime = HbMemDynArrayBench_Measure(repetitionCount, [&]() { HbMemDynArrayBench_FillRaw(raw, count); });
+		HbMemDynArrayBench_Report("Fill raw", fillRawTime, fillRawTime, count);
+		HbMemDynArrayBench_Report("Fill DynArray Append", HbMemDynArrayBench_Measure(repetitionCount, [&]() { HbMemDynArrayBench_FillAppend(typed, count); }),
+		                          fillRawTime, count);
+		HbMemBench_Check(typed.GetCount() == count, "DynArray count mismatch", typed.GetCount());
+		HbMemDynArrayBench_FillRaw(static_cast<uint32_t *>(untyped.data_r), count);
+
+		uint32_t const expectedSum = HbMemDynArrayBench_SumRaw(raw, count);
+		double const sumRawTime = HbMemDynArrayBench_Measure(repetitionCount, [&]() { HbMemDynArrayBench_Sink = HbMemDynArrayBench_SumRaw(raw, count); });
+		HbMemDynArrayBench_Report("Sum raw", sumRawTime, sumRawTime, count);
+		HbMemDynArrayBench_Report("Sum DynArray range-for", HbMemDynArrayBench_Measure(repetitionCount, [&]() {
+			HbMemDynArrayBench_Sink = HbMemDynArrayBench_SumRangeFor(typed);
+		}), sumRawTime, count);
+		HbMemBench_Check(HbMemDynArrayBench_Sink == expectedSum, "Range-for sum mismatch", HbMemDynArrayBench_Sink);
+		HbMemDynArrayBench_Report("Sum DynArray operator[]", HbMemDynArrayBench_Measure(repetitionCount, [&]() {
+			HbMemDynArrayBench_Sink = HbMemDynArrayBench_SumIndexed(typed);
+		}), sumRawTime, count);
+		HbMemBench_Check(HbMemDynArrayBench_Sink == expectedSum, "Indexed sum mismatch", HbMemDynArrayBench_Sink);
+		HbMemDynArrayBench_Report("Sum HbMem_DynArray_Get", HbMemDynArrayBench_Measure(repetitionCount, [&]() {
+			HbMemDynArrayBench_Sink = HbMemDynArrayBench_SumUntyped(&untyped);
+		}), sumRawTime, count);
+		HbMemBench_Check(HbMemDynArrayBench_Sink == expectedSum, "Untyped sum mismatch", HbMemDynArrayBench_Sink);
+
+		HbMem_DynArray_Shutdown(&untyped);
+		HbMem_Tag_Free(raw);
+	}
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+// Measures HbMem_FibAlloc for largest levels from 20 to 90 in steps of 10 (to 45 with HbMem_Build_CompactFibAlloc or 32-bit size_t).
+// Usage: HbMemFibAllocBench [operations per measurement, 1000000 by default]
+// Level lookup compares the binary search over HbMem_FibAlloc_Sizes, which HbMem_FibAlloc_ClosestLevelRoundingUp and Alloc used previously,
+// with the current lookup. Fallback alloc+free allocates with a preferred level above every free level, so Alloc has to search for a smaller free
+// level after finding none up to the largest level. Random mix allocates and frees random sizes, with up to 4096 live allocations, and prints
+// a hash of the offsets and levels returned by Alloc for each largest level. With the same arguments, the hashes must be the same for every
+// revision and build configuration that isn't meant to change the placement, including with and without HbMem_Build_CompactFibAlloc. Only the public API is used, so the tool can be built against earlier revisions.
+
+#include "HbMemBench.h"
+#include "../HbSort.h"
+
+#ifndef HbMem_FibAlloc_LevelCount
+// Revisions before the level count was declared in HbMem.h.
+#define HbMem_FibAlloc_LevelCount (HbPlatform_CPU_Bits >= 64 ? 92 : 46)
+#endif
+
+#ifdef HbMem_Build_CompactFibAlloc
+#define HbMemFibAllocBench_MaxLargestLevel 45 // Offsets must fit in 32 bits.
+#else
+#define HbMemFibAllocBench_MaxLargestLevel HbMath_Min_Size(90, HbMem_FibAlloc_LevelCount - 1)
+#endif
+
+#define HbMemFibAllocBench_PreferredLevel 4
+
+// Sizes with a uniformly random bit length, so every level is looked up.
+HbForceInline size_t HbMemFibAllocBench_GetRandomSize(uint64_t * const random) {
+	uint64_t const bits = HbMemBench_Random(random);
+	return (size_t) (bits >> (bits % HbPlatform_CPU_Bits)) >> (64 - HbPlatform_CPU_Bits);
+}
+
+static void HbMemFibAllocBench_MeasureLevelLookup(size_t const operationCount) {
+	uint64_t random = HbMemBench_RandomSeed(0);
+	size_t binarySearchSum = 0;
+	double startTime = HbMemBench_GetTime();
+	for (size_t operationIndex = 0; operationIndex < operationCount; ++operationIndex) {
+		size_t const size = HbMemFibAllocBench_GetRandomSize(&random);
+		binarySearchSum += HbMath_Min_Size(HbSort_Find_FirstNotLess_Size(size, HbMem_FibAlloc_Sizes, HbMem_FibAlloc_LevelCount), HbMem_FibAlloc_LevelCount - 1);
+	}
+	double const binarySearchTime = HbMemBench_GetTime() - startTime;
+	random = HbMemBench_RandomSeed(0);
+	size_t lookupSum = 0;
+	startTime = HbMemBench_GetTime();
+	for (size_t operationIndex = 0; operationIndex < operationCount; ++operationIndex) {
+		lookupSum += HbMem_FibAlloc_ClosestLevelRoundingUp(HbMemFibAllocBench_GetRandomSize(&random));
+	}
+	double const lookupTime = HbMemBench_GetTime() - startTime;
+	HbMemBench_Check(binarySearchSum == lookupSum, "Level lookup results differ", lookupSum);
+	printf("Level lookup: binary search %.1f ns, HbMem_FibAlloc_ClosestLevelRoundingUp %.1f ns.\n",
+	       binarySearchTime * 1.0e9 / (double) operationCount, lookupTime * 1.0e9 / (double) operationCount);
+}
+
+static double HbMemFibAllocBench_MeasureFallback(HbMem_FibAlloc * const fibAlloc, size_t const largestLevel, size_t const operationCount) {
+	// Splitting the tree down to one unit leaves free blocks on many levels, take all of them from the preferred level up.
+	size_t const firstAllocation = HbMem_FibAlloc_Alloc(fibAlloc, 1, 1, NULL);
+	HbMemBench_Check(firstAllocation != HbMem_FibAlloc_Alloc_Failed, "Failed to allocate a unit", largestLevel);
+	for (size_t level = largestLevel; level >= HbMemFibAllocBench_PreferredLevel; --level) {
+		while (HbMem_FibAlloc_Alloc(fibAlloc, HbMem_FibAlloc_Sizes[level], HbMem_FibAlloc_Sizes[level], NULL) != HbMem_FibAlloc_Alloc_Failed) {}
+	}
+	double const startTime = HbMemBench_GetTime();
+	for (size_t operationIndex = 0; operationIndex < operationCount; ++operationIndex) {
+		size_t allocationLevel;
+		size_t const allocation = HbMem_FibAlloc_Alloc(fibAlloc, 1, HbMem_FibAlloc_Sizes[HbMemFibAllocBench_PreferredLevel], &allocationLevel);
+		HbMemBench_Check(allocation != HbMem_FibAlloc_Alloc_Failed && allocationLevel < HbMemFibAllocBench_PreferredLevel,
+		                 "Fallback allocation not below the preferred level", largestLevel);
+		HbMem_FibAlloc_Free(fibAlloc, allocation);
+	}
+	return HbMemBench_GetTime() - startTime;
+}
+
+#define HbMemFibAllocBench_MaxLiveCount 4096
+
+// Returns the time and the hash of the allocations (FNV-1a over words), and checks that everything is merged back after freeing all.
+static double HbMemFibAllocBench_MeasureMix(HbMem_FibAlloc * const fibAlloc, size_t const largestLevel, size_t const operationCount,
+                                            uint64_t * const traceHashOut) {
+	static size_t liveAllocations[HbMemFibAllocBench_MaxLiveCount];
+	size_t liveCount = 0;
+	uint64_t random = HbMemBench_RandomSeed(largestLevel);
+	uint64_t hash = UINT64_C(14695981039346656037);
+	size_t const maxMinimumCount = HbMem_FibAlloc_Sizes[largestLevel] / 2048 + 1;
+	double const startTime = HbMemBench_GetTime();
+	for (size_t operationIndex = 0; operationIndex < operationCount; ++operationIndex) {
+		uint64_t const bits = HbMemBench_Random(&random);
+		if (liveCount == 0 || ((bits & 1) == 0 && liveCount < HbMemFibAllocBench_MaxLiveCount)) {
+			size_t const minimumCount = (size_t) ((bits >> 1) % maxMinimumCount) + 1;
+			size_t const preferredCount = minimumCount + (size_t) (HbMemBench_Random(&random) % (minimumCount + 1));
+			size_t allocationLevel;
+			size_t const allocation = HbMem_FibAlloc_Alloc(fibAlloc, minimumCount, preferredCount, &allocationLevel);
+			hash = (hash ^ (uint64_t) allocation) * UINT64_C(1099511628211);
+			if (allocation != HbMem_FibAlloc_Alloc_Failed) {
+				hash = (hash ^ (uint64_t) allocationLevel) * UINT64_C(1099511628211);
+				liveAllocations[liveCount++] = allocation;
+			}
+		} else {
+			size_t const liveIndex = (size_t) ((bits >> 1) % liveCount);
+			HbMem_FibAlloc_Free(fibAlloc, liveAllocations[liveIndex]);
+			liveAllocations[liveIndex] = liveAllocations[--liveCount];
+		}
+	}
+	double const time = HbMemBench_GetTime() - startTime;
+	while (liveCount != 0) {
+		HbMem_FibAlloc_Free(fibAlloc, liveAllocations[--liveCount]);
+	}
+	HbMemBench_Check(HbMem_FibAlloc_Alloc(fibAlloc, HbMem_FibAlloc_Sizes[largestLevel], HbMem_FibAlloc_Sizes[largestLevel], NULL) == 0,
+	                 "Not merged back after freeing everything", largestLevel);
+	*traceHashOut = hash;
+	return time;
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	size_t const operationCount = argumentCount > 1 ? HbMath_Max_Size((size_t) strtoull(arguments[1], NULL, 10), 1) : 1000000;
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemFibAllocBench");
+
+	HbMemFibAllocBench_MeasureLevelLookup(operationCount);
+	#ifdef HbMem_Build_CompactFibAlloc
+	printf("Compact nodes.\n");
+	#endif
+	printf("Largest level  Fallback alloc+free  Random mix per operation  Random mix trace hash\n");
+	for (size_t largestLevel = 20; ; largestLevel = HbMath_Min_Size(largestLevel + 10, HbMemFibAllocBench_MaxLargestLevel)) {
+		HbMem_FibAlloc fibAlloc;
+		HbMem_FibAlloc_Init(&fibAlloc, largestLevel, tag);
+		double const fallbackTime = HbMemFibAllocBench_MeasureFallback(&fibAlloc, largestLevel, operationCount);
+		HbMem_FibAlloc_Shutdown(&fibAlloc);
+		HbMem_FibAlloc_Init(&fibAlloc, largestLevel, tag);
+		uint64_t traceHash;
+		double const mixTime = HbMemFibAllocBench_MeasureMix(&fibAlloc, largestLevel, operationCount, &traceHash);
+		HbMem_FibAlloc_Shutdown(&fibAlloc);
+		printf("%13zu  %16.1f ns  %21.1f ns       %016llX\n", largestLevel,
+		       fallbackTime * 1.0e9 / (double) operationCount, mixTime * 1.0e9 / (double) operationCount, (unsigned long long) traceHash);
+		if (largestLevel >= HbMemFibAllocBench_MaxLargestLevel) {
+			break;
+		}
+	}
+
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	return EXIT_SUCCESS;
+}
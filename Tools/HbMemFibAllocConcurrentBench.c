@@ -0,0 +1,169 @@
+// Measures HbMem_FibAlloc_Concurrent from 1 to N threads, with an HbMem_FibAlloc behind an HbPara_Mutex as the reference, then stress tests it.
+// Usage: HbMemFibAllocConcurrentBench [max thread count, the processor count by default] [operations per thread, 1000000 by default]
+// Every thread allocates blocks of 1-200 units, sometimes preferring up to 300 more, and frees random ones of up to 64 live blocks.
+// The measurements use a pool of level 30. The stress test runs all threads on a pool of level 19 (10946 units), too small for all the live
+// blocks, so allocations in the tree fail and the thread caches are flushed before retrying. Every unit of the pool records the owner of the
+// block containing it, so overlapping live blocks fail.
+// All runs check that the tree is merged back into one free block after everything is freed and the caches are flushed.
+// The checks in HbMem_FibAlloc_Concurrent_Free serialize the frees in assert builds, so run the stress test in the release configuration as well.
+
+#include "HbMemBench.h"
+#include <string.h>
+
+#define HbMemFibAllocConcurrentBench_MaxLiveCount 64
+#define HbMemFibAllocConcurrentBench_BenchmarkLevel 30
+#define HbMemFibAllocConcurrentBench_StressLevel 19
+
+typedef struct HbMemFibAllocConcurrentBench_Run {
+	HbMem_FibAlloc_Concurrent * concurrentFibAlloc; // NULL to use the mutex.
+	HbMem_FibAlloc * fibAlloc;
+	HbPara_Mutex * fibAllocMutex;
+	size_t operationCount; // Per thread.
+	uint32_t volatile * unitOwners; // Owner of every unit of the pool, 0 if free, NULL not to check.
+	uint32_t volatile failedAllocationCount;
+} HbMemFibAllocConcurrentBench_Run;
+
+typedef struct HbMemFibAllocConcurrentBench_Block {
+	size_t allocation;
+	size_t level;
+	uint32_t owner;
+} HbMemFibAllocConcurrentBench_Block;
+
+static void HbMemFibAllocConcurrentBench_SetOwner(HbMemFibAllocConcurrentBench_Run * const run, HbMemFibAllocConcurrentBench_Block const * const block,
+                                                  HbBool const isAllocated) {
+	if (run->unitOwners == NULL) {
+		return;
+	}
+	uint32_t volatile * const blockUnitOwners = run->unitOwners + block->allocation;
+	for (size_t unitIndex = 0; unitIndex < HbMem_FibAlloc_Sizes[block->level]; ++unitIndex) {
+		uint32_t const previousOwner = HbPara_Atomic_U32_Exchange(&blockUnitOwners[unitIndex], isAllocated ? block->owner : 0);
+		HbMemBench_Check(previousOwner == (isAllocated ? 0 : block->owner), "Live blocks overlap", block->allocation + unitIndex);
+	}
+}
+
+static void HbMemFibAllocConcurrentBench_Free(HbMemFibAllocConcurrentBench_Run * const run, HbMemFibAllocConcurrentBench_Block const * const block) {
+	HbMemFibAllocConcurrentBench_SetOwner(run, block, HbFalse);
+	if (run->concurrentFibAlloc != NULL) {
+		HbMem_FibAlloc_Concurrent_Free(run->concurrentFibAlloc, block->allocation, block->level);
+	} else {
+		HbPara_Mutex_Lock(run->fibAllocMutex);
+		HbMem_FibAlloc_Free(run->fibAlloc, block->allocation);
+		HbPara_Mutex_Unlock(run->fibAllocMutex);
+	}
+}
+
+static void HbMemFibAllocConcurrentBench_Thread(size_t const threadIndex, void * const userData) {
+	HbMemFibAllocConcurrentBench_Run * const run = (HbMemFibAllocConcurrentBench_Run *) userData;
+	HbMemFibAllocConcurrentBench_Block liveBlocks[HbMemFibAllocConcurrentBench_MaxLiveCount];
+	size_t liveCount = 0;
+	uint32_t failedAllocationCount = 0;
+	// The thread in the upper bits, so owners are unique among the live blocks.
+	uint32_t nextOwner = (uint32_t) (threadIndex + 1) << 24;
+	uint64_t random = HbMemBench_RandomSeed(threadIndex);
+	for (size_t operationIndex = 0; operationIndex < run->operationCount; ++operationIndex) {
+		uint64_t const bits = HbMemBench_Random(&random);
+		if (liveCount == 0 || ((bits & 1) == 0 && liveCount < HbMemFibAllocConcurrentBench_MaxLiveCount)) {
+			size_t const minimumCount = (size_t) ((bits >> 1) % 200) + 1;
+			size_t const preferredCount = (bits >> 9) % 4 != 0 ? minimumCount : minimumCount + (size_t) ((bits >> 11) % 300);
+			HbMemFibAllocConcurrentBench_Block * const block = &liveBlocks[liveCount];
+			if (run->concurrentFibAlloc != NULL) {
+				block->allocation = HbMem_FibAlloc_Concurrent_Alloc(run->concurrentFibAlloc, minimumCount, preferredCount, &block->level);
+			} else {
+				HbPara_Mutex_Lock(run->fibAllocMutex);
+				block->allocation = HbMem_FibAlloc_Alloc(run->fibAlloc, minimumCount, preferredCount, &block->level);
+				HbPara_Mutex_Unlock(run->fibAllocMutex);
+			}
+			if (block->allocation == HbMem_FibAlloc_Alloc_Failed) {
+				++failedAllocationCount;
+				continue;
+			}
+			HbMemBench_Check(HbMem_FibAlloc_Sizes[block->level] >= minimumCount, "Allocated block smaller than the minimum", block->level);
+			block->owner = ++nextOwner;
+			HbMemFibAllocConcurrentBench_SetOwner(run, block, HbTrue);
+			++liveCount;
+		} else {
+			HbMemFibAllocConcurrentBench_Block * const block = &liveBlocks[(size_t) ((bits >> 1) % liveCount)];
+			HbMemFibAllocConcurrentBench_Free(run, block);
+			*block = liveBlocks[--liveCount];
+		}
+	}
+	while (liveCount != 0) {
+		HbMemFibAllocConcurrentBench_Free(run, &liveBlocks[--liveCount]);
+	}
+	HbPara_Atomic_U32_Add(&run->failedAllocationCount, failedAllocationCount);
+}
+
+static void HbMemFibAllocConcurrentBench_CheckMerged(HbMem_FibAlloc_Stats const * const stats, size_t const largestLevel) {
+	HbMemBench_Check(stats->liveAllocationCount_r == 0, "Blocks still live after freeing everything", stats->liveAllocationCount_r);
+	HbMemBench_Check(stats->largestFreeLevel_r == largestLevel && stats->freeUnitCount_r == HbMem_FibAlloc_Sizes[largestLevel] && stats->nodeCount_r == 1,
+	                 "Tree not merged back after freeing everything", stats->nodeCount_r);
+}
+
+// Returns the allocations and frees per second.
+static double HbMemFibAllocConcurrentBench_RunConcurrent(HbMemFibAllocConcurrentBench_Run * const run, HbMem_Tag * const tag,
+                                                         size_t const largestLevel, size_t const threadCount) {
+	HbMem_FibAlloc_Concurrent * const concurrentFibAlloc = HbMem_Tag_AllocAligned(tag, HbMem_FibAlloc_Concurrent, 1, HbPlatform_CacheLineSize);
+	HbMem_FibAlloc_Concurrent_Init(concurrentFibAlloc, largestLevel, tag);
+	run->concurrentFibAlloc = concurrentFibAlloc;
+	run->failedAllocationCount = 0;
+	double const time = HbMemBench_RunThreads(threadCount, HbMemFibAllocConcurrentBench_Thread, run);
+	HbMem_FibAlloc_Concurrent_Flush(concurrentFibAlloc);
+	HbMem_FibAlloc_Stats stats;
+	HbMem_FibAlloc_Concurrent_GetStats(concurrentFibAlloc, &stats);
+	HbMemFibAllocConcurrentBench_CheckMerged(&stats, largestLevel);
+	HbMem_FibAlloc_Concurrent_Shutdown(concurrentFibAlloc);
+	HbMem_Tag_Free(concurrentFibAlloc);
+	return (double) (threadCount * run->operationCount) / time;
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	size_t const maxThreadCount = argumentCount > 1 ? HbMath_Clamp_Size((size_t) strtoull(arguments[1], NULL, 10), 1, HbMemBench_MaxThreadCount) :
+	                                                  HbMemBench_GetProcessorCount();
+	size_t const operationCount = argumentCount > 2 ? HbMath_Max_Size((size_t) strtoull(arguments[2], NULL, 10), 1) : 1000000;
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemFibAllocConcurrentBench");
+	HbMemFibAllocConcurrentBench_Run run;
+	run.operationCount = operationCount;
+	run.unitOwners = NULL;
+	HbMem_FibAlloc fibAlloc;
+	HbPara_Mutex fibAllocMutex;
+	HbPara_Mutex_Init(&fibAllocMutex, HbFalse);
+	run.fibAlloc = &fibAlloc;
+	run.fibAllocMutex = &fibAllocMutex;
+
+	printf("Threads  Concurrent Mops/s  Scaling  Mutex Mops/s  Scaling\n");
+	double concurrentSingleThreadRate = 0.0, mutexSingleThreadRate = 0.0;
+	for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount) {
+		double const concurrentRate = HbMemFibAllocConcurrentBench_RunConcurrent(&run, tag, HbMemFibAllocConcurrentBench_BenchmarkLevel, threadCount) * 1.0e-6;
+		HbMem_FibAlloc_Init(&fibAlloc, HbMemFibAllocConcurrentBench_BenchmarkLevel, tag);
+		run.concurrentFibAlloc = NULL;
+		double const mutexRate = (double) (threadCount * operationCount) / HbMemBench_RunThreads(threadCount, HbMemFibAllocConcurrentBench_Thread, &run) * 1.0e-6;
+		HbMem_FibAlloc_Stats stats;
+		HbMem_FibAlloc_GetStats(&fibAlloc, &stats);
+		HbMemFibAllocConcurrentBench_CheckMerged(&stats, HbMemFibAllocConcurrentBench_BenchmarkLevel);
+		HbMem_FibAlloc_Shutdown(&fibAlloc);
+		if (threadCount == 1) {
+			concurrentSingleThreadRate = concurrentRate;
+			mutexSingleThreadRate = mutexRate;
+		}
+		printf("%7zu  %17.2f  %6.2fx  %12.2f  %6.2fx\n", threadCount,
+		       concurrentRate, concurrentRate / concurrentSingleThreadRate, mutexRate, mutexRate / mutexSingleThreadRate);
+	}
+
+	size_t const stressPoolSize = HbMem_FibAlloc_Sizes[HbMemFibAllocConcurrentBench_StressLevel];
+	run.unitOwners = HbMem_Tag_Alloc(tag, uint32_t, stressPoolSize);
+	memset((void *) run.unitOwners, 0, sizeof(uint32_t) * stressPoolSize);
+	HbMemFibAllocConcurrentBench_RunConcurrent(&run, tag, HbMemFibAllocConcurrentBench_StressLevel, maxThreadCount);
+	// Allocations only fail after the caches have been flushed.
+	HbMemBench_Check(run.failedAllocationCount != 0, "Allocations never failed, the caches weren't flushed for retrying", stressPoolSize);
+	printf("Stress test with %zu threads on %zu units passed, %u allocations failed after flushing the caches.\n",
+	       maxThreadCount, stressPoolSize, (unsigned) run.failedAllocationCount);
+	HbMem_Tag_Free((void *) run.unitOwners);
+
+	HbPara_Mutex_Shutdown(&fibAllocMutex);
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	return EXIT_SUCCESS;
+}
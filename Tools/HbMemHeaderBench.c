@@ -0,0 +1,67 @@
+// Measures the memory used by a trace of live tagged allocations with the header layout of the build, for comparing the default layout
+// with HbMem_Build_CompactHeader (build the tool and the library in both configurations, and run them with the same arguments).
+// Usage: HbMemHeaderBench [small|mixed, small by default] [allocation count, 200000 by default]
+// Small: 8-128 bytes. Mixed: 70% 8-128 bytes, 25% 128-1024 and 5% 1-64 KB.
+// The estimated size counts the slab block sizes for small allocations and the header with the size for larger ones,
+// the committed size is the growth of the private memory of the process, including the partially used slab spans.
+
+#include "HbMemBench.h"
+#include <Psapi.h>
+#include <string.h>
+
+static size_t HbMemHeaderBench_GetCommittedSize(void) {
+	PROCESS_MEMORY_COUNTERS memoryCounters;
+	HbMemBench_Check(GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)) != 0, "Failed to get the process memory info", 0);
+	return memoryCounters.PagefileUsage;
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	HbBool const isMixed = argumentCount > 1 && strcmp(arguments[1], "mixed") == 0;
+	size_t const allocationCount = argumentCount > 2 ? HbMath_Max_Size((size_t) strtoull(arguments[2], NULL, 10), 1) : 200000;
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemHeaderBench");
+	void * * const allocations = (void * *) malloc(allocationCount * sizeof(void *));
+	HbMemBench_Check(allocations != NULL, "Failed to allocate the allocation pointers", allocationCount);
+
+	size_t const committedSizeBefore = HbMemHeaderBench_GetCommittedSize();
+	size_t payloadSize = 0, estimatedSize = 0;
+	// 64-bit LCG with the high bits used, so the trace is the same on every target.
+	uint64_t random = 12345;
+	for (size_t allocationIndex = 0; allocationIndex < allocationCount; ++allocationIndex) {
+		random = random * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+		unsigned const randomBits = (unsigned) (random >> 33);
+		size_t size;
+		if (!isMixed || randomBits % 100 < 70) {
+			size = 8 + randomBits / 100 % 121;
+		} else if (randomBits % 100 < 95) {
+			size = 128 + randomBits / 100 % 897;
+		} else {
+			size = 1024 + randomBits / 100 % 64512;
+		}
+		allocations[allocationIndex] = HbMem_Tag_AllocExplicit(tag, size, HbTrue, __func__, __LINE__);
+		memset(allocations[allocationIndex], 0, size);
+		payloadSize += size;
+		size_t const slabClass = HbMem_Slab_GetClass(sizeof(HbMem_Tag_Allocation) + size);
+		estimatedSize += slabClass != HbMem_Slab_Class_None ? HbMem_Slab_ClassSizes[slabClass] : sizeof(HbMem_Tag_Allocation) + size;
+	}
+	size_t const committedSize = HbMemHeaderBench_GetCommittedSize() - committedSizeBefore;
+
+	#ifdef HbMem_Build_CompactHeader
+	printf("Compact header, %zu bytes.\n", sizeof(HbMem_Tag_Allocation));
+	#else
+	printf("Default header, %zu bytes.\n", sizeof(HbMem_Tag_Allocation));
+	#endif
+	printf("%zu %s allocations, %zu bytes requested.\n", allocationCount, isMixed ? "mixed" : "small", payloadSize);
+	printf("Estimated: %zu bytes, %.1f%% overhead.\n", estimatedSize, 100.0 * (double) (estimatedSize - payloadSize) / (double) payloadSize);
+	printf("Committed: %zu bytes, %.1f%% overhead.\n", committedSize, 100.0 * ((double) committedSize - (double) payloadSize) / (double) payloadSize);
+
+	for (size_t allocationIndex = 0; allocationIndex < allocationCount; ++allocationIndex) {
+		HbMem_Tag_Free(allocations[allocationIndex]);
+	}
+	free(allocations);
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	return EXIT_SUCCESS;
+}
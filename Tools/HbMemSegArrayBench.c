@@ -0,0 +1,123 @@
+// Measures appending to one HbMem_SegArray from 1 to N threads, with an HbMem_DynArray behind an HbPara_Mutex as the reference,
+// then checks the elements published while appending from all threads with a concurrent reader.
+// Usage: HbMemSegArrayBench [max thread count, the processor count by default] [appends per thread, 1000000 by default]
+// The reader checks that every published element is written, and that the elements of each thread are in the order they were appended.
+
+#include "HbMemBench.h"
+
+// Elements are the thread index in the upper bits and the sequence number of the append within the thread, starting from 1, in the lower ones.
+#define HbMemSegArrayBench_SequenceBits 40
+
+typedef struct HbMemSegArrayBench_Run {
+	size_t writerCount;
+	size_t appendCount; // Per writer.
+	HbMem_SegArray * segArray; // NULL to use the DynArray.
+	HbMem_DynArray * dynArray;
+	HbPara_Mutex * dynArrayMutex;
+	size_t readCount; // Elements checked by the reader, the thread after the writers if there is one.
+} HbMemSegArrayBench_Run;
+
+static void HbMemSegArrayBench_Read(HbMemSegArrayBench_Run * const run) {
+	size_t const totalCount = run->writerCount * run->appendCount;
+	uint64_t lastSequences[HbMemBench_MaxThreadCount] = { 0 };
+	size_t index = 0;
+	while (index < totalCount) {
+		if (index >= HbMem_SegArray_GetPublishedCount(run->segArray)) {
+			YieldProcessor();
+			continue;
+		}
+		size_t runCount;
+		uint64_t const * const elements = (uint64_t const *) HbMem_SegArray_GetPublishedRun(run->segArray, index, &runCount);
+		for (size_t elementIndex = 0; elementIndex < runCount; ++elementIndex) {
+			uint64_t const element = elements[elementIndex];
+			size_t const writerIndex = (size_t) (element >> HbMemSegArrayBench_SequenceBits);
+			uint64_t const sequence = element & (((uint64_t) 1 << HbMemSegArrayBench_SequenceBits) - 1);
+			HbMemBench_Check(writerIndex < run->writerCount && sequence != 0, "Published element not written", index + elementIndex);
+			HbMemBench_Check(sequence == lastSequences[writerIndex] + 1, "Elements of a thread out of order", index + elementIndex);
+			lastSequences[writerIndex] = sequence;
+		}
+		index += runCount;
+	}
+	for (size_t writerIndex = 0; writerIndex < run->writerCount; ++writerIndex) {
+		HbMemBench_Check(lastSequences[writerIndex] == run->appendCount, "Elements of a thread missing", writerIndex);
+	}
+	run->readCount = index;
+}
+
+static void HbMemSegArrayBench_Thread(size_t const threadIndex, void * const userData) {
+	HbMemSegArrayBench_Run * const run = (HbMemSegArrayBench_Run *) userData;
+	if (threadIndex >= run->writerCount) {
+		HbMemSegArrayBench_Read(run);
+		return;
+	}
+	uint64_t const threadBits = (uint64_t) threadIndex << HbMemSegArrayBench_SequenceBits;
+	for (size_t appendIndex = 0; appendIndex < run->appendCount; ++appendIndex) {
+		uint64_t const element = threadBits | (appendIndex + 1);
+		if (run->segArray != NULL) {
+			HbMem_SegArray_Append(run->segArray, &element);
+		} else {
+			HbPara_Mutex_Lock(run->dynArrayMutex);
+			size_t const index = HbMem_DynArray_Append(run->dynArray, 1);
+			*HbMem_DynArray_GetMut(run->dynArray, index, uint64_t) = element;
+			HbPara_Mutex_Unlock(run->dynArrayMutex);
+		}
+	}
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	size_t const maxThreadCount = argumentCount > 1 ? HbMath_Clamp_Size((size_t) strtoull(arguments[1], NULL, 10), 1, HbMemBench_MaxThreadCount - 1) :
+	                                                  HbMath_Min_Size(HbMemBench_GetProcessorCount(), HbMemBench_MaxThreadCount - 1);
+	size_t const appendCount = argumentCount > 2 ? HbMath_Clamp_Size((size_t) strtoull(arguments[2], NULL, 10), 1, ((size_t) 1 << HbMemSegArrayBench_SequenceBits) - 1) : 1000000;
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemSegArrayBench");
+	HbMem_SegArray * const segArray = HbMem_Tag_AllocAligned(tag, HbMem_SegArray, 1, HbPlatform_CacheLineSize);
+	HbMem_DynArray dynArray;
+	HbPara_Mutex dynArrayMutex;
+	HbPara_Mutex_Init(&dynArrayMutex, HbFalse);
+
+	printf("Threads  SegArray Mops/s  Scaling  Mutex DynArray Mops/s  Scaling\n");
+	double segArraySingleThreadRate = 0.0, dynArraySingleThreadRate = 0.0;
+	for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount) {
+		HbMemSegArrayBench_Run run;
+		run.writerCount = threadCount;
+		run.appendCount = appendCount;
+		run.dynArray = &dynArray;
+		run.dynArrayMutex = &dynArrayMutex;
+		double const totalCount = (double) (threadCount * appendCount);
+		HbMem_SegArray_Init(segArray, uint64_t, tag);
+		run.segArray = segArray;
+		double const segArrayRate = totalCount / HbMemBench_RunThreads(threadCount, HbMemSegArrayBench_Thread, &run) * 1.0e-6;
+		HbMemBench_Check(HbMem_SegArray_GetPublishedCount(segArray) == threadCount * appendCount, "SegArray count mismatch", HbMem_SegArray_GetPublishedCount(segArray));
+		HbMem_SegArray_Shutdown(segArray);
+		HbMem_DynArray_Init(&dynArray, uint64_t, tag);
+		run.segArray = NULL;
+		double const dynArrayRate = totalCount / HbMemBench_RunThreads(threadCount, HbMemSegArrayBench_Thread, &run) * 1.0e-6;
+		HbMemBench_Check(dynArray.count_r == threadCount * appendCount, "DynArray count mismatch", dynArray.count_r);
+		HbMem_DynArray_Shutdown(&dynArray);
+		if (threadCount == 1) {
+			segArraySingleThreadRate = segArrayRate;
+			dynArraySingleThreadRate = dynArrayRate;
+		}
+		printf("%7zu  %15.2f  %6.2fx  %21.2f  %6.2fx\n", threadCount,
+		       segArrayRate, segArrayRate / segArraySingleThreadRate, dynArrayRate, dynArrayRate / dynArraySingleThreadRate);
+	}
+
+	// All writers with one more thread reading while they append.
+	HbMemSegArrayBench_Run run;
+	run.writerCount = maxThreadCount;
+	run.appendCount = appendCount;
+	run.readCount = 0;
+	HbMem_SegArray_Init(segArray, uint64_t, tag);
+	run.segArray = segArray;
+	HbMemBench_RunThreads(maxThreadCount + 1, HbMemSegArrayBench_Thread, &run);
+	HbMem_SegArray_Shutdown(segArray);
+	printf("Concurrent reader checked %zu elements from %zu threads.\n", run.readCount, maxThreadCount);
+
+	HbPara_Mutex_Shutdown(&dynArrayMutex);
+	HbMem_Tag_Free(segArray);
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+// Replays a server-like trace of mixed-size allocations with mixed lifetimes through tagged allocations (small sizes going to the slab allocator)
+// and through malloc, on 1 to N threads each replaying its own copy of the trace.
+// Usage: HbMemSlabBench [max thread count, the processor count by default] [allocations in the trace, 1000000 by default]
+// Sizes: 60% 8-64 bytes, 25% 65-256, 10% 257-1024, 4% 1-8 KB and 1% 8-64 KB. Lifetimes: 70% up to 16 following allocations, 25% up to 1000,
+// and 5% until the end of the trace.
+
+#include "HbMemBench.h"
+
+// Free events are stored as the bitwise NOT of the allocation index.
+typedef struct HbMemSlabBench_Trace {
+	uint32_t * sizes; // [allocationCount].
+	int32_t * events; // [allocationCount * 2], non-negative to allocate, negative to free.
+	size_t allocationCount;
+} HbMemSlabBench_Trace;
+
+static void HbMemSlabBench_GenerateTrace(HbMemSlabBench_Trace * const trace, size_t const allocationCount) {
+	trace->allocationCount = allocationCount;
+	trace->sizes = (uint32_t *) malloc(allocationCount * sizeof(uint32_t));
+	trace->events = (int32_t *) malloc(allocationCount * 2 * sizeof(int32_t));
+	// Singly linked lists of the allocations to free before each allocation, the last slot for the ones living until the end.
+	int32_t * const freeFirsts = (int32_t *) malloc((allocationCount + 1) * sizeof(int32_t));
+	int32_t * const freeNexts = (int32_t *) malloc(allocationCount * sizeof(int32_t));
+	HbMemBench_Check(trace->sizes != NULL && trace->events != NULL && freeFirsts != NULL && freeNexts != NULL, "Failed to allocate the trace", allocationCount);
+	for (size_t step = 0; step <= allocationCount; ++step) {
+		freeFirsts[step] = -1;
+	}
+	uint64_t random = HbMemBench_RandomSeed(0);
+	for (size_t allocationIndex = 0; allocationIndex < allocationCount; ++allocationIndex) {
+		uint64_t const sizeClass = HbMemBench_Random(&random) % 100;
+		uint64_t const sizeRandom = HbMemBench_Random(&random);
+		uint32_t size;
+		if (sizeClass < 60) {
+			size = 8 + (uint32_t) (sizeRandom % (64 - 8 + 1));
+		} else if (sizeClass < 85) {
+			size = 65 + (uint32_t) (sizeRandom % (256 - 65 + 1));
+		} else if (sizeClass < 95) {
+			size = 257 + (uint32_t) (sizeRandom % (1024 - 257 + 1));
+		} else if (sizeClass < 99) {
+			size = 1025 + (uint32_t) (sizeRandom % (8192 - 1025 + 1));
+		} else {
+			size = 8193 + (uint32_t) (sizeRandom % (65536 - 8193 + 1));
+		}
+		trace->sizes[allocationIndex] = size;
+		uint64_t const lifetimeClass = HbMemBench_Random(&random) % 100;
+		uint64_t const lifetimeRandom = HbMemBench_Random(&random);
+		size_t freeStep;
+		if (lifetimeClass < 70) {
+			freeStep = allocationIndex + 1 + (size_t) (lifetimeRandom % 16);
+		} else if (lifetimeClass < 95) {
+			freeStep = allocationIndex + 1 + (size_t) (lifetimeRandom % 1000);
+		} else {
+			freeStep = allocationCount;
+		}
+		freeStep = HbMath_Min_Size(freeStep, allocationCount);
+		freeNexts[allocationIndex] = freeFirsts[freeStep];
+		freeFirsts[freeStep] = (int32_t) allocationIndex;
+	}
+	size_t eventCount = 0;
+	for (size_t step = 0; step <= allocationCount; ++step) {
+		for (int32_t freedIndex = freeFirsts[step]; freedIndex >= 0; freedIndex = freeNexts[freedIndex]) {
+			trace->events[eventCount++] = ~freedIndex;
+		}
+		if (step < allocationCount) {
+			trace->events[eventCount++] = (int32_t) step;
+		}
+	}
+	HbMemBench_Check(eventCount == allocationCount * 2, "Trace event count mismatch", eventCount);
+	free(freeNexts);
+	free(freeFirsts);
+}
+
+typedef struct HbMemSlabBench_Run {
+	HbMemSlabBench_Trace const * trace;
+	HbMem_Tag * tag; // NULL to use malloc.
+	void * * * threadAllocations; // [threadCount][allocationCount].
+} HbMemSlabBench_Run;
+
+static void HbMemSlabBench_Thread(size_t const threadIndex, void * const userData) {
+	HbMemSlabBench_Run const * const run = (HbMemSlabBench_Run const *) userData;
+	HbMemSlabBench_Trace const * const trace = run->trace;
+	void * * const allocations = run->threadAllocations[threadIndex];
+	size_t const eventCount = trace->allocationCount * 2;
+	for (size_t eventIndex = 0; eventIndex < eventCount; ++eventIndex) {
+		int32_t const event = trace->events[eventIndex];
+		if (event >= 0) {
+			uint32_t const size = trace->sizes[event];
+			void * const allocation = run->tag != NULL ? HbMem_Tag_AllocExplicit(run->tag, size, HbTrue, __func__, __LINE__) : malloc(size);
+			HbMemBench_Check(allocation != NULL, "malloc failed", size);
+			// Touch the memory so the allocators can't skip anything.
+			*((uint8_t *) allocation) = (uint8_t) event;
+			allocations[event] = allocation;
+		} else if (run->tag != NULL) {
+			HbMem_Tag_Free(allocations[~event]);
+		} else {
+			free(allocations[~event]);
+		}
+	}
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	size_t const maxThreadCount = argumentCount > 1 ? HbMath_Clamp_Size((size_t) strtoull(arguments[1], NULL, 10), 1, HbMemBench_MaxThreadCount) : HbMemBench_GetProcessorCount();
+	size_t const allocationCount = argumentCount > 2 ? HbMath_Clamp_Size((size_t) strtoull(arguments[2], NULL, 10), 1, INT32_MAX / 2) : 1000000;
+
+	HbMemSlabBench_Trace trace;
+	HbMemSlabBench_GenerateTrace(&trace, allocationCount);
+	void * * threadAllocations[HbMemBench_MaxThreadCount];
+	for (size_t threadIndex = 0; threadIndex < maxThreadCount; ++threadIndex) {
+		threadAllocations[threadIndex] = (void * *) malloc(allocationCount * sizeof(void *));
+		HbMemBench_Check(threadAllocations[threadIndex] != NULL, "Failed to allocate the allocation pointers", allocationCount);
+	}
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemSlabBench");
+
+	printf("Threads  Tag Mops/s  malloc Mops/s  Tag/malloc\n");
+	for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount) {
+		HbMemSlabBench_Run run;
+		run.trace = &trace;
+		run.threadAllocations = threadAllocations;
+		// Allocations and frees.
+		double const operationCount = (double) (threadCount * allocationCount * 2);
+		run.tag = tag;
+		double const tagRate = operationCount / HbMemBench_RunThreads(threadCount, HbMemSlabBench_Thread, &run) * 1.0e-6;
+		HbMemBench_Check(HbMem_Tag_GetTotalSize(tag) == 0, "Tagged memory left after the run", HbMem_Tag_GetTotalSize(tag));
+		run.tag = NULL;
+		double const mallocRate = operationCount / HbMemBench_RunThreads(threadCount, HbMemSlabBench_Thread, &run) * 1.0e-6;
+		printf("%7zu  %10.2f  %13.2f  %9.2fx\n", threadCount, tagRate, mallocRate, tagRate / mallocRate);
+	}
+
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	for (size_t threadIndex = 0; threadIndex < maxThreadCount; ++threadIndex) {
+		free(threadAllocations[threadIndex]);
+	}
+	free(trace.events);
+	free(trace.sizes);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,298 @@
+// Compares two heap snapshots written by HbMem_Tag_Root_WriteSnapshot, printing the changes of the live memory by tag and by origin.
+// Usage: HbMemSnapshotDiff old.hbms new.hbms [max origin lines, 50 by default]
+// Only depends on the snapshot format definitions from HbMem.h - build as a console application with the repository root in the include paths.
+// Snapshots must be read on a target with the same byte order as the one that wrote them.
+
+#include "../HbMem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct HbMemSnapshotDiff_Text {
+	char const * text; // Not terminated, points into the snapshot data.
+	uint32_t length;
+} HbMemSnapshotDiff_Text;
+
+// Live memory of an origin within a tag, or the totals of a tag if the origin name is NULL.
+typedef struct HbMemSnapshotDiff_Entry {
+	HbMemSnapshotDiff_Text tagName;
+	HbMemSnapshotDiff_Text originName;
+	uint32_t originLocation;
+	// Old and new.
+	uint64_t size[2];
+	uint64_t count[2];
+} HbMemSnapshotDiff_Entry;
+
+typedef struct HbMemSnapshotDiff_Entries {
+	HbMemSnapshotDiff_Entry * entries;
+	size_t count;
+	size_t capacity;
+} HbMemSnapshotDiff_Entries;
+
+static HbMemSnapshotDiff_Entry * HbMemSnapshotDiff_AddEntry(HbMemSnapshotDiff_Entries * const entries) {
+	if (entries->count >= entries->capacity) {
+		size_t const newCapacity = entries->capacity != 0 ? entries->capacity * 2 : 4096;
+		HbMemSnapshotDiff_Entry * const newEntries = (HbMemSnapshotDiff_Entry *) realloc(entries->entries, newCapacity * sizeof(HbMemSnapshotDiff_Entry));
+		if (newEntries == NULL) {
+			fprintf(stderr, "Failed to allocate memory for %zu entries.\n", newCapacity);
+			exit(EXIT_FAILURE);
+		}
+		entries->entries = newEntries;
+		entries->capacity = newCapacity;
+	}
+	HbMemSnapshotDiff_Entry * const entry = &entries->entries[entries->count++];
+	memset(entry, 0, sizeof(HbMemSnapshotDiff_Entry));
+	return entry;
+}
+
+typedef struct HbMemSnapshotDiff_Reader {
+	char const * fileName;
+	uint8_t const * cursor;
+	uint8_t const * end;
+} HbMemSnapshotDiff_Reader;
+
+static void HbMemSnapshotDiff_Read(HbMemSnapshotDiff_Reader * const reader, void * const target, size_t const size) {
+	if ((size_t) (reader->end - reader->cursor) < size) {
+		fprintf(stderr, "%s: Unexpected end of the snapshot.\n", reader->fileName);
+		exit(EXIT_FAILURE);
+	}
+	memcpy(target, reader->cursor, size);
+	reader->cursor += size;
+}
+
+static uint32_t HbMemSnapshotDiff_ReadU32(HbMemSnapshotDiff_Reader * const reader) {
+	uint32_t value;
+	HbMemSnapshotDiff_Read(reader, &value, sizeof(value));
+	return value;
+}
+
+static uint64_t HbMemSnapshotDiff_ReadU64(HbMemSnapshotDiff_Reader * const reader) {
+	uint64_t value;
+	HbMemSnapshotDiff_Read(reader, &value, sizeof(value));
+	return value;
+}
+
+static HbMemSnapshotDiff_Text HbMemSnapshotDiff_ReadText(HbMemSnapshotDiff_Reader * const reader) {
+	HbMemSnapshotDiff_Text text;
+	text.length = HbMemSnapshotDiff_ReadU32(reader);
+	if ((size_t) (reader->end - reader->cursor) < text.length) {
+		fprintf(stderr, "%s: Unexpected end of the snapshot.\n", reader->fileName);
+		exit(EXIT_FAILURE);
+	}
+	text.text = (char const *) reader->cursor;
+	reader->cursor += text.length;
+	return text;
+}
+
+// Adds the tags and the allocations of the snapshot as entries of the side (0 for old, 1 for new). The data must stay loaded.
+static void HbMemSnapshotDiff_LoadSnapshot(char const * const fileName, unsigned const side, HbMemSnapshotDiff_Entries * const entries) {
+	FILE * const file = fopen(fileName, "rb");
+	if (file == NULL) {
+		fprintf(stderr, "%s: Failed to open the snapshot.\n", fileName);
+		exit(EXIT_FAILURE);
+	}
+	fseek(file, 0, SEEK_END);
+	long const fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	uint8_t * const data = (uint8_t *) malloc(fileSize > 0 ? (size_t) fileSize : 1);
+	if (fileSize < 0 || data == NULL || fread(data, 1, (size_t) fileSize, file) != (size_t) fileSize) {
+		fprintf(stderr, "%s: Failed to read the snapshot.\n", fileName);
+		exit(EXIT_FAILURE);
+	}
+	fclose(file);
+
+	HbMemSnapshotDiff_Reader reader;
+	reader.fileName = fileName;
+	reader.cursor = data;
+	reader.end = data + fileSize;
+	if (HbMemSnapshotDiff_ReadU32(&reader) != HbMem_Snapshot_Magic) {
+		fprintf(stderr, "%s: Not a heap snapshot, or written with a different byte order.\n", fileName);
+		exit(EXIT_FAILURE);
+	}
+	uint32_t const version = HbMemSnapshotDiff_ReadU32(&reader);
+	if (version != HbMem_Snapshot_Version) {
+		fprintf(stderr, "%s: Snapshot version %u is not supported.\n", fileName, (unsigned) version);
+		exit(EXIT_FAILURE);
+	}
+
+	HbMemSnapshotDiff_Text * strings = NULL;
+	uint32_t stringCount = 0, stringCapacity = 0;
+	HbMemSnapshotDiff_Text tagName = { NULL, 0 };
+	HbBool hasTag = HbFalse;
+	for (;;) {
+		uint8_t recordType;
+		HbMemSnapshotDiff_Read(&reader, &recordType, sizeof(recordType));
+		if (recordType == HbMem_Snapshot_Record_End) {
+			break;
+		}
+		switch (recordType) {
+		case HbMem_Snapshot_Record_Tag: {
+			tagName = HbMemSnapshotDiff_ReadText(&reader);
+			hasTag = HbTrue;
+			HbMemSnapshotDiff_Entry * const entry = HbMemSnapshotDiff_AddEntry(entries);
+			entry->tagName = tagName;
+			entry->size[side] = HbMemSnapshotDiff_ReadU64(&reader);
+			entry->count[side] = HbMemSnapshotDiff_ReadU64(&reader);
+			break;
+		}
+		case HbMem_Snapshot_Record_String: {
+			if (HbMemSnapshotDiff_ReadU32(&reader) != stringCount) {
+				fprintf(stderr, "%s: Strings are not sequential.\n", fileName);
+				exit(EXIT_FAILURE);
+			}
+			if (stringCount >= stringCapacity) {
+				stringCapacity = stringCapacity != 0 ? stringCapacity * 2 : 256;
+				strings = (HbMemSnapshotDiff_Text *) realloc(strings, stringCapacity * sizeof(HbMemSnapshotDiff_Text));
+				if (strings == NULL) {
+					fprintf(stderr, "%s: Failed to allocate memory for %u strings.\n", fileName, (unsigned) stringCapacity);
+					exit(EXIT_FAILURE);
+				}
+			}
+			strings[stringCount++] = HbMemSnapshotDiff_ReadText(&reader);
+			break;
+		}
+		case HbMem_Snapshot_Record_Allocation: {
+			uint32_t const originNameID = HbMemSnapshotDiff_ReadU32(&reader);
+			if (!hasTag || originNameID >= stringCount) {
+				fprintf(stderr, "%s: Allocation record without a tag or an origin name.\n", fileName);
+				exit(EXIT_FAILURE);
+			}
+			HbMemSnapshotDiff_Entry * const entry = HbMemSnapshotDiff_AddEntry(entries);
+			entry->tagName = tagName;
+			entry->originName = strings[originNameID];
+			entry->originLocation = HbMemSnapshotDiff_ReadU32(&reader);
+			entry->size[side] = HbMemSnapshotDiff_ReadU64(&reader);
+			entry->count[side] = 1;
+			break;
+		}
+		default:
+			fprintf(stderr, "%s: Unknown record type %u.\n", fileName, (unsigned) recordType);
+			exit(EXIT_FAILURE);
+		}
+	}
+	free(strings);
+}
+
+static int HbMemSnapshotDiff_CompareTexts(HbMemSnapshotDiff_Text const a, HbMemSnapshotDiff_Text const b) {
+	int const comparison = memcmp(a.text, b.text, a.length < b.length ? a.length : b.length);
+	if (comparison != 0) {
+		return comparison;
+	}
+	return a.length != b.length ? (a.length < b.length ? -1 : 1) : 0;
+}
+
+static int HbMemSnapshotDiff_CompareEntryKeys(void const * const aPointer, void const * const bPointer) {
+	HbMemSnapshotDiff_Entry const * const a = (HbMemSnapshotDiff_Entry const *) aPointer;
+	HbMemSnapshotDiff_Entry const * const b = (HbMemSnapshotDiff_Entry const *) bPointer;
+	int comparison = HbMemSnapshotDiff_CompareTexts(a->tagName, b->tagName);
+	if (comparison != 0) {
+		return comparison;
+	}
+	// Tag totals first.
+	if ((a->originName.text == NULL) != (b->originName.text == NULL)) {
+		return a->originName.text == NULL ? -1 : 1;
+	}
+	if (a->originName.text == NULL) {
+		return 0;
+	}
+	comparison = HbMemSnapshotDiff_CompareTexts(a->originName, b->originName);
+	if (comparison != 0) {
+		return comparison;
+	}
+	return a->originLocation != b->originLocation ? (a->originLocation < b->originLocation ? -1 : 1) : 0;
+}
+
+HbForceInline int64_t HbMemSnapshotDiff_GetSizeChange(HbMemSnapshotDiff_Entry const * const entry) {
+	return (int64_t) (entry->size[1] - entry->size[0]);
+}
+
+static int HbMemSnapshotDiff_CompareEntryChanges(void const * const aPointer, void const * const bPointer) {
+	int64_t const aChange = HbMemSnapshotDiff_GetSizeChange((HbMemSnapshotDiff_Entry const *) aPointer);
+	int64_t const bChange = HbMemSnapshotDiff_GetSizeChange((HbMemSnapshotDiff_Entry const *) bPointer);
+	// Growth first (the usual suspect when looking for leaks), then shrinking, then by the key for stable output.
+	if (aChange != bChange) {
+		return aChange > bChange ? -1 : 1;
+	}
+	return HbMemSnapshotDiff_CompareEntryKeys(aPointer, bPointer);
+}
+
+static void HbMemSnapshotDiff_PrintEntry(HbMemSnapshotDiff_Entry const * const entry) {
+	printf("%+14lld bytes %+10lld allocations  %12llu -> %-12llu  %.*s",
+	       (long long) HbMemSnapshotDiff_GetSizeChange(entry), (long long) (entry->count[1] - entry->count[0]),
+	       (unsigned long long) entry->size[0], (unsigned long long) entry->size[1],
+	       (int) entry->tagName.length, entry->tagName.text);
+	if (entry->originName.text != NULL) {
+		printf("  %.*s:%u", (int) entry->originName.length, entry->originName.text, (unsigned) entry->originLocation);
+	}
+	putchar('\n');
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	if (argumentCount < 3 || argumentCount > 4) {
+		fprintf(stderr, "Usage: %s old.hbms new.hbms [max origin lines]\n", argumentCount > 0 ? arguments[0] : "HbMemSnapshotDiff");
+		return EXIT_FAILURE;
+	}
+	size_t const maxOriginLines = argumentCount > 3 ? (size_t) strtoull(arguments[3], NULL, 10) : 50;
+
+	HbMemSnapshotDiff_Entries entries = { NULL, 0, 0 };
+	HbMemSnapshotDiff_LoadSnapshot(arguments[1], 0, &entries);
+	HbMemSnapshotDiff_LoadSnapshot(arguments[2], 1, &entries);
+
+	// Merge the allocations with the same key from both snapshots.
+	size_t mergedCount = 0;
+	if (entries.count != 0) {
+		qsort(entries.entries, entries.count, sizeof(HbMemSnapshotDiff_Entry), HbMemSnapshotDiff_CompareEntryKeys);
+		mergedCount = 1;
+		for (size_t entryIndex = 1; entryIndex < entries.count; ++entryIndex) {
+			HbMemSnapshotDiff_Entry const * const entry = &entries.entries[entryIndex];
+			HbMemSnapshotDiff_Entry * const mergedEntry = &entries.entries[mergedCount - 1];
+			if (HbMemSnapshotDiff_CompareEntryKeys(entry, mergedEntry) == 0) {
+				for (unsigned side = 0; side < 2; ++side) {
+					mergedEntry->size[side] += entry->size[side];
+					mergedEntry->count[side] += entry->count[side];
+				}
+			} else {
+				entries.entries[mergedCount++] = *entry;
+			}
+		}
+	}
+
+	// Keep only the changes, the tag totals before the origins.
+	size_t tagCount = 0, changedCount = 0;
+	for (size_t entryIndex = 0; entryIndex < mergedCount; ++entryIndex) {
+		HbMemSnapshotDiff_Entry const * const entry = &entries.entries[entryIndex];
+		if (entry->size[0] == entry->size[1] && entry->count[0] == entry->count[1]) {
+			continue;
+		}
+		if (entry->originName.text == NULL) {
+			HbMemSnapshotDiff_Entry const tagEntry = *entry;
+			memmove(&entries.entries[tagCount + 1], &entries.entries[tagCount], (changedCount - tagCount) * sizeof(HbMemSnapshotDiff_Entry));
+			entries.entries[tagCount++] = tagEntry;
+		} else {
+			entries.entries[changedCount] = *entry;
+		}
+		++changedCount;
+	}
+	qsort(entries.entries, tagCount, sizeof(HbMemSnapshotDiff_Entry), HbMemSnapshotDiff_CompareEntryChanges);
+	qsort(entries.entries + tagCount, changedCount - tagCount, sizeof(HbMemSnapshotDiff_Entry), HbMemSnapshotDiff_CompareEntryChanges);
+
+	printf("Tags (%zu changed):\n", tagCount);
+	for (size_t entryIndex = 0; entryIndex < tagCount; ++entryIndex) {
+		HbMemSnapshotDiff_PrintEntry(&entries.entries[entryIndex]);
+	}
+	size_t const originCount = changedCount - tagCount;
+	printf("\nOrigins (%zu changed%s):\n", originCount, originCount > maxOriginLines ? ", largest growth and shrinking shown" : "");
+	for (size_t originIndex = 0; originIndex < originCount; ++originIndex) {
+		// Showing both ends if there are too many.
+		if (originCount > maxOriginLines && originIndex >= maxOriginLines - maxOriginLines / 2 && originIndex < originCount - maxOriginLines / 2) {
+			originIndex = originCount - maxOriginLines / 2 - 1;
+			printf("%14s\n", "...");
+			continue;
+		}
+		HbMemSnapshotDiff_PrintEntry(&entries.entries[tagCount + originIndex]);
+	}
+
+	// The entries point into the snapshot data, which is freed with the process.
+	free(entries.entries);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+// Measures the throughput of tagged allocations and frees by threads sharing one tag, for 1 to N threads, with malloc as the reference.
+// Usage: HbMemTagBench [max thread count, the processor count by default] [operations per thread, 2000000 by default]
+// Every thread keeps a window of live allocations of mixed small sizes, freeing the oldest one before each allocation.
+
+#include "HbMemBench.h"
+
+#define HbMemTagBench_WindowSize 64
+#define HbMemTagBench_MaxSize 512
+
+typedef struct HbMemTagBench_Run {
+	HbMem_Tag * tag; // NULL to use malloc.
+	size_t operationCount;
+} HbMemTagBench_Run;
+
+static void HbMemTagBench_Thread(size_t const threadIndex, void * const userData) {
+	HbMemTagBench_Run const * const run = (HbMemTagBench_Run const *) userData;
+	void * window[HbMemTagBench_WindowSize] = { NULL };
+	uint64_t random = HbMemBench_RandomSeed(threadIndex);
+	for (size_t operationIndex = 0; operationIndex < run->operationCount; ++operationIndex) {
+		void * * const slot = &window[operationIndex % HbMemTagBench_WindowSize];
+		size_t const size = 16 + (size_t) (HbMemBench_Random(&random) % (HbMemTagBench_MaxSize - 16 + 1));
+		if (run->tag != NULL) {
+			if (*slot != NULL) {
+				HbMem_Tag_Free(*slot);
+			}
+			*slot = HbMem_Tag_AllocExplicit(run->tag, size, HbTrue, __func__, __LINE__);
+		} else {
+			free(*slot);
+			*slot = malloc(size);
+			HbMemBench_Check(*slot != NULL, "malloc failed", size);
+		}
+		// Touch the memory so the allocators can't skip anything.
+		*((uint8_t *) *slot) = (uint8_t) operationIndex;
+	}
+	for (size_t slotIndex = 0; slotIndex < HbMemTagBench_WindowSize; ++slotIndex) {
+		if (window[slotIndex] != NULL) {
+			if (run->tag != NULL) {
+				HbMem_Tag_Free(window[slotIndex]);
+			} else {
+				free(window[slotIndex]);
+			}
+		}
+	}
+}
+
+int main(int const argumentCount, char * * const arguments) {
+	size_t const maxThreadCount = argumentCount > 1 ? HbMath_Clamp_Size((size_t) strtoull(arguments[1], NULL, 10), 1, HbMemBench_MaxThreadCount) : HbMemBench_GetProcessorCount();
+	size_t const operationCount = argumentCount > 2 ? HbMath_Max_Size((size_t) strtoull(arguments[2], NULL, 10), 1) : 2000000;
+
+	HbMem_Tag_Root tagRoot;
+	HbMem_Tag_Root_Init(&tagRoot);
+	HbMem_Tag * const tag = HbMem_Tag_Create(&tagRoot, "HbMemTagBench");
+
+	printf("Threads  Tag Mops/s  Scaling  malloc Mops/s  Scaling\n");
+	double tagSingleThreadRate = 0.0, mallocSingleThreadRate = 0.0;
+	for (size_t threadCount = 1; threadCount <= maxThreadCount; ++threadCount) {
+		HbMemTagBench_Run run;
+		run.operationCount = operationCount;
+		run.tag = tag;
+		double const tagRate = (double) (threadCount * operationCount) / HbMemBench_RunThreads(threadCount, HbMemTagBench_Thread, &run) * 1.0e-6;
+		HbMemBench_Check(HbMem_Tag_GetTotalSize(tag) == 0, "Tagged memory left after the run", HbMem_Tag_GetTotalSize(tag));
+		run.tag = NULL;
+		double const mallocRate = (double) (threadCount * operationCount) / HbMemBench_RunThreads(threadCount, HbMemTagBench_Thread, &run) * 1.0e-6;
+		if (threadCount == 1) {
+			tagSingleThreadRate = tagRate;
+			mallocSingleThreadRate = mallocRate;
+		}
+		printf("%7zu  %10.2f  %6.2fx  %13.2f  %6.2fx\n", threadCount,
+		       tagRate, tagRate / tagSingleThreadRate, mallocRate, mallocRate / mallocSingleThreadRate);
+	}
+
+	HbMem_Tag_Destroy(tag);
+	HbMem_Tag_Root_Shutdown(&tagRoot);
+	return EXIT_SUCCESS;
+}